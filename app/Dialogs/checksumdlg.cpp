@@ -13,7 +13,6 @@
 #include "../GUI/krtreewidget.h"
 #include "../icon.h"
 #include "../krglobal.h"
-#include "../krservices.h"
 #include "../krusader.h"
 
 // QtCore
@@ -21,7 +20,6 @@
 #include <QFile>
 #include <QFileInfo>
 #include <QList>
-#include <QMap>
 #include <QTextStream>
 // QtWidgets
 #include <QDialogButtonBox>
@@ -32,10 +30,13 @@
 
 #include <QtConcurrent/QtConcurrentRun> // krazy:exclude=includes
 
+#include <KIO/Global>
 #include <KLocalizedString>
 #include <KMessageBox>
 #include <KUrlRequester>
 
+#include <algorithm>
+
 void Checksum::startCreationWizard(const QString &path, const QStringList &files)
 {
     if (files.isEmpty())
@@ -82,50 +83,84 @@ QStringList listFiles(const QString &path, const QStringList &fileNames)
     return allFiles;
 }
 
-// ------------- Checksum Process
-
-ChecksumProcess::ChecksumProcess(QObject *parent, const QString &path)
-    : KProcess(parent)
-    , m_tmpOutFile(QDir::tempPath() + QLatin1String("/krusader_XXXXXX.stdout"))
-    , m_tmpErrFile(QDir::tempPath() + QLatin1String("/krusader_XXXXXX.stderr"))
+// the checksum tools escape backslashes and line breaks in file names and mark such lines with a
+// leading backslash
+static bool needsEscaping(const QString &fileName)
 {
-    m_tmpOutFile.open(); // necessary to create the filename
-    m_tmpErrFile.open(); // necessary to create the filename
-
-    setOutputChannelMode(KProcess::SeparateChannels); // without this the next 2 lines have no effect!
-    setStandardOutputFile(m_tmpOutFile.fileName());
-    setStandardErrorFile(m_tmpErrFile.fileName());
-    setWorkingDirectory(path);
-    connect(this, &ChecksumProcess::errorOccurred, this, &ChecksumProcess::slotError);
-    connect(this, static_cast<void (QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished), this, &ChecksumProcess::slotFinished);
+    return fileName.contains('\\') || fileName.contains('\n') || fileName.contains('\r');
 }
 
-ChecksumProcess::~ChecksumProcess()
+static QString escapeFileName(QString fileName)
 {
-    disconnect(this, nullptr, this, nullptr); // QProcess emits finished() on destruction
-    close();
+    fileName.replace('\\', QLatin1String("\\\\"));
+    fileName.replace('\n', QLatin1String("\\n"));
+    fileName.replace('\r', QLatin1String("\\r"));
+    return fileName;
 }
 
-void ChecksumProcess::slotError(QProcess::ProcessError error)
+static bool unescapeFileName(const QString &escaped, QString &fileName)
 {
-    if (error == QProcess::FailedToStart) {
-        KMessageBox::error(nullptr, i18n("<qt>Could not start <b>%1</b>.</qt>", program().join(" ")));
+    fileName.clear();
+    fileName.reserve(escaped.length());
+    for (int i = 0; i < escaped.length(); ++i) {
+        if (escaped[i] != '\\') {
+            fileName += escaped[i];
+            continue;
+        }
+        if (++i == escaped.length())
+            return false;
+        if (escaped[i] == '\\')
+            fileName += '\\';
+        else if (escaped[i] == 'n')
+            fileName += '\n';
+        else if (escaped[i] == 'r')
+            fileName += '\r';
+        else
+            return false;
     }
+    return true;
 }
 
-void ChecksumProcess::slotFinished(int, QProcess::ExitStatus exitStatus)
+// the line "<checksum>  <file name>" of a checksum file, as written by the checksum tools
+static QString checksumLine(const QString &checksum, const QString &fileName)
 {
-    if (exitStatus != QProcess::NormalExit) {
-        KMessageBox::error(nullptr, i18n("<qt>There was an error while running <b>%1</b>.</qt>", program().join(" ")));
-        return;
+    if (needsEscaping(fileName))
+        return '\\' + checksum + "  " + escapeFileName(fileName);
+    return checksum + "  " + fileName;
+}
+
+// parse a line "<checksum>  <file name>" or "<checksum> *<file name>" of a checksum file, or a BSD
+// style line "<type> (<file name>) = <checksum>" as written with --tag
+static bool parseChecksumLine(QString line, QString &checksum, QString &fileName)
+{
+    if (line.endsWith('\n'))
+        line.chop(1);
+    if (line.endsWith('\r'))
+        line.chop(1);
+
+    const bool escaped = line.startsWith('\\');
+    if (escaped)
+        line.remove(0, 1);
+
+    QString name;
+    const int hashLength = line.indexOf(' '); // delimiter is either "  " or " *"
+    if (hashLength > 0 && line.length() >= hashLength + 3 && (line[hashLength + 1] == ' ' || line[hashLength + 1] == '*')) {
+        checksum = line.left(hashLength);
+        name = line.mid(hashLength + 2);
+    } else {
+        const int nameStart = line.indexOf(QLatin1String(" ("));
+        const int nameEnd = line.lastIndexOf(QLatin1String(") = "));
+        if (nameStart <= 0 || nameEnd <= nameStart + 2 || nameEnd + 4 >= line.length())
+            return false;
+        checksum = line.mid(nameEnd + 4);
+        name = line.mid(nameStart + 2, nameEnd - nameStart - 2);
     }
 
-    // parse result files
-    if (!KrServices::fileToStringList(&m_tmpOutFile, m_outputLines) || !KrServices::fileToStringList(&m_tmpErrFile, m_errorLines)) {
-        KMessageBox::error(nullptr, i18n("Error reading stdout or stderr"));
-        return;
+    if (!escaped) {
+        fileName = name;
+        return true;
     }
-    emit resultReady();
+    return unescapeFileName(name, fileName);
 }
 
 // ------------- Generic Checksum Wizard
@@ -133,25 +168,22 @@ void ChecksumProcess::slotFinished(int, QProcess::ExitStatus exitStatus)
 ChecksumWizard::ChecksumWizard(const QString &path)
     : QWizard(krApp)
     , m_path(path)
-    , m_process(nullptr)
+    , m_engine(nullptr)
+    , m_progressBar(nullptr)
+    , m_progressLabel(nullptr)
+    , m_fileCount(-1)
 {
     setAttribute(Qt::WA_DeleteOnClose);
 
-    // init the dictionary - pity it has to be manually
-    m_checksumTools.insert("md5", "md5sum");
-    m_checksumTools.insert("sha1", "sha1sum");
-    m_checksumTools.insert("sha256", "sha256sum");
-    m_checksumTools.insert("sha224", "sha224sum");
-    m_checksumTools.insert("sha384", "sha384sum");
-    m_checksumTools.insert("sha512", "sha512sum");
-
+    m_progressTimer.setInterval(200);
+    connect(&m_progressTimer, &QTimer::timeout, this, &ChecksumWizard::slotUpdateProgress);
     connect(this, &QWizard::currentIdChanged, this, &ChecksumWizard::slotCurrentIdChanged);
 }
 
 ChecksumWizard::~ChecksumWizard()
 {
-    if (m_process) {
-        delete m_process;
+    if (m_engine) {
+        delete m_engine;
     }
 }
 
@@ -160,10 +192,10 @@ void ChecksumWizard::slotCurrentIdChanged(int id)
     if (id == m_introId) {
         onIntroPage();
     } else if (id == m_progressId) {
-        if (m_process) {
+        if (m_engine) {
             // we are coming from the result page;
-            delete m_process;
-            m_process = nullptr;
+            delete m_engine;
+            m_engine = nullptr;
             restart();
         } else {
             button(QWizard::BackButton)->hide();
@@ -186,48 +218,72 @@ QWizardPage *ChecksumWizard::createProgressPage(const QString &title)
     auto *mainLayout = new QVBoxLayout;
     page->setLayout(mainLayout);
 
-    // "busy" indicator
-    auto *bar = new QProgressBar();
-    bar->setRange(0, 0);
+    // "busy" indicator until the number of files is known
+    m_progressBar = new QProgressBar();
+    m_progressBar->setRange(0, 0);
+    mainLayout->addWidget(m_progressBar);
 
-    mainLayout->addWidget(bar);
+    m_progressLabel = new QLabel;
+    m_progressLabel->setTextFormat(Qt::PlainText);
+    mainLayout->addWidget(m_progressLabel);
 
     return page;
 }
 
-bool ChecksumWizard::checkExists(const QString &type)
+void ChecksumWizard::runEngine(const QString &type, const ChecksumEngine::Source &source, int fileCount, bool stopOnFailure)
 {
-    if (!KrServices::cmdExist(m_checksumTools[type])) {
-        KMessageBox::error(this,
-                           i18n("<qt>Krusader cannot find a checksum tool that handles %1 on your system. "
-                                "Please check the <b>Dependencies</b> page in Krusader's settings.</qt>",
-                                type));
-        return false;
-    }
-    return true;
+    Q_ASSERT(m_engine == nullptr);
+
+    m_results.clear();
+    m_fileCount = fileCount;
+    m_progressBar->setRange(0, qMax(fileCount, 0));
+    m_progressLabel->clear();
+
+    m_engine = new ChecksumEngine(this);
+    // show next page (with results) (only) when all files are done
+    connect(m_engine, &ChecksumEngine::finished, this, &ChecksumWizard::slotEngineFinished);
+    m_engine->start(m_path, type, source, stopOnFailure);
+    m_progressTimer.start();
 }
 
-void ChecksumWizard::runProcess(const QString &type, const QStringList &args)
+void ChecksumWizard::slotUpdateProgress()
 {
-    Q_ASSERT(m_process == nullptr);
+    if (!m_engine)
+        return;
 
-    m_process = new ChecksumProcess(this, m_path);
-    m_process->setProgram(KrServices::fullPathName(m_checksumTools[type]), args);
-    // show next page (with results) (only) when process is done
-    connect(m_process, &ChecksumProcess::resultReady, this, &QWizard::next);
-    // run the process
-    m_process->start();
+    m_results += m_engine->takeResults();
+
+    const int filesDone = m_engine->filesDone();
+    if (m_fileCount > 0)
+        m_progressBar->setValue(filesDone);
+
+    const QString size = KIO::convertSize(static_cast<KIO::filesize_t>(m_engine->bytesDone()));
+    const QString files = m_fileCount > 0 ? i18nc("%1=files done, %2=all files, %3=size", "%1 of %2 files, %3", filesDone, m_fileCount, size)
+                                          : i18nc("%1=files done, %2=size", "%1 files, %2", filesDone, size);
+    m_progressLabel->setText(files + '\n' + m_engine->currentFile());
+}
+
+void ChecksumWizard::slotEngineFinished()
+{
+    m_progressTimer.stop();
+    slotUpdateProgress();
+
+    std::sort(m_results.begin(), m_results.end(), [](const ChecksumEngine::Result &result1, const ChecksumEngine::Result &result2) {
+        return result1.index < result2.index;
+    });
+    next();
 }
 
 void ChecksumWizard::addChecksumLine(KrTreeWidget *tree, const QString &line)
 {
     auto *item = new QTreeWidgetItem(tree);
-    const int hashLength = line.indexOf(' '); // delimiter is either "  " or " *"
-    item->setText(0, line.left(hashLength));
-    QString fileName = line.mid(hashLength + 2);
-    if (fileName.endsWith('\n'))
-        fileName.chop(1);
-    item->setText(1, fileName);
+    QString checksum, fileName;
+    if (parseChecksumLine(line, checksum, fileName)) {
+        item->setText(0, checksum);
+        item->setText(1, fileName);
+    } else {
+        item->setText(1, line.trimmed());
+    }
 }
 
 // ------------- Create Wizard
@@ -269,8 +325,7 @@ QWizardPage *CreateWizard::createIntroPage()
 
     m_methodBox = new KComboBox;
     // -- fill the combo with available methods
-    for (const QString &type : m_checksumTools.keys())
-        m_methodBox->addItem(type);
+    m_methodBox->addItems(ChecksumEngine::types());
     m_methodBox->setFocus();
     hLayout->addWidget(m_methodBox);
 
@@ -325,19 +380,24 @@ void CreateWizard::onProgressPage()
 void CreateWizard::createChecksums()
 {
     const QString type = m_methodBox->currentText();
-    if (!checkExists(type)) {
-        button(QWizard::BackButton)->show();
-        return;
-    }
 
-    const QStringList &allFiles = m_listFilesWatcher.result();
+    const QStringList allFiles = m_listFilesWatcher.result();
     if (allFiles.isEmpty()) {
         KMessageBox::error(this, i18n("No files found"));
         button(QWizard::BackButton)->show();
         return;
     }
 
-    runProcess(type, allFiles);
+    int position = 0;
+    runEngine(
+        type,
+        [allFiles, position](ChecksumEngine::Entry &entry) mutable {
+            if (position >= allFiles.count())
+                return false;
+            entry.fileName = allFiles.at(position++);
+            return true;
+        },
+        allFiles.count());
 
     // set suggested filename
     m_suggestedFilePath = QDir(m_path).filePath((m_fileNames.count() > 1 ? "checksum." : (m_fileNames[0] + '.')) + type);
@@ -345,9 +405,16 @@ void CreateWizard::createChecksums()
 
 void CreateWizard::onResultPage()
 {
-    // hash tools display errors into stderr, so we'll use that to determine the result of the job
-    const QStringList outputLines = m_process->stdOutput();
-    const QStringList errorLines = m_process->errOutput();
+    // the lines are written like the checksum tools do, in the order of the files
+    m_checksumLines.clear();
+    QStringList errorLines;
+    for (const ChecksumEngine::Result &result : qAsConst(m_results)) {
+        if (result.error.isEmpty())
+            m_checksumLines << checksumLine(result.checksum, result.fileName);
+        else
+            errorLines << i18nc("%1=file name, %2=error", "%1: %2", result.fileName, result.error);
+    }
+    const QStringList &outputLines = m_checksumLines;
     bool errors = !errorLines.isEmpty();
     bool successes = !outputLines.isEmpty();
 
@@ -378,8 +445,10 @@ bool CreateWizard::savePerFile()
     const QString type = m_suggestedFilePath.mid(m_suggestedFilePath.lastIndexOf('.'));
 
     krApp->startWaiting(i18n("Saving checksum files..."), 0);
-    for (const QString &line : m_process->stdOutput()) {
-        const QString filename = line.mid(line.indexOf(' ') + 2) + type;
+    for (const QString &line : qAsConst(m_checksumLines)) {
+        QString checksum, fileName;
+        parseChecksumLine(line, checksum, fileName);
+        const QString filename = fileName + type;
         if (!saveChecksumFile(QStringList() << line, filename)) {
             KMessageBox::error(this, i18n("Errors occurred while saving multiple checksums. Stopping"));
             krApp->stopWait();
@@ -418,7 +487,7 @@ bool CreateWizard::saveChecksumFile(const QStringList &data, const QString &file
 
 void CreateWizard::accept()
 {
-    const bool saved = m_onePerFileBox->isChecked() ? savePerFile() : saveChecksumFile(m_process->stdOutput());
+    const bool saved = m_onePerFileBox->isChecked() ? savePerFile() : saveChecksumFile(m_checksumLines);
     if (saved)
         QWizard::accept();
 }
@@ -477,7 +546,7 @@ QWizardPage *VerifyWizard::createIntroPage()
 
     auto *checksumFileReq = new KUrlRequester;
     QString typesFilter;
-    for (const QString &ext : m_checksumTools.keys())
+    for (const QString &ext : ChecksumEngine::types())
         typesFilter += ("*." + ext + ' ');
     checksumFileReq->setNameFilter(typesFilter);
     checksumFileReq->setText(m_checksumFile);
@@ -493,6 +562,10 @@ QWizardPage *VerifyWizard::createIntroPage()
     m_hashesTreeWidget->setHeaderLabels(QStringList() << i18n("Hash") << i18n("File"));
     mainLayout->addWidget(m_hashesTreeWidget);
 
+    m_stopOnFailureBox = new QCheckBox(i18n("Stop at the first file that fails"));
+    m_stopOnFailureBox->setChecked(false);
+    mainLayout->addWidget(m_stopOnFailureBox);
+
     return page;
 }
 
@@ -524,20 +597,59 @@ void VerifyWizard::onProgressPage()
 {
     // verify checksum file...
     const QString extension = QFileInfo(m_checksumFile).suffix();
-    if (!checkExists(extension)) {
+
+    // the checksum file is read while the files are hashed, by the worker threads
+    QSharedPointer<QFile> file(new QFile(m_checksumFile));
+    if (!file->open(QIODevice::ReadOnly)) {
+        KMessageBox::detailedError(this, i18n("Error reading file %1", m_checksumFile), file->errorString());
         button(QWizard::BackButton)->show();
         return;
     }
 
-    runProcess(extension,
-               QStringList() << "--strict"
-                             << "-c" << m_checksumFile);
+    m_invalidLines = QSharedPointer<int>(new int(0));
+    const QSharedPointer<int> invalidLines = m_invalidLines;
+    runEngine(
+        extension,
+        [file, invalidLines](ChecksumEngine::Entry &entry) {
+            while (!file->atEnd()) {
+                const QString line = QString::fromLocal8Bit(file->readLine());
+                if (line.trimmed().isEmpty())
+                    continue;
+                if (parseChecksumLine(line, entry.expected, entry.fileName))
+                    return true;
+                ++*invalidLines;
+            }
+            return false;
+        },
+        -1,
+        m_stopOnFailureBox->isChecked());
 }
 
 void VerifyWizard::onResultPage()
 {
-    // better not only trust error output
-    const bool errors = m_process->exitCode() != 0 || !m_process->errOutput().isEmpty();
+    QStringList errorLines, outputLines;
+    for (const ChecksumEngine::Result &result : qAsConst(m_results)) {
+        if (!result.error.isEmpty()) {
+            errorLines << i18nc("%1=file name, %2=error", "%1: %2", result.fileName, result.error);
+            outputLines << i18nc("%1=file name", "%1: FAILED open or read", result.fileName);
+        } else if (result.mismatch) {
+            outputLines << i18nc("%1=file name", "%1: FAILED", result.fileName);
+        } else {
+            outputLines << i18nc("%1=file name", "%1: OK", result.fileName);
+        }
+    }
+
+    const int invalidLines = m_invalidLines ? *m_invalidLines : 0;
+    if (invalidLines > 0)
+        errorLines << i18np("1 line is improperly formatted", "%1 lines are improperly formatted", invalidLines);
+    if (m_results.isEmpty() && invalidLines == 0)
+        errorLines << i18n("No properly formatted checksum lines found");
+    if (m_engine->stoppedOnFailure())
+        errorLines << i18n("Stopped at the first file that failed, the remaining files were not verified");
+
+    const bool errors = !errorLines.isEmpty() || std::any_of(m_results.constBegin(), m_results.constEnd(), [](const ChecksumEngine::Result &result) {
+                            return result.mismatch;
+                        });
 
     QWizardPage *page = currentPage();
     page->setPixmap(QWizard::LogoPixmap, Icon(errors ? "dialog-error" : "dialog-information").pixmap(32));
@@ -545,7 +657,7 @@ void VerifyWizard::onResultPage()
 
     // print everything, errors first
     m_outputListWidget->clear();
-    m_outputListWidget->addItems(m_process->errOutput() + m_process->stdOutput());
+    m_outputListWidget->addItems(errorLines + outputLines);
 
     button(QWizard::FinishButton)->setEnabled(!errors);
 }
@@ -553,7 +665,7 @@ void VerifyWizard::onResultPage()
 bool VerifyWizard::isSupported(const QString &path)
 {
     const QFileInfo fileInfo(path);
-    return fileInfo.isFile() && m_checksumTools.contains(fileInfo.suffix());
+    return fileInfo.isFile() && ChecksumEngine::types().contains(fileInfo.suffix());
 }
 
 } // NAMESPACE CHECKSUM_
@@ -12,15 +12,18 @@
 
 // QtCore
 #include <QFutureWatcher>
+#include <QSharedPointer>
 #include <QString>
-#include <QTemporaryFile>
+#include <QTimer>
 // QtWidgets
 #include <QCheckBox>
 #include <QLabel>
+#include <QProgressBar>
 #include <QWizard>
 
 #include <KComboBox>
-#include <KProcess>
+
+#include "checksumengine.h"
 
 class KrListWidget;
 class KrTreeWidget;
@@ -28,8 +31,8 @@ class KrTreeWidget;
 /**
  * Perform checksum operations: Creation of checksums or verifying files with a checksum file.
  *
- * The dialogs are not modal. The used checksum tools only support local files which are expected to
- * be in one directory (specified by 'path').
+ * The dialogs are not modal. The checksums are calculated by ChecksumEngine, for local files only
+ * which are expected to be in one directory (specified by 'path').
  */
 class Checksum
 {
@@ -41,37 +44,6 @@ public:
 namespace CHECKSUM_
 { // private namespace
 
-/** Wrapper for KProcess to handle errors and output. */
-class ChecksumProcess : public KProcess
-{
-    Q_OBJECT
-public:
-    ChecksumProcess(QObject *parent, const QString &path);
-    ~ChecksumProcess() override;
-
-    QStringList stdOutput() const
-    {
-        return m_outputLines;
-    }
-    QStringList errOutput() const
-    {
-        return m_errorLines;
-    }
-
-signals:
-    void resultReady();
-
-private slots:
-    void slotError(QProcess::ProcessError error);
-    void slotFinished(int, QProcess::ExitStatus exitStatus);
-
-private:
-    QStringList m_outputLines;
-    QStringList m_errorLines;
-    QTemporaryFile m_tmpOutFile;
-    QTemporaryFile m_tmpErrFile;
-};
-
 /** Base class for common code in creation and verify wizard. */
 class ChecksumWizard : public QWizard
 {
@@ -82,6 +54,8 @@ public:
 
 private slots:
     void slotCurrentIdChanged(int id);
+    void slotUpdateProgress();
+    void slotEngineFinished();
 
 protected:
     virtual QWizardPage *createIntroPage() = 0;
@@ -93,16 +67,21 @@ protected:
 
     QWizardPage *createProgressPage(const QString &title);
 
-    bool checkExists(const QString &type);
-    void runProcess(const QString &type, const QStringList &args);
+    /// Hash the entries of @p source, the number of entries is @p fileCount or -1 if unknown
+    void runEngine(const QString &type, const ChecksumEngine::Source &source, int fileCount, bool stopOnFailure = false);
     void addChecksumLine(KrTreeWidget *tree, const QString &line);
 
     const QString m_path;
-    ChecksumProcess *m_process;
-
-    QMap<QString, QString> m_checksumTools; // extension/typ-name -> binary name
+    ChecksumEngine *m_engine;
+    QList<ChecksumEngine::Result> m_results; // in the order of the entries, when the engine is done
 
     int m_introId, m_progressId, m_resultId;
+
+private:
+    QTimer m_progressTimer;
+    QProgressBar *m_progressBar;
+    QLabel *m_progressLabel;
+    int m_fileCount;
 };
 
 class CreateWizard : public ChecksumWizard
@@ -127,6 +106,7 @@ private:
     bool saveChecksumFile(const QStringList &data, const QString &filename = QString());
 
     const QStringList m_fileNames;
+    QStringList m_checksumLines; // the lines of the checksum file
 
     QFutureWatcher<QStringList> m_listFilesWatcher;
 
@@ -161,9 +141,11 @@ private:
     bool isSupported(const QString &path);
 
     QString m_checksumFile;
+    QSharedPointer<int> m_invalidLines; // the number of lines of the checksum file which could not be parsed
 
     // intro page
     KrTreeWidget *m_hashesTreeWidget;
+    QCheckBox *m_stopOnFailureBox;
     // result page
     QLabel *m_outputLabel;
     KrListWidget *m_outputListWidget;
@@ -0,0 +1,238 @@
+/*
+    SPDX-FileCopyrightText: 2026 Krusader Krew <https://krusader.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "checksumengine.h"
+
+// QtCore
+#include <QDir>
+#include <QFile>
+#include <QMutexLocker>
+#include <QThread>
+#include <QtConcurrent/QtConcurrentRun> // krazy:exclude=includes
+
+#include <fcntl.h>
+#include <sys/stat.h>
+
+// the files are read in blocks of this size
+static const int READ_SIZE = 1024 * 1024;
+// the number of files read at a time from one filesystem
+static const int MAX_READERS_PER_DEVICE = 4;
+
+static QCryptographicHash::Algorithm algorithmOf(const QString &type)
+{
+    if (type == QLatin1String("sha1"))
+        return QCryptographicHash::Sha1;
+    if (type == QLatin1String("sha224"))
+        return QCryptographicHash::Sha224;
+    if (type == QLatin1String("sha256"))
+        return QCryptographicHash::Sha256;
+    if (type == QLatin1String("sha384"))
+        return QCryptographicHash::Sha384;
+    if (type == QLatin1String("sha512"))
+        return QCryptographicHash::Sha512;
+    return QCryptographicHash::Md5;
+}
+
+ChecksumEngine::ChecksumEngine(QObject *parent)
+    : QObject(parent)
+    , m_algorithm(QCryptographicHash::Md5)
+    , m_stopOnFailure(false)
+    , m_run(this, [this]() {
+        emit finished();
+    })
+    , m_sourceDone(true)
+    , m_nextIndex(0)
+{
+}
+
+ChecksumEngine::~ChecksumEngine()
+{
+    cancel();
+}
+
+QStringList ChecksumEngine::types()
+{
+    return QStringList() << "md5"
+                         << "sha1"
+                         << "sha224"
+                         << "sha256"
+                         << "sha384"
+                         << "sha512";
+}
+
+void ChecksumEngine::start(const QString &basePath, const QString &type, const Source &source, bool stopOnFailure)
+{
+    cancel();
+
+    m_basePath = basePath;
+    m_algorithm = algorithmOf(type);
+    m_stopOnFailure = stopOnFailure;
+    m_bytesDone.storeRelease(0);
+    m_filesDone.storeRelease(0);
+    // hashing is CPU bound once the files are in the cache, one thread per core
+    const int threads = qMax(1, QThread::idealThreadCount());
+    const int generation = m_run.start(threads);
+    {
+        QMutexLocker locker(&m_mutex);
+        m_source = source;
+        m_sourceDone = false;
+        m_nextIndex = 0;
+        m_readers.clear();
+        m_results.clear();
+        m_currentFile.clear();
+    }
+
+    m_pool.setMaxThreadCount(threads);
+    for (int i = 0; i < threads; ++i) {
+        QtConcurrent::run(&m_pool, [=]() {
+            work(generation);
+        });
+    }
+}
+
+void ChecksumEngine::cancel()
+{
+    if (!m_run.cancel())
+        return;
+
+    {
+        QMutexLocker locker(&m_mutex);
+        m_deviceFree.wakeAll();
+    }
+    m_pool.waitForDone();
+
+    QMutexLocker locker(&m_mutex);
+    m_source = Source();
+}
+
+QList<ChecksumEngine::Result> ChecksumEngine::takeResults()
+{
+    QMutexLocker locker(&m_mutex);
+    QList<Result> results;
+    results.swap(m_results);
+    return results;
+}
+
+QString ChecksumEngine::currentFile()
+{
+    QMutexLocker locker(&m_mutex);
+    return m_currentFile;
+}
+
+void ChecksumEngine::work(int generation)
+{
+    Entry entry;
+    int index;
+    while (!m_run.isInterrupted() && nextEntry(entry, index)) {
+        const Result result = hashFile(entry, index);
+        if (result.error.isEmpty() && result.checksum.isEmpty())
+            break; // interrupted, not a result
+
+        m_filesDone.ref();
+        const bool failed = !result.error.isEmpty() || result.mismatch;
+        {
+            QMutexLocker locker(&m_mutex);
+            m_results.append(result);
+        }
+
+        if (failed && m_stopOnFailure) {
+            m_run.stop();
+            QMutexLocker locker(&m_mutex);
+            m_deviceFree.wakeAll();
+        }
+    }
+
+    // a stop on failure delivers the results so far, a cancel() nothing
+    m_run.taskDone(generation);
+}
+
+bool ChecksumEngine::nextEntry(Entry &entry, int &index)
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_sourceDone)
+        return false;
+
+    entry = Entry();
+    if (!m_source(entry)) {
+        m_sourceDone = true;
+        return false;
+    }
+    index = m_nextIndex++;
+    m_currentFile = entry.fileName;
+    return true;
+}
+
+ChecksumEngine::Result ChecksumEngine::hashFile(const Entry &entry, int index)
+{
+    Result result{index, entry.fileName, QString(), QString(), false};
+
+    const QString path = QDir(m_basePath).filePath(entry.fileName);
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Unbuffered)) {
+        result.error = file.errorString();
+        return result;
+    }
+
+    struct stat fileStat;
+    const dev_t device = fstat(file.handle(), &fileStat) == 0 ? fileStat.st_dev : 0;
+    if (!acquireDevice(device))
+        return result;
+
+#ifdef POSIX_FADV_SEQUENTIAL
+    posix_fadvise(file.handle(), 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+
+    QCryptographicHash hash(m_algorithm);
+    QByteArray buffer(READ_SIZE, Qt::Uninitialized);
+    bool interrupted = false;
+    while (true) {
+        if (m_run.isInterrupted()) {
+            interrupted = true;
+            break;
+        }
+        const qint64 count = file.read(buffer.data(), READ_SIZE);
+        if (count < 0) {
+            result.error = file.errorString();
+            break;
+        }
+        if (count == 0)
+            break;
+        hash.addData(buffer.constData(), static_cast<int>(count));
+        m_bytesDone.fetchAndAddOrdered(count);
+    }
+
+    releaseDevice(device);
+
+    if (interrupted || !result.error.isEmpty())
+        return result;
+
+    result.checksum = QString::fromLatin1(hash.result().toHex());
+    result.mismatch = !entry.expected.isEmpty() && QString::compare(result.checksum, entry.expected, Qt::CaseInsensitive) != 0;
+    return result;
+}
+
+bool ChecksumEngine::acquireDevice(dev_t device)
+{
+    QMutexLocker locker(&m_mutex);
+    while (m_readers.value(device) >= MAX_READERS_PER_DEVICE) {
+        if (m_run.isInterrupted())
+            return false;
+        m_deviceFree.wait(&m_mutex);
+    }
+    if (m_run.isInterrupted())
+        return false;
+
+    ++m_readers[device];
+    return true;
+}
+
+void ChecksumEngine::releaseDevice(dev_t device)
+{
+    QMutexLocker locker(&m_mutex);
+    if (--m_readers[device] <= 0)
+        m_readers.remove(device);
+    m_deviceFree.wakeAll();
+}
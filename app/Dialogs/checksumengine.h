@@ -0,0 +1,127 @@
+/*
+    SPDX-FileCopyrightText: 2026 Krusader Krew <https://krusader.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef CHECKSUMENGINE_H
+#define CHECKSUMENGINE_H
+
+// QtCore
+#include <QAtomicInt>
+#include <QAtomicInteger>
+#include <QCryptographicHash>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QThreadPool>
+#include <QWaitCondition>
+
+#include <functional>
+#include <sys/types.h>
+
+#include "../workerrun.h"
+
+/**
+ * Calculates the checksums of local files in a thread pool, several files at once.
+ *
+ * The files are read in large blocks. At most a few files of the same filesystem are read at a
+ * time, so a disk does not seek between the files of all threads. The entries are pulled from a
+ * source function whenever a worker thread gets free, so a checksum file to verify is read while
+ * the files are hashed and not before.
+ *
+ * The results are collected for the receiver in the GUI thread, which takes them with
+ * takeResults(). The progress is polled with bytesDone() and filesDone().
+ */
+class ChecksumEngine : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Entry {
+        QString fileName; //< relative to the base folder, or absolute
+        QString expected; //< the checksum to verify, empty if it is only calculated
+    };
+
+    struct Result {
+        int index; //< the position of the entry in the source
+        QString fileName;
+        QString checksum; //< in lower case hex, empty if the file could not be read
+        QString error; //< why the file could not be read
+        bool mismatch; //< the checksum differs from the expected one
+    };
+
+    /// Fill the next entry, return false at the end. Called in the worker threads, one call at a time.
+    using Source = std::function<bool(Entry &)>;
+
+    explicit ChecksumEngine(QObject *parent = nullptr);
+    ~ChecksumEngine() override;
+
+    /// The supported checksum types, named like the extensions of their checksum files
+    static QStringList types();
+
+    /// Calculate the checksums of @p type for the entries of @p source. If @p stopOnFailure is
+    /// set, no more files are started after the first mismatch or read error.
+    void start(const QString &basePath, const QString &type, const Source &source, bool stopOnFailure = false);
+    /// Stop hashing and wait for the worker threads. The results not taken yet are kept.
+    void cancel();
+    bool isRunning() const
+    {
+        return m_run.isRunning();
+    }
+    /// Return true if the last run stopped at a failure
+    bool stoppedOnFailure() const
+    {
+        return m_run.isStopped();
+    }
+
+    /// Take the results since the last call, in the order they were done. Thread-safe.
+    QList<Result> takeResults();
+    /// The number of bytes hashed in this run. Thread-safe.
+    qint64 bytesDone() const
+    {
+        return m_bytesDone.loadAcquire();
+    }
+    /// The number of files done in this run. Thread-safe.
+    int filesDone() const
+    {
+        return m_filesDone.loadAcquire();
+    }
+    /// The file started last. Thread-safe.
+    QString currentFile();
+
+signals:
+    /// Emitted when all entries are done, or the run stopped on a failure. Not emitted after cancel().
+    void finished();
+
+private:
+    /// Hash entries until the source is exhausted, called in a worker thread
+    void work(int generation);
+    bool nextEntry(Entry &entry, int &index);
+    Result hashFile(const Entry &entry, int index);
+    /// Wait until fewer than the allowed files of @p device are read. Return false if canceled.
+    bool acquireDevice(dev_t device);
+    void releaseDevice(dev_t device);
+
+    QThreadPool m_pool;
+    QString m_basePath;
+    QCryptographicHash::Algorithm m_algorithm;
+    bool m_stopOnFailure;
+    WorkerRun m_run; //< a task per worker thread
+    QAtomicInteger<qint64> m_bytesDone;
+    QAtomicInt m_filesDone;
+
+    QMutex m_mutex; //< protects all following members
+    QWaitCondition m_deviceFree;
+    Source m_source;
+    bool m_sourceDone;
+    int m_nextIndex;
+    QHash<dev_t, int> m_readers; //< the number of files being read per device
+    QList<Result> m_results;
+    QString m_currentFile;
+};
+
+#endif // CHECKSUMENGINE_H
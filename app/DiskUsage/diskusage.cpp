@@ -22,6 +22,7 @@
 #include <QResizeEvent>
 // QtWidgets
 #include <QApplication>
+#include <QFileDialog>
 #include <QFrame>
 #include <QGridLayout>
 #include <QGroupBox>
@@ -50,6 +51,8 @@
 #include "dufilelight.h"
 #include "dulines.h"
 #include "dulistview.h"
+#include "duscanner.h"
+#include "dusnapshot.h"
 #include "filelightParts/Config.h"
 
 // these are the values that will exist in the menu
@@ -67,8 +70,14 @@
 #define NEXT_VIEW_ID 101
 #define PREVIOUS_VIEW_ID 102
 #define ADDITIONAL_POPUP_ID 103
+#define SAVE_SNAPSHOT_ID 104
+#define OPEN_SNAPSHOT_ID 105
+#define COMPARE_SNAPSHOT_ID 106
+#define STOP_COMPARING_ID 107
 
 #define MAX_FILENUM 100
+// interval (ms) of appending the folders listed by the scanner to the tree and refreshing the views
+#define PUBLISH_INTERVAL 500
 
 LoaderWidget::LoaderWidget(QWidget *parent)
     : QScrollArea(parent)
@@ -211,10 +220,16 @@ DiskUsage::DiskUsage(QString confGroup, QWidget *parent)
     Filelight::Config::read();
 
     connect(&loadingTimer, &QTimer::timeout, this, &DiskUsage::slotLoadDirectory);
+
+    scanner = new DUScanner(this);
+    connect(scanner, &DUScanner::finished, this, &DiskUsage::slotScanFinished);
+    connect(&publishTimer, &QTimer::timeout, this, &DiskUsage::slotPublishScanned);
 }
 
 DiskUsage::~DiskUsage()
 {
+    scanner->cancel(); // the worker threads still refer to the tree
+
     if (listView) // don't remove these lines. The module will crash at exit if removed
         delete listView;
     if (lineView)
@@ -235,6 +250,9 @@ void DiskUsage::load(const QUrl &baseDir)
     fileNum = dirNum = 0;
     currentSize = 0;
 
+    scanner->cancel();
+    publishTimer.stop();
+
     emit status(i18n("Loading the disk usage information..."));
 
     clear();
@@ -253,6 +271,30 @@ void DiskUsage::load(const QUrl &baseDir)
         delete searchFileSystem;
         searchFileSystem = nullptr;
     }
+
+    if (baseDir.isLocalFile()) {
+        // local folders are listed in worker threads, see slotPublishScanned()
+        loadingTimer.stop();
+        directoryStack.clear();
+        parentStack.clear();
+        currentFileItem = nullptr;
+        contentMap.insert(QString(), root);
+
+        if (!loading) {
+            viewBeforeLoad = activeView;
+            setView(VIEW_LOADER);
+        }
+        loading = true;
+
+        loaderView->init();
+        loaderView->setCurrentURL(baseURL);
+        loaderView->setValues(fileNum, dirNum, currentSize);
+
+        scanner->start(baseDir.toLocalFile(), root);
+        publishTimer.start(PUBLISH_INTERVAL);
+        return;
+    }
+
     searchFileSystem = FileSystemProvider::instance().getFilesystem(baseDir);
     if (searchFileSystem == nullptr) {
         qWarning() << "could not get filesystem for directory=" << baseDir;
@@ -343,12 +385,10 @@ void DiskUsage::slotLoadDirectory()
                 if (currentFileItem->isDir() && !currentFileItem->isSymLink()) {
                     newItem = new Directory(currentParent,
                                             currentFileItem->getName(),
-                                            dirToCheck,
                                             currentFileItem->getSize(),
                                             currentFileItem->getMode(),
                                             currentFileItem->getOwner(),
                                             currentFileItem->getGroup(),
-                                            currentFileItem->getPerm(),
                                             currentFileItem->getModificationTime(),
                                             currentFileItem->isSymLink(),
                                             mime);
@@ -357,12 +397,10 @@ void DiskUsage::slotLoadDirectory()
                 } else {
                     newItem = new File(currentParent,
                                        currentFileItem->getName(),
-                                       dirToCheck,
                                        currentFileItem->getSize(),
                                        currentFileItem->getMode(),
                                        currentFileItem->getOwner(),
                                        currentFileItem->getGroup(),
-                                       currentFileItem->getPerm(),
                                        currentFileItem->getModificationTime(),
                                        currentFileItem->isSymLink(),
                                        mime);
@@ -380,6 +418,233 @@ void DiskUsage::slotLoadDirectory()
     }
 }
 
+bool DiskUsage::appendScannedItems()
+{
+    bool currentChanged = false;
+
+    const QList<DUScanner::Batch> batches = scanner->takeBatches();
+    for (const DUScanner::Batch &batch : batches) {
+        Directory *dir = batch.directory;
+        const QString prefix = batch.path.isEmpty() ? QString() : batch.path + '/';
+
+        KIO::filesize_t own = 0;
+        for (File *item : batch.items) {
+            dir->append(item);
+            if (dir->isExcluded())
+                item->exclude(true);
+
+            if (item->isDir()) {
+                contentMap.insert(prefix + item->name(), dynamic_cast<Directory *>(item));
+            } else {
+                fileNum++;
+                own += item->size();
+            }
+        }
+        dirNum++;
+
+        // add the sizes up the tree the way calculateSizes() does, without walking the whole tree
+        dir->addSizes(own, own);
+        for (const Directory *d = dir; d->parent() != nullptr && !d->isExcluded(); d = d->parent())
+            const_cast<Directory *>(d->parent())->addSizes(own, 0);
+
+        if (dir == currentDirectory)
+            currentChanged = true;
+    }
+
+    return currentChanged;
+}
+
+void DiskUsage::slotPublishScanned()
+{
+    if (loaderView->wasCancelled() || abortLoading) {
+        finishScan(false);
+        return;
+    }
+
+    const bool currentChanged = appendScannedItems();
+
+    if (activeView == VIEW_LOADER) {
+        loaderView->setCurrentURL(QUrl::fromLocalFile(scanner->currentPath()));
+        loaderView->setValues(fileNum, dirNum, root->size());
+
+        // show the base folder as soon as it is listed, its subfolders grow while they are scanned
+        if (!root->isEmpty()) {
+            setView(viewBeforeLoad);
+            changeDirectory(root);
+        }
+    } else if (currentDirectory != nullptr) {
+        currentSize = currentDirectory->size();
+        if (currentChanged) {
+            calculatePercents(false, currentDirectory, 0, false);
+            emit enteringDirectory(currentDirectory);
+            emit changeFinished();
+        } else {
+            calculatePercents(true, currentDirectory, 0, false);
+        }
+    }
+
+    if (activeView != VIEW_LOADER)
+        emit status(i18n("Loading the disk usage information... Files: %1, Folders: %2, Total size: %3",
+                         fileNum,
+                         dirNum,
+                         KrPermHandler::parseSize(root->size()).trimmed()));
+}
+
+void DiskUsage::slotScanFinished()
+{
+    finishScan(!(loaderView->wasCancelled() || abortLoading));
+}
+
+void DiskUsage::finishScan(bool succeeded)
+{
+    publishTimer.stop();
+    scanner->cancel();
+    appendScannedItems();
+
+    if (activeView == VIEW_LOADER)
+        setView(viewBeforeLoad);
+
+    if (clearAfterAbort)
+        clear();
+    else {
+        calculateSizes();
+        changeDirectory(currentDirectory != nullptr ? currentDirectory : root);
+    }
+
+    emit loadFinished(succeeded);
+
+    loading = abortLoading = clearAfterAbort = false;
+}
+
+bool DiskUsage::isSnapshotFile(const QUrl &url)
+{
+    return url.isLocalFile() && url.path().endsWith(QLatin1String(".krdu"));
+}
+
+bool DiskUsage::saveSnapshot(const QString &fileName)
+{
+    if (root == nullptr || loading)
+        return false;
+    return DUSnapshot::save(fileName, baseURL, root);
+}
+
+bool DiskUsage::loadSnapshot(const QString &fileName)
+{
+    scanner->cancel();
+    publishTimer.stop();
+    loadingTimer.stop();
+    if (searchFileSystem) {
+        delete searchFileSystem;
+        searchFileSystem = nullptr;
+    }
+    currentFileItem = nullptr;
+    if (loading) {
+        setView(viewBeforeLoad);
+        loading = abortLoading = clearAfterAbort = false;
+    }
+
+    QUrl snapshotURL;
+    Directory *snapshotRoot = DUSnapshot::load(fileName, snapshotURL);
+    if (snapshotRoot == nullptr)
+        return false;
+
+    clear();
+    baseURL = snapshotURL.adjusted(QUrl::StripTrailingSlash);
+    root = snapshotRoot;
+    addToContentMap(root, QString());
+
+    calculateSizes();
+    changeDirectory(root);
+    emit loadFinished(true);
+    return true;
+}
+
+void DiskUsage::addToContentMap(Directory *dir, const QString &path)
+{
+    contentMap.insert(path, dir);
+
+    const QString prefix = path.isEmpty() ? QString() : path + '/';
+    for (File *item : *dir)
+        if (item->isDir())
+            addToContentMap(dynamic_cast<Directory *>(item), prefix + item->name());
+}
+
+bool DiskUsage::compareWithSnapshot(const QString &fileName)
+{
+    if (root == nullptr || loading)
+        return false;
+
+    // a previous comparison is dropped even if this one fails
+    QUrl snapshotURL;
+    const DUSnapshot::CompareResult result = DUSnapshot::compare(fileName, baseURL, root, snapshotURL, previousSizes, newItems);
+    refreshViews();
+
+    switch (result) {
+    case DUSnapshot::ReadError:
+        KMessageBox::error(this, i18n("Cannot read the disk usage snapshot %1.", fileName));
+        return false;
+    case DUSnapshot::OtherFolder:
+        KMessageBox::error(this,
+                           i18n("The disk usage snapshot %1 was taken of %2 and cannot be compared with %3.",
+                                fileName,
+                                snapshotURL.toDisplayString(QUrl::PreferLocalFile),
+                                baseURL.toDisplayString(QUrl::PreferLocalFile)));
+        return false;
+    case DUSnapshot::Compared:
+        break;
+    }
+    return true;
+}
+
+void DiskUsage::stopComparing()
+{
+    previousSizes.clear();
+    newItems.clear();
+    refreshViews();
+}
+
+void DiskUsage::refreshViews()
+{
+    if (currentDirectory == nullptr)
+        return;
+
+    emit enteringDirectory(currentDirectory);
+    emit changeFinished();
+}
+
+/// Return true if the item or one of its parents is missing in the compared snapshot
+static bool isNewItem(const File *item, const QSet<const File *> &newItems)
+{
+    for (const File *f = item; f != nullptr; f = f->parent())
+        if (newItems.contains(f))
+            return true;
+    return false;
+}
+
+qint64 DiskUsage::getGrowthSize(File *item)
+{
+    if (!isComparing())
+        return 0;
+    if (isNewItem(item, newItems))
+        return static_cast<qint64>(item->size());
+    return static_cast<qint64>(item->size()) - static_cast<qint64>(previousSizes.value(item, item->size()));
+}
+
+QString DiskUsage::getGrowth(File *item)
+{
+    if (!isComparing())
+        return QString();
+    if (isNewItem(item, newItems))
+        return i18nc("a file or folder missing in the compared snapshot", "new");
+
+    const qint64 growth = getGrowthSize(item);
+    if (growth == 0)
+        return QStringLiteral("0");
+    if (growth > 0)
+        return '+' + KrPermHandler::parseSize(static_cast<KIO::filesize_t>(growth)).trimmed();
+    return '-' + KrPermHandler::parseSize(static_cast<KIO::filesize_t>(-growth)).trimmed();
+}
+
 void DiskUsage::stopLoad()
 {
     abortLoading = true;
@@ -447,9 +712,9 @@ File *DiskUsage::getFile(const QString &path)
     if (dirEntry == nullptr)
         return nullptr;
 
-    for (Iterator<File> it = dirEntry->iterator(); it != dirEntry->end(); ++it)
-        if ((*it)->name() == file)
-            return *it;
+    for (File *item : *dirEntry)
+        if (item->name() == file)
+            return item;
 
     return nullptr;
 }
@@ -465,6 +730,8 @@ void DiskUsage::clear()
 
     propertyMap.clear();
     contentMap.clear();
+    previousSizes.clear();
+    newItems.clear();
     if (root)
         delete root;
     root = currentDirectory = nullptr;
@@ -479,9 +746,7 @@ int DiskUsage::calculateSizes(Directory *dirEntry, bool emitSig, int depth)
 
     KIO::filesize_t own = 0, total = 0;
 
-    for (Iterator<File> it = dirEntry->iterator(); it != dirEntry->end(); ++it) {
-        File *item = *it;
-
+    for (File *item : *dirEntry) {
         if (!item->isExcluded()) {
             if (item->isDir())
                 changeNr += calculateSizes(dynamic_cast<Directory *>(item), emitSig, depth + 1);
@@ -519,8 +784,8 @@ int DiskUsage::exclude(File *file, bool calcPercents, int depth)
 
         if (file->isDir()) {
             auto *dir = dynamic_cast<Directory *>(file);
-            for (Iterator<File> it = dir->iterator(); it != dir->end(); ++it)
-                changeNr += exclude(*it, false, depth + 1);
+            for (File *item : *dir)
+                changeNr += exclude(item, false, depth + 1);
         }
     }
 
@@ -543,9 +808,7 @@ int DiskUsage::include(Directory *dir, int depth)
     if (dir == nullptr)
         return 0;
 
-    for (Iterator<File> it = dir->iterator(); it != dir->end(); ++it) {
-        File *item = *it;
-
+    for (File *item : *dir) {
         if (item->isDir())
             changeNr += include(dynamic_cast<Directory *>(item), depth + 1);
 
@@ -574,7 +837,8 @@ int DiskUsage::del(File *file, bool calcPercents, int depth)
 {
     int deleteNr = 0;
 
-    if (file == root)
+    // the scanner may still add items to the folders
+    if (file == root || scanner->isRunning())
         return 0;
 
     KConfigGroup gg(krConfig, "General");
@@ -612,9 +876,8 @@ int DiskUsage::del(File *file, bool calcPercents, int depth)
     if (file->isDir()) {
         auto *dir = dynamic_cast<Directory *>(file);
 
-        Iterator<File> it;
-        while ((it = dir->iterator()) != dir->end())
-            deleteNr += del(*it, false, depth + 1);
+        while (!dir->isEmpty())
+            deleteNr += del(dir->at(dir->count() - 1), false, depth + 1);
 
         QString path;
         for (const Directory *d = dynamic_cast<Directory *>(file); d != root && d && d->parent() != nullptr; d = d->parent()) {
@@ -650,6 +913,8 @@ int DiskUsage::del(File *file, bool calcPercents, int depth)
     deleting = false;
 
     const_cast<Directory *>(file->parent())->remove(file);
+    previousSizes.remove(file);
+    newItems.remove(file);
     delete file;
 
     if (depth == 0)
@@ -659,7 +924,6 @@ int DiskUsage::del(File *file, bool calcPercents, int depth)
         calculateSizes(root, true);
         calculatePercents(true);
         createStatus();
-        emit enteringDirectory(currentDirectory);
     }
 
     if (depth == 0 && deleteNr != 0)
@@ -779,6 +1043,29 @@ void DiskUsage::rightClickMenu(const QPoint &pos, File *fileItem, QMenu *addPopu
 
     popup.addSeparator();
 
+    QMenu snapshotPopup;
+
+    myAct = snapshotPopup.addAction(i18n("Save..."));
+    actionHash[myAct] = SAVE_SNAPSHOT_ID;
+    myAct->setEnabled(root != nullptr && !loading);
+
+    myAct = snapshotPopup.addAction(i18n("Open..."));
+    actionHash[myAct] = OPEN_SNAPSHOT_ID;
+
+    myAct = snapshotPopup.addAction(i18n("Compare with..."));
+    actionHash[myAct] = COMPARE_SNAPSHOT_ID;
+    myAct->setEnabled(root != nullptr && !loading);
+
+    if (isComparing()) {
+        myAct = snapshotPopup.addAction(i18n("Stop comparing"));
+        actionHash[myAct] = STOP_COMPARING_ID;
+    }
+
+    QAction *snapshotMenu = popup.addMenu(&snapshotPopup);
+    snapshotMenu->setText(i18n("Snapshot"));
+
+    popup.addSeparator();
+
     if (addPopup != nullptr) {
         QAction *menu = popup.addMenu(addPopup);
         menu->setText(addPopupName);
@@ -864,6 +1151,28 @@ void DiskUsage::executeAction(int action, File *fileItem)
     case PREVIOUS_VIEW_ID:
         setView((activeView + 2) % 3);
         break;
+    case SAVE_SNAPSHOT_ID: {
+        QString fileName = QFileDialog::getSaveFileName(this, i18n("Save Disk Usage Snapshot"), QString(), DUSnapshot::fileFilter());
+        if (fileName.isEmpty())
+            break;
+        if (!fileName.endsWith(QLatin1String(".krdu")))
+            fileName += QLatin1String(".krdu");
+        if (!saveSnapshot(fileName))
+            KMessageBox::error(this, i18n("Cannot save the disk usage snapshot to %1.", fileName));
+    } break;
+    case OPEN_SNAPSHOT_ID: {
+        const QString fileName = QFileDialog::getOpenFileName(this, i18n("Open Disk Usage Snapshot"), QString(), DUSnapshot::fileFilter());
+        if (!fileName.isEmpty() && !loadSnapshot(fileName))
+            KMessageBox::error(this, i18n("Cannot read the disk usage snapshot %1.", fileName));
+    } break;
+    case COMPARE_SNAPSHOT_ID: {
+        const QString fileName = QFileDialog::getOpenFileName(this, i18n("Compare with Disk Usage Snapshot"), QString(), DUSnapshot::fileFilter());
+        if (!fileName.isEmpty())
+            compareWithSnapshot(fileName);
+    } break;
+    case STOP_COMPARING_ID:
+        stopComparing();
+        break;
     }
     //     currentWidget()->setFocus();
 }
@@ -984,16 +1293,14 @@ QPixmap DiskUsage::getIcon(const QString &mime)
     return icon;
 }
 
-int DiskUsage::calculatePercents(bool emitSig, Directory *dirEntry, int depth)
+int DiskUsage::calculatePercents(bool emitSig, Directory *dirEntry, int depth, bool recursive)
 {
     int changeNr = 0;
 
     if (dirEntry == nullptr)
         dirEntry = root;
 
-    for (Iterator<File> it = dirEntry->iterator(); it != dirEntry->end(); ++it) {
-        File *item = *it;
-
+    for (File *item : *dirEntry) {
         if (!item->isExcluded()) {
             int newPerc;
 
@@ -1012,7 +1319,7 @@ int DiskUsage::calculatePercents(bool emitSig, Directory *dirEntry, int depth)
                 changeNr++;
             }
 
-            if (item->isDir())
+            if (recursive && item->isDir())
                 changeNr += calculatePercents(emitSig, dynamic_cast<Directory *>(item), depth + 1);
         }
     }
@@ -1041,6 +1348,9 @@ QString DiskUsage::getToolTip(File *item)
     if (item->isDir())
         str += "<tr><td>" + i18n("Own size:") + "</td><td>" + KrPermHandler::parseSize(item->ownSize()) + "</td></tr>";
 
+    if (isComparing())
+        str += "<tr><td>" + i18n("Change:") + "</td><td>" + getGrowth(item) + "</td></tr>";
+
     str += "<tr><td>" + i18n("Last modified:") + "</td><td>" + date + "</td></tr>" + "<tr><td>" + i18n("Permissions:") + "</td><td>" + item->perm()
         + "</td></tr>" + "<tr><td>" + i18n("Owner:") + "</td><td>" + item->owner() + " - " + item->group() + "</td></tr>" + "</table></h5></qt>";
     str.replace(' ', "&nbsp;");
@@ -11,6 +11,7 @@
 // QtCore
 #include <QEvent>
 #include <QHash>
+#include <QSet>
 #include <QStack>
 #include <QTimer>
 #include <QUrl>
@@ -38,6 +39,7 @@ typedef QHash<QString, void *> Properties;
 class DUListView;
 class DULines;
 class DUFilelight;
+class DUScanner;
 class QMenu;
 class LoaderWidget;
 class FileItem;
@@ -98,6 +100,22 @@ public:
         return baseURL;
     }
 
+    /// Return true if the URL is a saved disk usage snapshot which can be opened with loadSnapshot()
+    static bool isSnapshotFile(const QUrl &url);
+    bool saveSnapshot(const QString &fileName);
+    bool loadSnapshot(const QString &fileName);
+    /// Show the growth of every item since the snapshot was saved, the errors are reported to the user
+    bool compareWithSnapshot(const QString &fileName);
+    void stopComparing();
+    bool isComparing()
+    {
+        return !previousSizes.isEmpty();
+    }
+    /// The growth of an item in bytes since the compared snapshot
+    qint64 getGrowthSize(File *);
+    /// The growth of an item as text, empty if no snapshot is compared
+    QString getGrowth(File *);
+
 public slots:
     void dirUp();
     void clear();
@@ -116,6 +134,8 @@ signals:
 
 protected slots:
     void slotLoadDirectory();
+    void slotPublishScanned();
+    void slotScanFinished();
 
 protected:
     QHash<QString, Directory *> contentMap;
@@ -128,10 +148,14 @@ protected:
     virtual bool event(QEvent *) override;
 
     int calculateSizes(Directory *dir = nullptr, bool emitSig = false, int depth = 0);
-    int calculatePercents(bool emitSig = false, Directory *dir = nullptr, int depth = 0);
+    int calculatePercents(bool emitSig = false, Directory *dir = nullptr, int depth = 0, bool recursive = true);
     int include(Directory *dir, int depth = 0);
     void createStatus();
     void executeAction(int, File * = nullptr);
+    bool appendScannedItems();
+    void finishScan(bool succeeded);
+    void addToContentMap(Directory *dir, const QString &path);
+    void refreshViews();
 
     QUrl baseURL; //< the base URL of loading
 
@@ -166,6 +190,12 @@ protected:
     int viewBeforeLoad;
 
     QTimer loadingTimer;
+
+    QHash<const File *, KIO::filesize_t> previousSizes; //< the sizes in the compared snapshot, see DUSnapshot::compare()
+    QSet<const File *> newItems; //< the items missing in the compared snapshot
+
+    DUScanner *scanner; //< lists local folders in worker threads
+    QTimer publishTimer; //< appends the folders listed by the scanner to the tree
 };
 
 class LoaderWidget : public QScrollArea
@@ -31,23 +31,28 @@ DUFilelight::DUFilelight(DiskUsage *usage)
     connect(diskUsage, &DiskUsage::clearing, this, &DUFilelight::clear);
     connect(diskUsage, &DiskUsage::changed, this, &DUFilelight::slotChanged);
     connect(diskUsage, &DiskUsage::deleted, this, &DUFilelight::slotChanged);
-    connect(diskUsage, &DiskUsage::changeFinished, this, &DUFilelight::slotRefresh);
-    connect(diskUsage, &DiskUsage::deleteFinished, this, &DUFilelight::slotRefresh);
+    connect(diskUsage, &DiskUsage::changeFinished, this, &DUFilelight::slotChangeFinished);
+    connect(diskUsage, &DiskUsage::deleteFinished, this, &DUFilelight::slotChangeFinished);
     connect(diskUsage, &DiskUsage::currentChanged, this, &DUFilelight::slotAboutToShow);
 }
 
 void DUFilelight::slotDirChanged(Directory *dir)
 {
+    if (currentDir == dir) {
+        // entered again while scanning, the folder got new content without changed() signals
+        if (dir != nullptr)
+            refreshNeeded = true;
+        return;
+    }
+
     if (diskUsage->currentWidget() != this)
         return;
 
-    if (currentDir != dir) {
-        currentDir = dir;
+    currentDir = dir;
 
-        invalidate(false);
-        create(dir);
-        refreshNeeded = false;
-    }
+    invalidate(false);
+    create(dir);
+    refreshNeeded = false;
 }
 
 void DUFilelight::clear()
@@ -123,6 +128,13 @@ void DUFilelight::mousePressEvent(QMouseEvent *event)
     RadialMap::Widget::mousePressEvent(event);
 }
 
+QString DUFilelight::segmentNote(const File *file) const
+{
+    if (!diskUsage->isComparing())
+        return QString();
+    return i18n("Change: %1", diskUsage->getGrowth(const_cast<File *>(file)));
+}
+
 void DUFilelight::setScheme(Filelight::MapScheme scheme)
 {
     Filelight::Config::scheme = scheme;
@@ -207,8 +219,17 @@ void DUFilelight::slotRefresh()
     }
 }
 
-void DUFilelight::slotChanged(File *)
+void DUFilelight::slotChanged(File *item)
+{
+    // the map shows the current folder only, the changes elsewhere leave it as it is
+    for (const File *file = item; file != nullptr && !refreshNeeded; file = file->parent()) {
+        if (file == currentDir)
+            refreshNeeded = true;
+    }
+}
+
+void DUFilelight::slotChangeFinished()
 {
-    if (!refreshNeeded)
-        refreshNeeded = true;
+    if (refreshNeeded)
+        slotRefresh();
 }
@@ -29,6 +29,7 @@ public slots:
     void clear();
     void slotChanged(File *);
     void slotRefresh();
+    void slotChangeFinished();
 
 protected slots:
     void slotAboutToShow(int);
@@ -55,6 +56,7 @@ protected slots:
 
 protected:
     void mousePressEvent(QMouseEvent *) override;
+    QString segmentNote(const File *) const override;
 
     void setScheme(Filelight::MapScheme);
 
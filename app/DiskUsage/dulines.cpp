@@ -10,16 +10,16 @@
 #include "../FileSystem/krpermhandler.h"
 #include "../icon.h"
 #include "../krglobal.h"
+#include "dumodel.h"
 
-// QtCore
-#include <QTimer>
 // QtGui
 #include <QFontMetrics>
+#include <QHelpEvent>
 #include <QKeyEvent>
+#include <QLinearGradient>
 #include <QMouseEvent>
 #include <QPainter>
 #include <QPen>
-#include <QPixmap>
 // QtWidgets
 #include <QApplication>
 #include <QHeaderView>
@@ -32,6 +32,9 @@
 
 #include "../compat.h"
 
+// the length of the percent bar relative to the longest one, a double
+static const int BarRole = Qt::UserRole + 1;
+
 class DULinesItemDelegate : public QItemDelegate
 {
 public:
@@ -44,7 +47,11 @@ public:
     {
         QItemDelegate::paint(painter, option, index);
 
-        QVariant value = index.data(Qt::UserRole);
+        QVariant value = index.data(BarRole);
+        if (value.isValid())
+            paintBar(painter, option, value.toDouble());
+
+        value = index.data(Qt::UserRole);
         if (value.isValid()) {
             QString text = value.toString();
 
@@ -80,15 +87,11 @@ public:
             int textMargin = QApplication::style()->pixelMetric(QStyle::PM_FocusFrameHMargin);
             int pos = 3 * textMargin + option.fontMetrics.horizontalAdvance(display) + iconSize.width();
 
-            bool truncd = false;
-
             QRect rct = option.rect;
             if (rct.width() > pos) {
                 rct.setX(rct.x() + pos);
 
                 if (fm.horizontalAdvance(renderedText) > rct.width()) {
-                    truncd = true;
-
                     int points = fm.horizontalAdvance("...");
 
                     while (!renderedText.isEmpty() && (fm.horizontalAdvance(renderedText) + points > rct.width()))
@@ -98,78 +101,157 @@ public:
                 }
 
                 painter->drawText(rct, Qt::AlignLeft, renderedText);
-            } else
-                truncd = true;
-
-            if (truncd)
-                const_cast<QAbstractItemModel *>(index.model())->setData(index, QVariant(display + "  " + text), Qt::ToolTipRole);
-            else
-                const_cast<QAbstractItemModel *>(index.model())->setData(index, QVariant(), Qt::ToolTipRole);
+            }
 
             painter->restore();
         }
     }
+
+private:
+    /// Draw the bar at the width of the column, coloured from yellow over green to red
+    static void paintBar(QPainter *painter, const QStyleOptionViewItem &option, double length)
+    {
+        int textMargin = QApplication::style()->pixelMetric(QStyle::PM_FocusFrameHMargin) + 1;
+        int maxWidth = option.rect.width() - 2 * textMargin - 2;
+        int actualWidth = static_cast<int>(maxWidth * length);
+        if (maxWidth < 1 || actualWidth < 1)
+            return;
+
+        int size = option.fontMetrics.height() - 2;
+        int x = option.rect.x() + textMargin;
+        int y = option.rect.y() + (option.rect.height() - size) / 2;
+
+        QLinearGradient gradient(x, 0, x + maxWidth - 1, 0);
+        gradient.setColorAt(0.0, QColor(255, 255, 0));
+        gradient.setColorAt(0.5, QColor(0, 255, 0));
+        gradient.setColorAt(1.0, QColor(255, 0, 0));
+
+        painter->save();
+        painter->setClipRect(option.rect);
+        if (actualWidth > 2)
+            painter->fillRect(QRect(x + 1, y + 1, actualWidth - 2, size - 1), QBrush(gradient));
+
+        painter->setPen(QPen(Qt::black));
+        if (actualWidth != 1)
+            painter->drawRect(QRect(x, y, actualWidth - 1, size - 1));
+        else
+            painter->drawLine(x, y, x, y + size);
+        painter->restore();
+    }
 };
 
-class DULinesItem : public QTreeWidgetItem
+class DULinesModel : public DUModel
 {
 public:
-    DULinesItem(File *fileItem, QTreeWidget *parent, const QString &label1, const QString &label2, const QString &label3)
-        : QTreeWidgetItem(parent)
-        , file(fileItem)
+    explicit DULinesModel(DiskUsage *usage, QObject *parent)
+        : DUModel(usage, false, parent)
+        , showFileSize(true)
     {
-        setText(0, label1);
-        setText(1, label2);
-        setText(2, label3);
-
-        setTextAlignment(1, Qt::AlignRight);
+        labels << i18n("Line View");
+        labels << i18n("Percent");
+        labels << i18n("Name");
     }
-    DULinesItem(File *fileItem, QTreeWidget *parent, QTreeWidgetItem *after, const QString &label1, const QString &label2, const QString &label3)
-        : QTreeWidgetItem(parent, after)
-        , file(fileItem)
+
+    void setShowFileSize(bool show)
     {
-        setText(0, label1);
-        setText(1, label2);
-        setText(2, label3);
+        showFileSize = show;
+        columnChanged(2);
+    }
 
-        setTextAlignment(1, Qt::AlignRight);
+    /// The size and growth shown in italic behind the name
+    QString details(File *item) const
+    {
+        QStringList parts;
+        if (showFileSize)
+            parts << KIO::convertSize(item->size());
+        if (diskUsage->isComparing())
+            parts << diskUsage->getGrowth(item);
+        if (parts.isEmpty())
+            return QString();
+        return "  [" + parts.join(QStringLiteral(", ")) + ']';
     }
 
-    bool operator<(const QTreeWidgetItem &other) const override
+    int columnCount(const QModelIndex & = QModelIndex()) const override
     {
-        int column = treeWidget() ? treeWidget()->sortColumn() : 0;
+        return labels.count();
+    }
 
-        if (text(0) == "..")
-            return true;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override
+    {
+        if (orientation == Qt::Horizontal && role == Qt::DisplayRole && section >= 0 && section < labels.count())
+            return labels.at(section);
+        return QVariant();
+    }
 
-        const auto *compWith = dynamic_cast<const DULinesItem *>(&other);
-        if (compWith == nullptr)
-            return false;
+    QVariant data(const QModelIndex &index, int role) const override
+    {
+        if (!index.isValid())
+            return QVariant();
+
+        if (isUpItem(index)) {
+            if (index.column() == 0 && role == Qt::DisplayRole)
+                return "..";
+            if (index.column() == 0 && role == Qt::DecorationRole)
+                return Icon("go-up");
+            return QVariant();
+        }
 
-        switch (column) {
+        File *item = file(index);
+        switch (index.column()) {
         case 0:
+            if (role == BarRole) {
+                const int percent = item->intPercent();
+                const int max = maxPercent();
+                if (percent < 0 || percent > max || max == 0)
+                    return QVariant();
+                return static_cast<double>(percent) / max;
+            }
+            break;
         case 1:
-            return file->size() > compWith->file->size();
+            if (role == Qt::DisplayRole)
+                return item->percent() + "  ";
+            if (role == Qt::TextAlignmentRole)
+                return QVariant(Qt::AlignRight | Qt::AlignVCenter);
+            break;
+        case 2:
+            if (role == Qt::DisplayRole)
+                return item->name();
+            if (role == Qt::DecorationRole)
+                return diskUsage->getIcon(item->mime());
+            if (role == Qt::UserRole) {
+                const QString text = details(item);
+                return text.isEmpty() ? QVariant() : text;
+            }
+            break;
         default:
-            return text(column) < other.text(column);
+            break;
         }
+        return QVariant();
     }
 
-    inline File *getFile()
+protected:
+    bool lessThan(const File *file1, const File *file2, int column) const override
     {
-        return file;
+        switch (column) {
+        case 0:
+        case 1:
+            return file1->size() > file2->size();
+        default:
+            return file1->name() < file2->name();
+        }
     }
 
 private:
-    File *file;
+    QStringList labels;
+    bool showFileSize;
 };
 
 DULines::DULines(DiskUsage *usage)
-    : KrTreeWidget(usage)
+    : KrTreeView(usage)
     , diskUsage(usage)
-    , refreshNeeded(false)
-    , started(false)
+    , model(new DULinesModel(usage, this))
 {
+    setModel(model);
     setItemDelegate(itemDelegate = new DULinesItemDelegate());
 
     setAllColumnsShowFocus(true);
@@ -179,17 +261,12 @@ DULines::DULines(DiskUsage *usage)
 
     int defaultSize = QFontMetrics(font()).horizontalAdvance("W");
 
-    QStringList labels;
-    labels << i18n("Line View");
-    labels << i18n("Percent");
-    labels << i18n("Name");
-    setHeaderLabels(labels);
-
     header()->setSectionResizeMode(QHeaderView::Interactive);
 
     KConfigGroup group(krConfig, diskUsage->getConfigGroup());
 
     showFileSize = group.readEntry("L Show File Size", true);
+    model->setShowFileSize(showFileSize);
 
     if (group.hasKey("L State"))
         header()->restoreState(group.readEntry("L State", QByteArray()));
@@ -202,18 +279,14 @@ DULines::DULines(DiskUsage *usage)
     setStretchingColumn(0);
 
     header()->setSortIndicatorShown(true);
-    sortItems(1, Qt::AscendingOrder);
+    sortByColumn(1, Qt::AscendingOrder);
 
     connect(diskUsage, &DiskUsage::enteringDirectory, this, &DULines::slotDirChanged);
-    connect(diskUsage, &DiskUsage::clearing, this, &DULines::clear);
-
-    connect(header(), &QHeaderView::sectionResized, this, &DULines::sectionResized);
+    connect(diskUsage, &DiskUsage::clearing, model, &DUModel::clear);
 
     connect(this, &DULines::itemRightClicked, this, &DULines::slotRightClicked);
-    connect(diskUsage, &DiskUsage::changed, this, &DULines::slotChanged);
-    connect(diskUsage, &DiskUsage::deleted, this, &DULines::slotDeleted);
-
-    started = true;
+    connect(diskUsage, &DiskUsage::changed, model, &DUModel::slotChanged);
+    connect(diskUsage, &DiskUsage::deleted, model, &DUModel::slotDeleted);
 }
 
 DULines::~DULines()
@@ -224,176 +297,50 @@ DULines::~DULines()
     delete itemDelegate;
 }
 
-bool DULines::event(QEvent *event)
+bool DULines::viewportEvent(QEvent *event)
 {
-    switch (event->type()) {
-    case QEvent::ToolTip: {
+    if (event->type() == QEvent::ToolTip) {
         auto *he = dynamic_cast<QHelpEvent *>(event);
+        const QModelIndex index = indexAt(he->pos());
+        File *fileItem = model->file(index);
 
-        if (viewport()) {
-            QPoint pos = viewport()->mapFromGlobal(he->globalPos());
-
-            QTreeWidgetItem *item = itemAt(pos);
+        if (fileItem && index.column() == 1) {
+            QToolTip::showText(he->globalPos(), diskUsage->getToolTip(fileItem), this);
+            return true;
+        }
 
-            int column = columnAt(pos.x());
+        if (fileItem && index.column() == 2) {
+            // the name and the italic details behind it, if they don't fit
+            const QString details = model->details(fileItem);
+            QFont fnt = font();
+            fnt.setItalic(true);
 
-            if (item && column == 1) {
-                File *fileItem = (dynamic_cast<DULinesItem *>(item))->getFile();
-                QToolTip::showText(he->globalPos(), diskUsage->getToolTip(fileItem), this);
-                return true;
-            }
+            const int requiredWidth = itemDelegate->sizeHint(viewOptions(), index).width() + QFontMetrics(fnt).horizontalAdvance(details);
+            if (visualRect(index).width() < requiredWidth)
+                QToolTip::showText(he->globalPos(), fileItem->name() + details, viewport());
+            else
+                QToolTip::hideText();
+            return true;
         }
-    } break;
-    default:
-        break;
     }
-    return KrTreeWidget::event(event);
+    return KrTreeView::viewportEvent(event);
 }
 
 void DULines::slotDirChanged(Directory *dirEntry)
 {
-    clear();
-
-    QTreeWidgetItem *lastItem = nullptr;
+    const bool entered = model->directory() != dirEntry;
+    model->setDirectory(dirEntry);
 
-    if (!(dirEntry->parent() == nullptr)) {
-        lastItem = new QTreeWidgetItem(this);
-        lastItem->setText(0, "..");
-        lastItem->setIcon(0, Icon("go-up"));
-        lastItem->setFlags(lastItem->flags() & (~Qt::ItemIsSelectable));
-    }
-
-    int maxPercent = -1;
-    for (Iterator<File> it = dirEntry->iterator(); it != dirEntry->end(); ++it) {
-        File *item = *it;
-        if (!item->isExcluded() && item->intPercent() > maxPercent)
-            maxPercent = item->intPercent();
-    }
-
-    for (Iterator<File> it = dirEntry->iterator(); it != dirEntry->end(); ++it) {
-        File *item = *it;
-
-        QString fileName = item->name();
-
-        if (lastItem == nullptr)
-            lastItem = new DULinesItem(item, this, "", item->percent() + "  ", fileName);
-        else
-            lastItem = new DULinesItem(item, this, lastItem, "", item->percent() + "  ", fileName);
-
-        if (item->isExcluded())
-            lastItem->setHidden(true);
-
-        int textMargin = QApplication::style()->pixelMetric(QStyle::PM_FocusFrameHMargin) + 1;
-
-        lastItem->setIcon(2, diskUsage->getIcon(item->mime()));
-        lastItem->setData(0, Qt::DecorationRole, createPixmap(item->intPercent(), maxPercent, header()->sectionSize(0) - 2 * textMargin));
-
-        if (showFileSize)
-            lastItem->setData(2, Qt::UserRole, "  [" + KIO::convertSize(item->size()) + ']');
-
-        QSize size = lastItem->sizeHint(0);
-        size.setWidth(16);
-        lastItem->setSizeHint(0, size);
-    }
-
-    if (topLevelItemCount() > 0) {
-        setCurrentItem(topLevelItem(0));
-    }
+    model->fetchMore(QModelIndex());
+    if (entered && model->rowCount() > 0)
+        setCurrentIndex(model->index(0, 0));
 }
 
-QPixmap DULines::createPixmap(int percent, int maxPercent, int maxWidth)
+bool DULines::doubleClicked(const QModelIndex &index)
 {
-    if (percent < 0 || percent > maxPercent || maxWidth < 2 || maxPercent == 0)
-        return QPixmap();
-    maxWidth -= 2;
-
-    int actualWidth = maxWidth * percent / maxPercent;
-    if (actualWidth == 0)
-        return QPixmap();
-
-    QPen pen;
-    pen.setColor(Qt::black);
-    QPainter painter;
-
-    int size = QFontMetrics(font()).height() - 2;
-    QRect rect(0, 0, actualWidth, size);
-    QRect frameRect(0, 0, actualWidth - 1, size - 1);
-    QPixmap pixmap(rect.width(), rect.height());
-
-    painter.begin(&pixmap);
-    painter.setPen(pen);
-
-    for (int i = 1; i < actualWidth - 1; i++) {
-        int color = (511 * i / (maxWidth - 1));
-        if (color < 256)
-            pen.setColor(QColor(255 - color, 255, 0));
-        else
-            pen.setColor(QColor(color - 256, 511 - color, 0));
-
-        painter.setPen(pen);
-        painter.drawLine(i, 1, i, size - 1);
-    }
-
-    pen.setColor(Qt::black);
-    painter.setPen(pen);
-
-    if (actualWidth != 1)
-        painter.drawRect(frameRect);
-    else
-        painter.drawLine(0, 0, 0, size);
-
-    painter.end();
-    pixmap.detach();
-    return pixmap;
-}
-
-void DULines::resizeEvent(QResizeEvent *re)
-{
-    KrTreeWidget::resizeEvent(re);
-
-    if (started && (re->oldSize() != re->size()))
-        sectionResized(0);
-}
-
-void DULines::sectionResized(int column)
-{
-    if (topLevelItemCount() == 0 || column != 0)
-        return;
-
-    Directory *currentDir = diskUsage->getCurrentDir();
-    if (currentDir == nullptr)
-        return;
-
-    int maxPercent = -1;
-    for (Iterator<File> it = currentDir->iterator(); it != currentDir->end(); ++it) {
-        File *item = *it;
-
-        if (!item->isExcluded() && item->intPercent() > maxPercent)
-            maxPercent = item->intPercent();
-    }
-
-    QTreeWidgetItemIterator it2(this);
-    while (*it2) {
-        QTreeWidgetItem *lvitem = *it2;
-        if (lvitem->text(0) != "..") {
-            auto *duItem = dynamic_cast<DULinesItem *>(lvitem);
-            if (duItem) {
-                int textMargin = QApplication::style()->pixelMetric(QStyle::PM_FocusFrameHMargin) + 1;
-                duItem->setData(0, Qt::DecorationRole, createPixmap(duItem->getFile()->intPercent(), maxPercent, header()->sectionSize(0) - 2 * textMargin));
-                QSize size = duItem->sizeHint(0);
-                size.setWidth(16);
-                duItem->setSizeHint(0, size);
-            }
-        }
-        it2++;
-    }
-}
-
-bool DULines::doubleClicked(QTreeWidgetItem *item)
-{
-    if (item) {
-        if (item->text(0) != "..") {
-            File *fileItem = (dynamic_cast<DULinesItem *>(item))->getFile();
+    if (index.isValid()) {
+        if (!model->isUpItem(index)) {
+            File *fileItem = model->file(index);
             if (fileItem->isDir())
                 diskUsage->changeDirectory(dynamic_cast<Directory *>(fileItem));
             return true;
@@ -412,12 +359,11 @@ void DULines::mouseDoubleClickEvent(QMouseEvent *e)
 {
     if (e || e->button() == Qt::LeftButton) {
         QPoint vp = viewport()->mapFromGlobal(e->globalPos());
-        QTreeWidgetItem *item = itemAt(vp);
 
-        if (doubleClicked(item))
+        if (doubleClicked(indexAt(vp)))
             return;
     }
-    KrTreeWidget::mouseDoubleClickEvent(e);
+    KrTreeView::mouseDoubleClickEvent(e);
 }
 
 void DULines::keyPressEvent(QKeyEvent *e)
@@ -425,7 +371,7 @@ void DULines::keyPressEvent(QKeyEvent *e)
     switch (e->key()) {
     case Qt::Key_Return:
     case Qt::Key_Enter:
-        if (doubleClicked(currentItem()))
+        if (doubleClicked(currentIndex()))
             return;
         break;
     case Qt::Key_Left:
@@ -441,84 +387,25 @@ void DULines::keyPressEvent(QKeyEvent *e)
         e->ignore();
         return;
     }
-    KrTreeWidget::keyPressEvent(e);
+    KrTreeView::keyPressEvent(e);
 }
 
-void DULines::slotRightClicked(QTreeWidgetItem *item, const QPoint &pos)
+void DULines::slotRightClicked(const QModelIndex &index, const QPoint &pos)
 {
-    File *file = nullptr;
-
-    if (item && item->text(0) != "..")
-        file = (dynamic_cast<DULinesItem *>(item))->getFile();
-
     QMenu linesPopup;
     QAction *act = linesPopup.addAction(i18n("Show file sizes"), this, SLOT(slotShowFileSizes()));
     act->setChecked(showFileSize);
 
-    diskUsage->rightClickMenu(pos, file, &linesPopup, i18n("Lines"));
+    diskUsage->rightClickMenu(pos, model->file(index), &linesPopup, i18n("Lines"));
 }
 
 void DULines::slotShowFileSizes()
 {
     showFileSize = !showFileSize;
-    slotDirChanged(diskUsage->getCurrentDir());
+    model->setShowFileSize(showFileSize);
 }
 
 File *DULines::getCurrentFile()
 {
-    QTreeWidgetItem *item = currentItem();
-
-    if (item == nullptr || item->text(0) == "..")
-        return nullptr;
-
-    return (dynamic_cast<DULinesItem *>(item))->getFile();
-}
-
-void DULines::slotChanged(File *item)
-{
-    QTreeWidgetItemIterator it(this);
-    while (*it) {
-        QTreeWidgetItem *lvitem = *it;
-        it++;
-
-        if (lvitem->text(0) != "..") {
-            auto *duItem = dynamic_cast<DULinesItem *>(lvitem);
-            if (duItem->getFile() == item) {
-                setSortingEnabled(false);
-                duItem->setHidden(item->isExcluded());
-                duItem->setText(1, item->percent());
-                if (!refreshNeeded) {
-                    refreshNeeded = true;
-                    QTimer::singleShot(0, this, &DULines::slotRefresh);
-                }
-                break;
-            }
-        }
-    }
-}
-
-void DULines::slotDeleted(File *item)
-{
-    QTreeWidgetItemIterator it(this);
-    while (*it) {
-        QTreeWidgetItem *lvitem = *it;
-        it++;
-
-        if (lvitem->text(0) != "..") {
-            auto *duItem = dynamic_cast<DULinesItem *>(lvitem);
-            if (duItem->getFile() == item) {
-                delete duItem;
-                break;
-            }
-        }
-    }
-}
-
-void DULines::slotRefresh()
-{
-    if (refreshNeeded) {
-        refreshNeeded = false;
-        setSortingEnabled(true);
-        sortItems(1, Qt::AscendingOrder);
-    }
+    return model->file(currentIndex());
 }
@@ -11,16 +11,14 @@
 // QtGui
 #include <QKeyEvent>
 #include <QMouseEvent>
-#include <QPixmap>
-#include <QResizeEvent>
 
-#include "../GUI/krtreewidget.h"
+#include "../GUI/krtreeview.h"
 #include "diskusage.h"
 
-class DULinesToolTip;
 class DULinesItemDelegate;
+class DULinesModel;
 
-class DULines : public KrTreeWidget
+class DULines : public KrTreeView
 {
     Q_OBJECT
 
@@ -32,32 +30,22 @@ public:
 
 public slots:
     void slotDirChanged(Directory *dirEntry);
-    void sectionResized(int);
-    void slotRightClicked(QTreeWidgetItem *, const QPoint &);
-    void slotChanged(File *);
-    void slotDeleted(File *);
+    void slotRightClicked(const QModelIndex &, const QPoint &);
     void slotShowFileSizes();
-    void slotRefresh();
 
 protected:
     DiskUsage *diskUsage;
 
-    bool event(QEvent *event) override;
+    bool viewportEvent(QEvent *event) override;
     void mouseDoubleClickEvent(QMouseEvent *e) override;
     void keyPressEvent(QKeyEvent *e) override;
-    void resizeEvent(QResizeEvent *) override;
 
 private:
-    QPixmap createPixmap(int percent, int maxPercent, int maxWidth);
-
-    bool doubleClicked(QTreeWidgetItem *item);
-
-    bool refreshNeeded;
-    bool started;
+    bool doubleClicked(const QModelIndex &index);
 
     bool showFileSize;
 
-    DULinesToolTip *toolTip;
+    DULinesModel *model;
     DULinesItemDelegate *itemDelegate;
 };
 
@@ -9,8 +9,11 @@
 #include "../FileSystem/krpermhandler.h"
 #include "../icon.h"
 #include "../krglobal.h"
+#include "dumodel.h"
 
 // QtCore
+#include <QDateTime>
+#include <QLocale>
 #include <QMimeDatabase>
 #include <QMimeType>
 // QtGui
@@ -19,16 +22,155 @@
 #include <QMouseEvent>
 // QtWidgets
 #include <QHeaderView>
+#include <QScrollBar>
 
 #include <KLocalizedString>
 #include <KSharedConfig>
 
 #include "../compat.h"
 
+class DUListModel : public DUModel
+{
+public:
+    explicit DUListModel(DiskUsage *usage, QObject *parent)
+        : DUModel(usage, true, parent)
+    {
+        labels << i18n("Name");
+        labels << i18n("Percent");
+        labels << i18n("Total size");
+        labels << i18n("Own size");
+        labels << i18n("Type");
+        labels << i18n("Date");
+        labels << i18n("Permissions");
+        labels << i18n("Owner");
+        labels << i18n("Group");
+        labels << i18n("Change");
+    }
+
+    int columnCount(const QModelIndex & = QModelIndex()) const override
+    {
+        return labels.count();
+    }
+
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override
+    {
+        if (orientation == Qt::Horizontal && role == Qt::DisplayRole && section >= 0 && section < labels.count())
+            return labels.at(section);
+        return QVariant();
+    }
+
+    QVariant data(const QModelIndex &index, int role) const override
+    {
+        if (!index.isValid())
+            return QVariant();
+
+        if (isUpItem(index)) {
+            if (index.column() == 0 && role == Qt::DisplayRole)
+                return "..";
+            if (index.column() == 0 && role == Qt::DecorationRole)
+                return Icon("go-up");
+            return QVariant();
+        }
+
+        File *item = file(index);
+        switch (role) {
+        case Qt::DisplayRole:
+            return text(item, index.column());
+        case Qt::DecorationRole:
+            if (index.column() == 0)
+                return diskUsage->getIcon(item->mime());
+            break;
+        case Qt::TextAlignmentRole:
+            switch (index.column()) {
+            case 1:
+            case 2:
+            case 3:
+            case 9:
+                return QVariant(Qt::AlignRight | Qt::AlignVCenter);
+            default:
+                break;
+            }
+            break;
+        default:
+            break;
+        }
+        return QVariant();
+    }
+
+protected:
+    bool lessThan(const File *file1, const File *file2, int column) const override
+    {
+        switch (column) {
+        case 1:
+        case 2:
+            return file1->size() > file2->size();
+        case 3:
+            return file1->ownSize() > file2->ownSize();
+        case 5:
+            return file1->time() < file2->time();
+        case 9:
+            return diskUsage->getGrowthSize(const_cast<File *>(file1)) > diskUsage->getGrowthSize(const_cast<File *>(file2));
+        default:
+            return text(const_cast<File *>(file1), column) < text(const_cast<File *>(file2), column);
+        }
+    }
+
+private:
+    /// The texts are only made for the shown rows, and when sorting by a text column
+    QString text(File *item, int column) const
+    {
+        switch (column) {
+        case 0:
+            return item->name();
+        case 1:
+            return item->percent();
+        case 2:
+            return KrPermHandler::parseSize(item->size()) + ' ';
+        case 3:
+            return KrPermHandler::parseSize(item->ownSize()) + ' ';
+        case 4:
+            return mimeComment(item->mime());
+        case 5: {
+            time_t tma = item->time();
+            struct tm *t = localtime(&tma);
+            QDateTime tmp(QDate(t->tm_year + 1900, t->tm_mon + 1, t->tm_mday), QTime(t->tm_hour, t->tm_min));
+            return QLocale().toString(tmp, QLocale::ShortFormat);
+        }
+        case 6:
+            return item->perm();
+        case 7:
+            return item->owner();
+        case 8:
+            return item->group();
+        case 9:
+            return diskUsage->getGrowth(item);
+        default:
+            return QString();
+        }
+    }
+
+    QString mimeComment(const QString &mime) const
+    {
+        auto it = mimeComments.constFind(mime);
+        if (it == mimeComments.constEnd()) {
+            QMimeType mt = mimeDatabase.mimeTypeForName(mime);
+            it = mimeComments.insert(mime, mt.isValid() ? mt.comment() : QString());
+        }
+        return *it;
+    }
+
+    QStringList labels;
+    QMimeDatabase mimeDatabase;
+    mutable QHash<QString, QString> mimeComments; //< the comments of the mime types by name
+};
+
 DUListView::DUListView(DiskUsage *usage)
-    : KrTreeWidget(usage)
+    : KrTreeView(usage)
     , diskUsage(usage)
+    , model(new DUListModel(usage, this))
 {
+    setModel(model);
+
     setAllColumnsShowFocus(true);
     setVerticalScrollBarPolicy(Qt::ScrollBarAsNeeded);
     setHorizontalScrollBarPolicy(Qt::ScrollBarAsNeeded);
@@ -36,18 +178,6 @@ DUListView::DUListView(DiskUsage *usage)
     setIndentation(10);
     setItemsExpandable(true);
 
-    QStringList labels;
-    labels << i18n("Name");
-    labels << i18n("Percent");
-    labels << i18n("Total size");
-    labels << i18n("Own size");
-    labels << i18n("Type");
-    labels << i18n("Date");
-    labels << i18n("Permissions");
-    labels << i18n("Owner");
-    labels << i18n("Group");
-    setHeaderLabels(labels);
-
     header()->setSectionResizeMode(QHeaderView::Interactive);
 
     KConfigGroup group(krConfig, diskUsage->getConfigGroup());
@@ -66,18 +196,20 @@ DUListView::DUListView(DiskUsage *usage)
         setColumnWidth(6, defaultSize * 6);
         setColumnWidth(7, defaultSize * 5);
         setColumnWidth(8, defaultSize * 5);
+        setColumnWidth(9, defaultSize * 8);
     }
 
     header()->setSortIndicatorShown(true);
-    sortItems(2, Qt::AscendingOrder);
+    sortByColumn(2, Qt::AscendingOrder);
 
     connect(diskUsage, &DiskUsage::enteringDirectory, this, &DUListView::slotDirChanged);
-    connect(diskUsage, &DiskUsage::clearing, this, &DUListView::clear);
-    connect(diskUsage, &DiskUsage::changed, this, &DUListView::slotChanged);
-    connect(diskUsage, &DiskUsage::deleted, this, &DUListView::slotDeleted);
+    connect(diskUsage, &DiskUsage::clearing, model, &DUModel::clear);
+    connect(diskUsage, &DiskUsage::changed, model, &DUModel::slotChanged);
+    connect(diskUsage, &DiskUsage::deleted, model, &DUModel::slotDeleted);
 
     connect(this, &DUListView::itemRightClicked, this, &DUListView::slotRightClicked);
-    connect(this, &DUListView::itemExpanded, this, &DUListView::slotExpanded);
+    connect(this, &DUListView::expanded, this, &DUListView::fetchVisible);
+    connect(verticalScrollBar(), &QScrollBar::valueChanged, this, &DUListView::fetchVisible);
 }
 
 DUListView::~DUListView()
@@ -86,138 +218,46 @@ DUListView::~DUListView()
     group.writeEntry("D State", header()->saveState());
 }
 
-void DUListView::addDirectory(Directory *dirEntry, QTreeWidgetItem *parent)
-{
-    QTreeWidgetItem *lastItem = nullptr;
-
-    if (parent == nullptr && !(dirEntry->parent() == nullptr)) {
-        lastItem = new QTreeWidgetItem(this);
-        lastItem->setText(0, "..");
-        lastItem->setIcon(0, Icon("go-up"));
-        lastItem->setFlags(Qt::ItemIsEnabled);
-    }
-
-    for (Iterator<File> it = dirEntry->iterator(); it != dirEntry->end(); ++it) {
-        File *item = *it;
-
-        QMimeDatabase db;
-        QMimeType mt = db.mimeTypeForName(item->mime());
-        QString mime;
-        if (mt.isValid())
-            mime = mt.comment();
-
-        time_t tma = item->time();
-        struct tm *t = localtime((time_t *)&tma);
-        QDateTime tmp(QDate(t->tm_year + 1900, t->tm_mon + 1, t->tm_mday), QTime(t->tm_hour, t->tm_min));
-        QString date = QLocale().toString(tmp, QLocale::ShortFormat);
-
-        QString totalSize = KrPermHandler::parseSize(item->size()) + ' ';
-        QString ownSize = KrPermHandler::parseSize(item->ownSize()) + ' ';
-        QString percent = item->percent();
-
-        if (lastItem == nullptr && parent == nullptr)
-            lastItem =
-                new DUListViewItem(diskUsage, item, this, item->name(), percent, totalSize, ownSize, mime, date, item->perm(), item->owner(), item->group());
-        else if (lastItem == nullptr)
-            lastItem =
-                new DUListViewItem(diskUsage, item, parent, item->name(), percent, totalSize, ownSize, mime, date, item->perm(), item->owner(), item->group());
-        else if (parent == nullptr)
-            lastItem = new DUListViewItem(diskUsage,
-                                          item,
-                                          this,
-                                          lastItem,
-                                          item->name(),
-                                          percent,
-                                          totalSize,
-                                          ownSize,
-                                          mime,
-                                          date,
-                                          item->perm(),
-                                          item->owner(),
-                                          item->group());
-        else
-            lastItem = new DUListViewItem(diskUsage,
-                                          item,
-                                          parent,
-                                          lastItem,
-                                          item->name(),
-                                          percent,
-                                          totalSize,
-                                          ownSize,
-                                          mime,
-                                          date,
-                                          item->perm(),
-                                          item->owner(),
-                                          item->group());
-
-        if (item->isExcluded())
-            lastItem->setHidden(true);
-
-        lastItem->setIcon(0, diskUsage->getIcon(item->mime()));
-
-        if (item->isDir() && !item->isSymLink())
-            lastItem->setChildIndicatorPolicy(QTreeWidgetItem::ShowIndicator);
-    }
-
-    if (topLevelItemCount() > 0) {
-        setCurrentItem(topLevelItem(0));
-    }
-}
-
 void DUListView::slotDirChanged(Directory *dirEntry)
 {
-    clear();
-    addDirectory(dirEntry, nullptr);
-}
+    const bool entered = model->directory() != dirEntry;
+    model->setDirectory(dirEntry);
+    setColumnHidden(9, !diskUsage->isComparing());
 
-File *DUListView::getCurrentFile()
-{
-    QTreeWidgetItem *item = currentItem();
-
-    if (item == nullptr || item->text(0) == "..")
-        return nullptr;
-
-    return (dynamic_cast<DUListViewItem *>(item))->getFile();
+    model->fetchMore(QModelIndex());
+    if (entered && model->rowCount() > 0)
+        setCurrentIndex(model->index(0, 0));
 }
 
-void DUListView::slotChanged(File *item)
+void DUListView::fetchVisible()
 {
-    void *itemPtr = diskUsage->getProperty(item, "ListView-Ref");
-    if (itemPtr == nullptr)
-        return;
-
-    auto *duItem = (DUListViewItem *)itemPtr;
-    duItem->setHidden(item->isExcluded());
-    duItem->setText(1, item->percent());
-    duItem->setText(2, KrPermHandler::parseSize(item->size()) + ' ');
-    duItem->setText(3, KrPermHandler::parseSize(item->ownSize()) + ' ');
+    // the view fetches the rows of the top level by itself, but not those of the expanded folders
+    const int bottom = viewport()->height();
+    for (QModelIndex index = indexAt(QPoint(0, 0)); index.isValid() && visualRect(index).top() < bottom; index = indexBelow(index)) {
+        if (isExpanded(index) && model->rowCount(index) == 0 && model->canFetchMore(index))
+            model->fetchMore(index);
+
+        const QModelIndex parent = index.parent();
+        if (parent.isValid() && index.row() == model->rowCount(parent) - 1 && model->canFetchMore(parent))
+            model->fetchMore(parent);
+    }
 }
 
-void DUListView::slotDeleted(File *item)
+File *DUListView::getCurrentFile()
 {
-    void *itemPtr = diskUsage->getProperty(item, "ListView-Ref");
-    if (itemPtr == nullptr)
-        return;
-
-    auto *duItem = (DUListViewItem *)itemPtr;
-    delete duItem;
+    return model->file(currentIndex());
 }
 
-void DUListView::slotRightClicked(QTreeWidgetItem *item, const QPoint &pos)
+void DUListView::slotRightClicked(const QModelIndex &index, const QPoint &pos)
 {
-    File *file = nullptr;
-
-    if (item && item->text(0) != "..")
-        file = (dynamic_cast<DUListViewItem *>(item))->getFile();
-
-    diskUsage->rightClickMenu(pos, file);
+    diskUsage->rightClickMenu(pos, model->file(index));
 }
 
-bool DUListView::doubleClicked(QTreeWidgetItem *item)
+bool DUListView::doubleClicked(const QModelIndex &index)
 {
-    if (item) {
-        if (item->text(0) != "..") {
-            File *fileItem = (dynamic_cast<DUListViewItem *>(item))->getFile();
+    if (index.isValid()) {
+        if (!model->isUpItem(index)) {
+            File *fileItem = model->file(index);
             if (fileItem->isDir())
                 diskUsage->changeDirectory(dynamic_cast<Directory *>(fileItem));
             return true;
@@ -236,12 +276,11 @@ void DUListView::mouseDoubleClickEvent(QMouseEvent *e)
 {
     if (e || e->button() == Qt::LeftButton) {
         QPoint vp = viewport()->mapFromGlobal(e->globalPos());
-        QTreeWidgetItem *item = itemAt(vp);
 
-        if (doubleClicked(item))
+        if (doubleClicked(indexAt(vp)))
             return;
     }
-    KrTreeWidget::mouseDoubleClickEvent(e);
+    KrTreeView::mouseDoubleClickEvent(e);
 }
 
 void DUListView::keyPressEvent(QKeyEvent *e)
@@ -249,7 +288,7 @@ void DUListView::keyPressEvent(QKeyEvent *e)
     switch (e->key()) {
     case Qt::Key_Return:
     case Qt::Key_Enter:
-        if (doubleClicked(currentItem()))
+        if (doubleClicked(currentIndex()))
             return;
         break;
     case Qt::Key_Left:
@@ -265,17 +304,5 @@ void DUListView::keyPressEvent(QKeyEvent *e)
         e->ignore();
         return;
     }
-    KrTreeWidget::keyPressEvent(e);
-}
-
-void DUListView::slotExpanded(QTreeWidgetItem *item)
-{
-    if (item == nullptr || item->text(0) == "..")
-        return;
-
-    if (item->childCount() == 0) {
-        File *fileItem = (dynamic_cast<DUListViewItem *>(item))->getFile();
-        if (fileItem->isDir())
-            addDirectory(dynamic_cast<Directory *>(fileItem), item);
-    }
+    KrTreeView::keyPressEvent(e);
 }
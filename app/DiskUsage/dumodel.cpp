@@ -0,0 +1,406 @@
+/*
+    SPDX-FileCopyrightText: 2026 Krusader Krew <https://krusader.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "dumodel.h"
+
+#include <algorithm>
+#include <iterator>
+
+#include "filelightParts/fileTree.h"
+
+// the number of rows handed to the view at once
+static const int FETCH_SIZE = 512;
+
+DUModel::DUModel(DiskUsage *usage, bool expandable, QObject *parent)
+    : QAbstractItemModel(parent)
+    , diskUsage(usage)
+    , expandable(expandable)
+    , currentDir(nullptr)
+    , sortColumn(0)
+    , sortOrder(Qt::AscendingOrder)
+{
+    // the changes come in bursts, the folders are sorted again once afterwards
+    resortTimer.setSingleShot(true);
+    resortTimer.setInterval(0);
+    connect(&resortTimer, &QTimer::timeout, this, &DUModel::resortChanged);
+}
+
+DUModel::~DUModel()
+{
+    qDeleteAll(nodes);
+}
+
+void DUModel::setDirectory(Directory *dir)
+{
+    // while scanning, the shown folder is entered again when it got new content: keep the
+    // fetched rows, the selection and the scroll position
+    if (dir != nullptr && dir == currentDir)
+        resortAll(true);
+    else
+        resetNodes(dir);
+}
+
+void DUModel::resetNodes(Directory *dir)
+{
+    beginResetModel();
+    clearNodes();
+    currentDir = dir;
+    if (dir)
+        createNode(dir);
+    endResetModel();
+}
+
+void DUModel::clear()
+{
+    setDirectory(nullptr);
+}
+
+File *DUModel::file(const QModelIndex &index) const
+{
+    return index.isValid() ? static_cast<File *>(index.internalPointer()) : nullptr;
+}
+
+int DUModel::maxPercent() const
+{
+    const Node *node = nodes.value(currentDir);
+    return node ? node->maxPercent : -1;
+}
+
+QModelIndex DUModel::index(int row, int column, const QModelIndex &parent) const
+{
+    if (row < 0 || column < 0 || column >= columnCount(parent) || currentDir == nullptr)
+        return QModelIndex();
+
+    const Node *node;
+    if (!parent.isValid()) {
+        if (row < upRows())
+            return createIndex(row, column, nullptr);
+        node = nodes.value(currentDir);
+        row -= upRows();
+    } else {
+        node = nodes.value(dynamic_cast<const Directory *>(file(parent)));
+    }
+
+    if (node == nullptr || row >= node->rows.count())
+        return QModelIndex();
+    return createIndex(row + (parent.isValid() ? 0 : upRows()), column, node->rows.at(row));
+}
+
+QModelIndex DUModel::parent(const QModelIndex &index) const
+{
+    const File *item = file(index);
+    if (item == nullptr || item->parent() == currentDir)
+        return QModelIndex();
+    return indexOf(item->parent());
+}
+
+int DUModel::rowCount(const QModelIndex &parent) const
+{
+    if (currentDir == nullptr || parent.column() > 0)
+        return 0;
+
+    if (!parent.isValid()) {
+        const Node *node = nodes.value(currentDir);
+        return upRows() + (node ? node->rows.count() : 0);
+    }
+
+    const Node *node = nodes.value(dynamic_cast<const Directory *>(file(parent)));
+    return node ? node->rows.count() : 0;
+}
+
+bool DUModel::hasChildren(const QModelIndex &parent) const
+{
+    if (!parent.isValid())
+        return currentDir != nullptr;
+    if (!expandable || parent.column() > 0)
+        return false;
+
+    const File *item = file(parent);
+    if (item == nullptr || !item->isDir() || item->isSymLink())
+        return false;
+    return !dynamic_cast<const Directory *>(item)->isEmpty();
+}
+
+bool DUModel::canFetchMore(const QModelIndex &parent) const
+{
+    if (currentDir == nullptr || (parent.isValid() && !hasChildren(parent)))
+        return false;
+
+    const Node *node = nodes.value(parent.isValid() ? dynamic_cast<const Directory *>(file(parent)) : currentDir);
+    return node == nullptr || !node->pending.isEmpty();
+}
+
+void DUModel::fetchMore(const QModelIndex &parent)
+{
+    if (!canFetchMore(parent))
+        return;
+
+    const Directory *dir = parent.isValid() ? dynamic_cast<const Directory *>(file(parent)) : currentDir;
+    Node *node = nodes.value(dir);
+    if (node == nullptr)
+        node = createNode(dir);
+
+    QVector<File *> fetched;
+    while (fetched.count() < FETCH_SIZE && !node->pending.isEmpty()) {
+        File *item = node->pending.takeLast();
+        if (!node->removed.contains(item))
+            fetched.append(item);
+    }
+    if (fetched.isEmpty())
+        return;
+
+    const int first = node->rows.count() + (parent.isValid() ? 0 : upRows());
+    beginInsertRows(parent, first, first + fetched.count() - 1);
+    for (File *item : qAsConst(fetched)) {
+        rowIndex.insert(item, node->rows.count());
+        node->rows.append(item);
+    }
+    endInsertRows();
+}
+
+Qt::ItemFlags DUModel::flags(const QModelIndex &index) const
+{
+    if (!index.isValid())
+        return Qt::NoItemFlags;
+    if (isUpItem(index))
+        return Qt::ItemIsEnabled;
+    return Qt::ItemIsEnabled | Qt::ItemIsSelectable;
+}
+
+void DUModel::sort(int column, Qt::SortOrder order)
+{
+    sortColumn = column;
+    sortOrder = order;
+    resortAll(false);
+}
+
+void DUModel::resortAll(bool updateRows)
+{
+    const QList<const Directory *> dirs = nodes.keys();
+    for (const Directory *dir : dirs) {
+        Node *node = nodes.value(dir); // may be gone with its parent meanwhile
+        if (node == nullptr)
+            continue;
+        resortNode(dir, node);
+
+        node = nodes.value(dir);
+        if (updateRows && node && !node->rows.isEmpty()) {
+            const QModelIndex parent = indexOf(dir);
+            const int first = dir == currentDir ? upRows() : 0;
+            emit dataChanged(index(first, 0, parent), index(first + node->rows.count() - 1, columnCount(parent) - 1, parent));
+        }
+    }
+}
+
+void DUModel::slotChanged(File *item)
+{
+    const Directory *dir = item->parent();
+    Node *node = dir ? nodes.value(dir) : nullptr;
+    if (node == nullptr)
+        return;
+
+    const int row = rowIndex.value(item, -1);
+    if (row >= 0) {
+        if (item->isExcluded()) {
+            removeRow(dir, node, row);
+            return;
+        }
+        const int viewRow = rowOf(item);
+        emit dataChanged(createIndex(viewRow, 0, item), createIndex(viewRow, columnCount() - 1, item));
+    }
+
+    // the item may have moved, came back from the exclusion or went to it before it was fetched
+    changedNodes.insert(dir);
+    resortTimer.start();
+}
+
+void DUModel::slotDeleted(File *item)
+{
+    if (item == currentDir) {
+        clear();
+        return;
+    }
+
+    const Directory *dir = item->parent();
+    Node *node = dir ? nodes.value(dir) : nullptr;
+    if (node == nullptr)
+        return;
+
+    const int row = rowIndex.value(item, -1);
+    if (row >= 0)
+        removeRow(dir, node, row);
+    else
+        node->removed.insert(item); // still in pending, skipped there
+}
+
+void DUModel::columnChanged(int column)
+{
+    const int count = rowCount();
+    if (count > 0)
+        emit dataChanged(index(0, column), index(count - 1, column));
+}
+
+void DUModel::resortChanged()
+{
+    QSet<const Directory *> dirs;
+    dirs.swap(changedNodes);
+
+    for (const Directory *dir : qAsConst(dirs)) {
+        Node *node = nodes.value(dir); // may be gone with its parent meanwhile
+        if (node)
+            resortNode(dir, node);
+    }
+}
+
+QVector<File *> DUModel::sortedItems(const Directory *dir, const Node *node) const
+{
+    QVector<File *> items;
+    items.reserve(dir->count());
+    for (File *item : *dir) {
+        if (!item->isExcluded() && !(node && node->removed.contains(item)))
+            items.append(item);
+    }
+
+    // stable, so that the equal items don't swap places on every change
+    std::stable_sort(items.begin(), items.end(), [this](const File *file1, const File *file2) {
+        return sortOrder == Qt::AscendingOrder ? lessThan(file1, file2, sortColumn) : lessThan(file2, file1, sortColumn);
+    });
+    return items;
+}
+
+static int maxPercentOf(const QVector<File *> &items)
+{
+    int maxPercent = -1;
+    for (const File *item : items)
+        maxPercent = qMax(maxPercent, item->intPercent());
+    return maxPercent;
+}
+
+DUModel::Node *DUModel::createNode(const Directory *dir)
+{
+    auto *node = new Node;
+    const QVector<File *> items = sortedItems(dir, nullptr);
+    node->maxPercent = maxPercentOf(items);
+    node->pending.reserve(items.count());
+    std::reverse_copy(items.constBegin(), items.constEnd(), std::back_inserter(node->pending));
+    nodes.insert(dir, node);
+    return node;
+}
+
+void DUModel::removeNode(const Directory *dir)
+{
+    Node *node = nodes.take(dir);
+    if (node == nullptr)
+        return;
+
+    for (const File *item : qAsConst(node->rows)) {
+        rowIndex.remove(item);
+        if (item->isDir())
+            removeNode(dynamic_cast<const Directory *>(item));
+    }
+    changedNodes.remove(dir);
+    delete node;
+}
+
+void DUModel::clearNodes()
+{
+    qDeleteAll(nodes);
+    nodes.clear();
+    rowIndex.clear();
+    changedNodes.clear();
+    resortTimer.stop();
+}
+
+void DUModel::resortNode(const Directory *dir, Node *node)
+{
+    const QVector<File *> items = sortedItems(dir, node);
+    const int shown = node->rows.count();
+    if (items.count() < shown) {
+        // a shown item disappeared without deleted(), start again
+        resetNodes(currentDir);
+        return;
+    }
+
+    const int maxPercent = maxPercentOf(items);
+    const bool maxPercentChanged = maxPercent != node->maxPercent;
+    node->maxPercent = maxPercent;
+
+    node->pending.clear();
+    std::reverse_copy(items.constBegin() + shown, items.constEnd(), std::back_inserter(node->pending));
+
+    const QVector<File *> newRows = items.mid(0, shown);
+    if (newRows != node->rows) {
+        QList<QPersistentModelIndex> parents;
+        if (dir != currentDir)
+            parents.append(indexOf(dir));
+        emit layoutAboutToBeChanged(parents, QAbstractItemModel::VerticalSortHint);
+
+        for (const File *item : qAsConst(node->rows))
+            rowIndex.remove(item);
+        for (int i = 0; i < shown; ++i)
+            rowIndex.insert(newRows.at(i), i);
+        // the folders moved behind the fetched rows lose their fetched content
+        for (const File *item : qAsConst(node->rows)) {
+            if (item->isDir() && !rowIndex.contains(item))
+                removeNode(dynamic_cast<const Directory *>(item));
+        }
+        node->rows = newRows;
+
+        const QModelIndexList oldIndexes = persistentIndexList();
+        QModelIndexList newIndexes;
+        newIndexes.reserve(oldIndexes.count());
+        for (const QModelIndex &index : oldIndexes) {
+            File *item = file(index);
+            if (item == nullptr)
+                newIndexes.append(index);
+            else if (rowIndex.contains(item))
+                newIndexes.append(createIndex(rowOf(item), index.column(), item));
+            else
+                newIndexes.append(QModelIndex());
+        }
+        changePersistentIndexList(oldIndexes, newIndexes);
+
+        emit layoutChanged(parents, QAbstractItemModel::VerticalSortHint);
+    }
+
+    if (maxPercentChanged && shown > 0) {
+        const QModelIndex parent = indexOf(dir);
+        const int first = dir == currentDir ? upRows() : 0;
+        emit dataChanged(index(first, 0, parent), index(first + shown - 1, columnCount(parent) - 1, parent));
+    }
+}
+
+void DUModel::removeRow(const Directory *dir, Node *node, int row)
+{
+    File *item = node->rows.at(row);
+    const int viewRow = row + (dir == currentDir ? upRows() : 0);
+
+    beginRemoveRows(indexOf(dir), viewRow, viewRow);
+    node->rows.remove(row);
+    rowIndex.remove(item);
+    for (int i = row; i < node->rows.count(); ++i)
+        rowIndex[node->rows.at(i)] = i;
+    if (item->isDir())
+        removeNode(dynamic_cast<const Directory *>(item));
+    endRemoveRows();
+}
+
+int DUModel::rowOf(const File *file) const
+{
+    return rowIndex.value(file) + (file->parent() == currentDir ? upRows() : 0);
+}
+
+QModelIndex DUModel::indexOf(const Directory *dir) const
+{
+    if (dir == currentDir)
+        return QModelIndex();
+    return createIndex(rowOf(dir), 0, const_cast<Directory *>(dir));
+}
+
+int DUModel::upRows() const
+{
+    return currentDir && currentDir->parent() ? 1 : 0;
+}
@@ -0,0 +1,115 @@
+/*
+    SPDX-FileCopyrightText: 2026 Krusader Krew <https://krusader.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef DUMODEL_H
+#define DUMODEL_H
+
+// QtCore
+#include <QAbstractItemModel>
+#include <QHash>
+#include <QSet>
+#include <QTimer>
+#include <QVector>
+
+class DiskUsage;
+class Directory;
+class File;
+
+/**
+ * The item model of the disk usage views over the content of the current folder.
+ *
+ * Nothing is created per item: the rows refer to the File objects of the tree and the texts
+ * are formatted by data() of the subclasses when a row is shown. The content of a folder is
+ * sorted when the folder is shown or expanded and handed to the view in portions with
+ * fetchMore(), so opening a folder with many items doesn't depend on their number.
+ *
+ * Excluded items are not shown. The top level starts with a ".." row if the folder has a
+ * parent; its index has no File.
+ */
+class DUModel : public QAbstractItemModel
+{
+    Q_OBJECT
+
+public:
+    DUModel(DiskUsage *usage, bool expandable, QObject *parent = nullptr);
+    ~DUModel() override;
+
+    /// Show the content of @p dir. If it's shown already, its changed content is sorted in.
+    void setDirectory(Directory *dir);
+    Directory *directory() const
+    {
+        return currentDir;
+    }
+
+    /// The item of the index, nullptr for the ".." row
+    File *file(const QModelIndex &index) const;
+    bool isUpItem(const QModelIndex &index) const
+    {
+        return index.isValid() && index.internalPointer() == nullptr;
+    }
+    /// The largest percent of the shown items on the top level
+    int maxPercent() const;
+
+    QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const override;
+    QModelIndex parent(const QModelIndex &index) const override;
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    bool hasChildren(const QModelIndex &parent = QModelIndex()) const override;
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+    Qt::ItemFlags flags(const QModelIndex &index) const override;
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
+
+public slots:
+    void clear();
+    void slotChanged(File *);
+    void slotDeleted(File *);
+
+protected:
+    /// Return true if @p file1 is before @p file2 in ascending order of @p column
+    virtual bool lessThan(const File *file1, const File *file2, int column) const = 0;
+    /// Emit dataChanged() for a column of all shown rows
+    void columnChanged(int column);
+
+    DiskUsage *diskUsage;
+
+private slots:
+    void resortChanged();
+
+private:
+    struct Node {
+        QVector<File *> rows; //< the items handed to the view
+        QVector<File *> pending; //< the items not fetched yet, in reverse order
+        QSet<const File *> removed; //< deleted items which may still be in the folder or in pending
+        int maxPercent;
+    };
+
+    /// Collect and sort the shown items of a folder. The rows are not touched.
+    QVector<File *> sortedItems(const Directory *dir, const Node *node) const;
+    Node *createNode(const Directory *dir);
+    void resetNodes(Directory *dir);
+    /// Sort all fetched folders again, optionally updating all shown rows
+    void resortAll(bool updateRows);
+    void removeNode(const Directory *dir);
+    void clearNodes();
+    /// Sort the content of a folder again and move the rows with a layout change
+    void resortNode(const Directory *dir, Node *node);
+    void removeRow(const Directory *dir, Node *node, int row);
+    /// The row of a shown item, including the ".." row
+    int rowOf(const File *file) const;
+    QModelIndex indexOf(const Directory *dir) const;
+    int upRows() const;
+
+    const bool expandable;
+    Directory *currentDir;
+    QHash<const Directory *, Node *> nodes; //< the folders whose content was fetched
+    QHash<const File *, int> rowIndex; //< the index of the shown items in Node::rows
+    QSet<const Directory *> changedNodes; //< the folders to sort again
+    QTimer resortTimer;
+    int sortColumn;
+    Qt::SortOrder sortOrder;
+};
+
+#endif // DUMODEL_H
@@ -0,0 +1,171 @@
+/*
+    SPDX-FileCopyrightText: 2026 Krusader Krew <https://krusader.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "duscanner.h"
+
+// QtCore
+#include <QFile>
+#include <QMutexLocker>
+#include <QThread>
+#include <QtConcurrent/QtConcurrentRun> // krazy:exclude=includes
+
+#include <sys/stat.h>
+
+#include "../FileSystem/krpermhandler.h"
+#include "../FileSystem/locallister.h"
+#include "filelightParts/fileTree.h"
+
+DUScanner::DUScanner(QObject *parent)
+    : QObject(parent)
+    , m_device(0)
+    , m_run(this, [this]() {
+        emit finished();
+    })
+{
+    // reading file status mostly waits for the disk or the network, more threads than cores help
+    m_pool.setMaxThreadCount(qMax(4, QThread::idealThreadCount() * 2));
+}
+
+DUScanner::~DUScanner()
+{
+    cancel();
+}
+
+void DUScanner::start(const QString &basePath, Directory *root)
+{
+    cancel();
+
+    const int generation = m_run.start();
+    {
+        QMutexLocker locker(&m_mutex);
+        m_links.clear();
+        m_currentPath = basePath;
+    }
+
+    struct stat baseStat;
+    m_device = stat(QFile::encodeName(basePath).constData(), &baseStat) == 0 ? baseStat.st_dev : 0;
+
+#ifdef BSD
+    const bool procfs = basePath.startsWith(QLatin1String("/procfs"));
+#else
+    const bool procfs = basePath.startsWith(QLatin1String("/proc"));
+#endif
+    if (procfs) // nothing to count there, report an empty folder
+        m_run.finish(generation);
+    else
+        queueDirectory(basePath, QString(), root, generation);
+}
+
+void DUScanner::cancel()
+{
+    if (!m_run.cancel())
+        return;
+
+    m_pool.waitForDone();
+    deleteBatches();
+}
+
+QList<DUScanner::Batch> DUScanner::takeBatches()
+{
+    QMutexLocker locker(&m_mutex);
+    QList<Batch> batches;
+    batches.swap(m_batches);
+    return batches;
+}
+
+QString DUScanner::currentPath()
+{
+    QMutexLocker locker(&m_mutex);
+    return m_currentPath;
+}
+
+void DUScanner::queueDirectory(const QString &path, const QString &relativePath, Directory *directory, int generation)
+{
+    m_run.addTask();
+    QtConcurrent::run(&m_pool, [=]() {
+        if (!m_run.isInterrupted())
+            scanDirectory(path, relativePath, directory, generation);
+        m_run.taskDone(generation);
+    });
+}
+
+void DUScanner::scanDirectory(const QString &path, const QString &relativePath, Directory *directory, int generation)
+{
+    Batch batch{directory, relativePath, QList<File *>()};
+    QList<QPair<QString, Directory *>> subDirectories;
+
+    {
+        QMutexLocker locker(&m_mutex);
+        m_currentPath = path;
+    }
+
+    LocalLister lister(path);
+    if (lister.open()) {
+        QByteArray encodedName;
+        unsigned char type;
+        struct stat fileStat;
+        while (lister.next(encodedName, type) && !m_run.isInterrupted()) {
+            if (!lister.entryStatus(encodedName, fileStat))
+                continue;
+
+            const QString name = QFile::decodeName(encodedName);
+            const QString owner = KrPermHandler::uid2user(fileStat.st_uid);
+            const QString group = KrPermHandler::gid2group(fileStat.st_gid);
+
+            if (S_ISDIR(fileStat.st_mode)) {
+                // the size is summed up from the content
+                auto *subDirectory = new Directory(directory, name, 0, fileStat.st_mode, owner, group, fileStat.st_mtime, false, QString());
+                batch.items.append(subDirectory);
+                // don't cross mount points
+                if (fileStat.st_dev == m_device)
+                    subDirectories.append(qMakePair(name, subDirectory));
+            } else {
+                KIO::filesize_t size = fileStat.st_size;
+                if (S_ISREG(fileStat.st_mode) && fileStat.st_nlink > 1 && !isFirstLink(fileStat.st_dev, fileStat.st_ino))
+                    size = 0; // the data is counted with the first link already
+                batch.items.append(new File(directory,
+                                            name,
+                                            size,
+                                            fileStat.st_mode,
+                                            owner,
+                                            group,
+                                            fileStat.st_mtime,
+                                            S_ISLNK(fileStat.st_mode),
+                                            QString()));
+            }
+        }
+    }
+
+    // the batch goes first: the receiver has to append the folders before their content
+    {
+        QMutexLocker locker(&m_mutex);
+        m_batches.append(batch);
+    }
+
+    const QString pathPrefix = path.endsWith('/') ? path : path + '/';
+    const QString childPrefix = relativePath.isEmpty() ? QString() : relativePath + '/';
+    for (const auto &subDirectory : qAsConst(subDirectories))
+        queueDirectory(pathPrefix + subDirectory.first, childPrefix + subDirectory.first, subDirectory.second, generation);
+}
+
+bool DUScanner::isFirstLink(dev_t device, ino_t inode)
+{
+    QMutexLocker locker(&m_mutex);
+    const QPair<quint64, quint64> key(device, inode);
+    if (m_links.contains(key))
+        return false;
+    m_links.insert(key);
+    return true;
+}
+
+void DUScanner::deleteBatches()
+{
+    // the folders in these batches were never appended, so each item is deleted exactly once here
+    QMutexLocker locker(&m_mutex);
+    for (const Batch &batch : qAsConst(m_batches))
+        qDeleteAll(batch.items);
+    m_batches.clear();
+}
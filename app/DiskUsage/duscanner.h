@@ -0,0 +1,88 @@
+/*
+    SPDX-FileCopyrightText: 2026 Krusader Krew <https://krusader.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef DUSCANNER_H
+#define DUSCANNER_H
+
+// QtCore
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <QPair>
+#include <QSet>
+#include <QString>
+#include <QThreadPool>
+
+#include <sys/types.h>
+
+#include "../workerrun.h"
+
+class Directory;
+class File;
+
+/**
+ * Scans a local folder tree in a thread pool, one folder per task.
+ *
+ * The entries are read with fstatat() relative to the opened folder. A file with several hard
+ * links is counted only once, the other links get the size 0. Folders on other filesystems
+ * (mount points) are listed but not entered. The mime type of the items is not resolved here,
+ * File::mime() looks it up when the item is shown.
+ *
+ * Each listed folder is handed over as a batch of new items. The items are not appended to the
+ * folder by the worker threads, this is done by the receiver in the GUI thread with
+ * takeBatches(), so the views can show the tree while the scan goes on.
+ */
+class DUScanner : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Batch {
+        Directory *directory; //< the folder the items belong to
+        QString path; //< the folder path relative to the base folder
+        QList<File *> items; //< the new items, not yet appended to the folder
+    };
+
+    explicit DUScanner(QObject *parent = nullptr);
+    ~DUScanner() override;
+
+    /// Start scanning the local folder @p basePath into @p root
+    void start(const QString &basePath, Directory *root);
+    /// Stop the scan and wait for the worker threads. The batches not taken yet are deleted.
+    void cancel();
+    bool isRunning() const
+    {
+        return m_run.isRunning();
+    }
+
+    /// Take the folders listed since the last call, in the order they were listed. Thread-safe.
+    QList<Batch> takeBatches();
+    /// The absolute path of the folder listed last. Thread-safe.
+    QString currentPath();
+
+signals:
+    /// Emitted when all folders are listed. Not emitted after cancel().
+    void finished();
+
+private:
+    /// List a folder, called in a worker thread
+    void scanDirectory(const QString &path, const QString &relativePath, Directory *directory, int generation);
+    void queueDirectory(const QString &path, const QString &relativePath, Directory *directory, int generation);
+    /// Return true if this is the first link found to the file
+    bool isFirstLink(dev_t device, ino_t inode);
+    void deleteBatches();
+
+    QThreadPool m_pool;
+    dev_t m_device; //< the filesystem of the base folder
+    WorkerRun m_run; //< a task per folder
+
+    QMutex m_mutex; //< protects all following members
+    QList<Batch> m_batches;
+    QSet<QPair<quint64, quint64>> m_links; //< the device and inode of files with several links
+    QString m_currentPath;
+};
+
+#endif // DUSCANNER_H
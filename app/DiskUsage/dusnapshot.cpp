@@ -0,0 +1,288 @@
+/*
+    SPDX-FileCopyrightText: 2026 Krusader Krew <https://krusader.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "dusnapshot.h"
+
+// QtCore
+#include <QDataStream>
+#include <QFile>
+#include <QSaveFile>
+#include <QVector>
+
+#include <KLocalizedString>
+
+static const quint32 SNAPSHOT_MAGIC = 0x4b524455; // "KRDU"
+static const quint32 SNAPSHOT_VERSION = 1;
+
+// node flags
+static const quint8 NODE_DIRECTORY = 0x01;
+static const quint8 NODE_SYMLINK = 0x02;
+static const quint8 NODE_EXCLUDED = 0x04;
+
+/// Writes each distinct string once, later occurrences only by index
+class SnapshotStringWriter
+{
+public:
+    explicit SnapshotStringWriter(QDataStream &stream)
+        : m_stream(stream)
+    {
+    }
+
+    void write(const QString &string)
+    {
+        const auto it = m_indexes.constFind(string);
+        if (it != m_indexes.constEnd()) {
+            m_stream << *it;
+            return;
+        }
+        const auto index = static_cast<quint32>(m_indexes.count());
+        m_indexes.insert(string, index);
+        m_stream << index << string;
+    }
+
+private:
+    QDataStream &m_stream;
+    QHash<QString, quint32> m_indexes;
+};
+
+class SnapshotStringReader
+{
+public:
+    explicit SnapshotStringReader(QDataStream &stream)
+        : m_stream(stream)
+    {
+    }
+
+    QString read()
+    {
+        quint32 index;
+        m_stream >> index;
+        if (index < static_cast<quint32>(m_strings.count()))
+            return m_strings.at(static_cast<int>(index));
+        if (index != static_cast<quint32>(m_strings.count())) {
+            m_stream.setStatus(QDataStream::ReadCorruptData);
+            return QString();
+        }
+        QString string;
+        m_stream >> string;
+        m_strings.append(string);
+        return string;
+    }
+
+private:
+    QDataStream &m_stream;
+    QVector<QString> m_strings;
+};
+
+/// The fields of a node as stored in the file
+struct SnapshotNode {
+    quint8 flags;
+    QString name;
+    quint64 ownSize;
+    quint32 mode;
+    qint64 time;
+    QString owner;
+    QString group;
+    quint32 childCount;
+};
+
+void DUSnapshot::writeNode(QDataStream &stream, SnapshotStringWriter &strings, const File *file)
+{
+    const bool isDir = file->isDir();
+    quint8 flags = 0;
+    if (isDir)
+        flags |= NODE_DIRECTORY;
+    if (file->isSymLink())
+        flags |= NODE_SYMLINK;
+    if (file->isExcluded())
+        flags |= NODE_EXCLUDED;
+
+    // the own size of a file is its size, the folder sizes are summed up after loading
+    const quint64 ownSize = isDir ? 0 : file->m_ownSize;
+
+    stream << flags << file->name() << ownSize << static_cast<quint32>(file->mode()) << static_cast<qint64>(file->time());
+    strings.write(file->owner());
+    strings.write(file->group());
+
+    if (isDir) {
+        const auto *dir = dynamic_cast<const Directory *>(file);
+        stream << static_cast<quint32>(dir->count());
+        for (const File *child : *dir)
+            writeNode(stream, strings, child);
+    }
+}
+
+static bool readNode(QDataStream &stream, SnapshotStringReader &strings, SnapshotNode &node)
+{
+    stream >> node.flags >> node.name >> node.ownSize >> node.mode >> node.time;
+    node.owner = strings.read();
+    node.group = strings.read();
+    node.childCount = 0;
+    if (node.flags & NODE_DIRECTORY)
+        stream >> node.childCount;
+    return stream.status() == QDataStream::Ok;
+}
+
+static bool readHeader(QDataStream &stream, QUrl &baseUrl)
+{
+    quint32 magic, version;
+    QString url;
+    stream >> magic >> version >> url;
+    if (stream.status() != QDataStream::Ok || magic != SNAPSHOT_MAGIC || version != SNAPSHOT_VERSION)
+        return false;
+    baseUrl = QUrl(url);
+    return true;
+}
+
+QString DUSnapshot::fileFilter()
+{
+    return i18n("Disk usage snapshots (*.krdu)");
+}
+
+bool DUSnapshot::save(const QString &fileName, const QUrl &baseUrl, const Directory *root)
+{
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+
+    QDataStream stream(&file);
+    stream << SNAPSHOT_MAGIC << SNAPSHOT_VERSION << baseUrl.toString();
+
+    SnapshotStringWriter strings(stream);
+    writeNode(stream, strings, root);
+
+    return stream.status() == QDataStream::Ok && file.commit();
+}
+
+/// Read the content of @p dir; returns false on error
+static bool loadChildren(QDataStream &stream, SnapshotStringReader &strings, Directory *dir, quint32 count)
+{
+    SnapshotNode node;
+    for (quint32 i = 0; i < count; ++i) {
+        if (!readNode(stream, strings, node))
+            return false;
+
+        File *item;
+        if (node.flags & NODE_DIRECTORY) {
+            item = new Directory(dir, node.name, 0, node.mode, node.owner, node.group, node.time, node.flags & NODE_SYMLINK, QString());
+        } else {
+            item = new File(dir, node.name, node.ownSize, node.mode, node.owner, node.group, node.time, node.flags & NODE_SYMLINK, QString());
+        }
+        item->exclude(node.flags & NODE_EXCLUDED);
+        dir->append(item);
+
+        if ((node.flags & NODE_DIRECTORY) && !loadChildren(stream, strings, dynamic_cast<Directory *>(item), node.childCount))
+            return false;
+    }
+    return true;
+}
+
+Directory *DUSnapshot::load(const QString &fileName, QUrl &baseUrl)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return nullptr;
+
+    QDataStream stream(&file);
+    if (!readHeader(stream, baseUrl))
+        return nullptr;
+
+    SnapshotStringReader strings(stream);
+    SnapshotNode node;
+    if (!readNode(stream, strings, node) || !(node.flags & NODE_DIRECTORY))
+        return nullptr;
+
+    auto *root = new Directory(baseUrl.fileName(), baseUrl.toDisplayString(QUrl::PreferLocalFile));
+    if (!loadChildren(stream, strings, root, node.childCount)) {
+        delete root;
+        return nullptr;
+    }
+    return root;
+}
+
+/**
+ * Read the content of a saved folder and match it with @p current (nullptr if the folder is gone).
+ * Returns the old total size of the folder in @p oldSize.
+ */
+static bool compareChildren(QDataStream &stream,
+                            SnapshotStringReader &strings,
+                            const Directory *current,
+                            quint32 count,
+                            FileSize &oldSize,
+                            QHash<const File *, FileSize> &previousSizes,
+                            QSet<const File *> &newItems)
+{
+    QHash<QString, const File *> currentItems; // the items not matched yet
+    if (current) {
+        currentItems.reserve(current->count());
+        for (const File *item : *current)
+            currentItems.insert(item->name(), item);
+    }
+
+    oldSize = 0;
+    SnapshotNode node;
+    for (quint32 i = 0; i < count; ++i) {
+        if (!readNode(stream, strings, node))
+            return false;
+
+        const bool isDir = node.flags & NODE_DIRECTORY;
+        const File *item = currentItems.take(node.name);
+        if (item && item->isDir() != isDir) {
+            newItems.insert(item); // replaced by another kind of item
+            item = nullptr;
+        }
+
+        FileSize size = node.ownSize;
+        if (isDir && !compareChildren(stream, strings, dynamic_cast<const Directory *>(item), node.childCount, size, previousSizes, newItems))
+            return false;
+        if (node.flags & NODE_EXCLUDED)
+            size = 0;
+
+        if (item && (isDir || size != item->size()))
+            previousSizes.insert(item, size);
+        oldSize += size;
+    }
+
+    for (const File *item : qAsConst(currentItems))
+        newItems.insert(item);
+    return true;
+}
+
+DUSnapshot::CompareResult DUSnapshot::compare(const QString &fileName,
+                                              const QUrl &baseUrl,
+                                              const Directory *root,
+                                              QUrl &snapshotUrl,
+                                              QHash<const File *, FileSize> &previousSizes,
+                                              QSet<const File *> &newItems)
+{
+    previousSizes.clear();
+    newItems.clear();
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return ReadError;
+
+    QDataStream stream(&file);
+    if (!readHeader(stream, snapshotUrl))
+        return ReadError;
+    // the items are matched by their path below the base folder only
+    if (snapshotUrl.adjusted(QUrl::StripTrailingSlash) != baseUrl.adjusted(QUrl::StripTrailingSlash))
+        return OtherFolder;
+
+    SnapshotStringReader strings(stream);
+    SnapshotNode node;
+    if (!readNode(stream, strings, node) || !(node.flags & NODE_DIRECTORY))
+        return ReadError;
+
+    FileSize oldSize;
+    if (!compareChildren(stream, strings, root, node.childCount, oldSize, previousSizes, newItems)) {
+        previousSizes.clear();
+        newItems.clear();
+        return ReadError;
+    }
+    previousSizes.insert(root, oldSize);
+    return Compared;
+}
@@ -0,0 +1,61 @@
+/*
+    SPDX-FileCopyrightText: 2026 Krusader Krew <https://krusader.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef DUSNAPSHOT_H
+#define DUSNAPSHOT_H
+
+// QtCore
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include <QUrl>
+
+#include "filelightParts/fileTree.h"
+
+class QDataStream;
+class SnapshotStringWriter;
+
+/**
+ * Saves a disk usage tree to a file and reads it back, or compares it with the current tree.
+ *
+ * The file is a stream of the nodes in depth-first order: every node is written once with its
+ * own size, the folder sizes are summed up again after loading. Owner and group names are
+ * written once and referred to by their index afterwards. The file is read sequentially while
+ * the tree is built, so there's never a second copy of the tree in memory.
+ */
+class DUSnapshot
+{
+public:
+    /// The file dialog filter for snapshot files
+    static QString fileFilter();
+
+    /// Write the tree below @p root, scanned from @p baseUrl. Returns false on error.
+    static bool save(const QString &fileName, const QUrl &baseUrl, const Directory *root);
+    /// Read a tree, the folder sizes are not calculated yet. Returns nullptr on error.
+    static Directory *load(const QString &fileName, QUrl &baseUrl);
+
+    enum CompareResult { Compared, ReadError, OtherFolder };
+
+    /**
+     * Compare a saved tree with @p root, scanned from @p baseUrl, matching the items by path.
+     *
+     * @param snapshotUrl receives the folder the snapshot was taken of
+     * @param previousSizes receives the old size of the folders and of the files with another size
+     * @param newItems receives the items which are not in the saved tree (not their content)
+     * @return OtherFolder if the snapshot was not taken of @p baseUrl, nothing is compared then
+     */
+    static CompareResult compare(const QString &fileName,
+                                 const QUrl &baseUrl,
+                                 const Directory *root,
+                                 QUrl &snapshotUrl,
+                                 QHash<const File *, FileSize> &previousSizes,
+                                 QSet<const File *> &newItems);
+
+private:
+    static void writeNode(QDataStream &stream, SnapshotStringWriter &strings, const File *file);
+};
+
+#endif // DUSNAPSHOT_H
@@ -8,13 +8,64 @@
 #include "fileTree.h"
 
 // QtCore
+#include <QHash>
 #include <QLocale>
+#include <QMimeDatabase>
+#include <QMimeType>
+#include <QMutex>
+#include <QMutexLocker>
 #include <QString>
+#include <QVector>
+
+#include "../../FileSystem/krpermhandler.h"
 
 // static definitions
 const FileSize File::DENOMINATOR[4] = {1ull, 1ull << 10, 1ull << 20, 1ull << 30};
 const char File::PREFIX[5][2] = {"", "K", "M", "G", "T"};
 
+static QMutex stringTableMutex;
+static QHash<QString, quint32> stringTableIndexes;
+static QVector<QString> stringTableStrings(1); // index 0 is the empty string
+
+quint32 StringTable::index(const QString &string)
+{
+    if (string.isEmpty())
+        return 0;
+
+    QMutexLocker locker(&stringTableMutex);
+    const auto it = stringTableIndexes.constFind(string);
+    if (it != stringTableIndexes.constEnd())
+        return *it;
+
+    const auto index = static_cast<quint32>(stringTableStrings.count());
+    stringTableStrings.append(string);
+    stringTableIndexes.insert(string, index);
+    return index;
+}
+
+QString StringTable::string(quint32 index)
+{
+    QMutexLocker locker(&stringTableMutex);
+    return stringTableStrings.value(static_cast<int>(index));
+}
+
+QString File::directory() const
+{
+    if (m_parent == nullptr)
+        return isDir() ? static_cast<const Directory *>(this)->m_url : QString();
+
+    // rebuilt from the parent links, the path isn't stored in every file
+    QString path;
+    for (const Directory *d = m_parent; d->parent() != nullptr; d = d->parent())
+        path = path.isEmpty() ? d->name() : d->name() + '/' + path;
+    return path;
+}
+
+QString File::perm() const
+{
+    return KrPermHandler::mode2QString(m_mode);
+}
+
 QString File::fullPath(const Directory *root /*= 0*/) const
 {
     QString path;
@@ -43,6 +94,21 @@ QString File::fullPath(const Directory *root /*= 0*/) const
         return path;
 }
 
+QString File::mime() const
+{
+    if (m_mimeType == 0) {
+        // the name is enough here, reading the content of every listed file would be far too slow
+        if (isDir()) {
+            m_mimeType = StringTable::index(QStringLiteral("inode/directory"));
+        } else {
+            const QMimeDatabase db;
+            const QMimeType mt = db.mimeTypeForFile(fullPath(), QMimeDatabase::MatchExtension);
+            m_mimeType = StringTable::index(mt.isValid() ? mt.name() : QStringLiteral("unknown"));
+        }
+    }
+    return StringTable::string(m_mimeType);
+}
+
 QString File::humanReadableSize(UnitPrefix key /*= mega*/) const // FIXME inline
 {
     return humanReadableSize(m_size, key);
@@ -9,6 +9,7 @@
 #define FILETREE_H
 
 #include <QString>
+#include <QVector>
 
 #include <KIO/Global>
 
@@ -16,8 +17,10 @@
 #include <sys/types.h>
 #include <time.h>
 #include <unistd.h>
+#include <utility>
 
 // TODO these are pointlessly general purpose now, make them incredibly specific
+//      (only the radial map segments still use them)
 
 typedef KIO::filesize_t FileSize;
 
@@ -252,68 +255,71 @@ private:
 
 class Directory;
 
+/**
+ * The few distinct strings shared by many files (owner, group, mime type), stored once and
+ * referred to by a 32-bit index. Thread-safe, the strings are never removed.
+ */
+class StringTable
+{
+public:
+    static quint32 index(const QString &string);
+    static QString string(quint32 index);
+};
+
 class File
 {
 protected:
     Directory *m_parent; // 0 if this is treeRoot
     QString m_name; //< file name
-    QString m_directory; //< the directory of the file
     FileSize m_size; //< size with subdirectories
     FileSize m_ownSize; //< size without subdirectories
-    mode_t m_mode; //< file mode
-    QString m_owner; //< file owner name
-    QString m_group; //< file group name
-    QString m_perm; //< file permissions string
     time_t m_time; //< file modification in time_t format
+    mode_t m_mode; //< file mode
+    int m_percent; //< percent flag
+    quint32 m_owner; //< file owner name (string table index)
+    quint32 m_group; //< file group name (string table index)
+    mutable quint32 m_mimeType; //< file mimetype (string table index), looked up on first use if 0
     bool m_symLink; //< true if the file is a symlink
-    QString m_mimeType; //< file mimetype
     bool m_excluded; //< flag if the file is excluded from du
-    int m_percent; //< percent flag
 
 public:
     File(Directory *parentIn,
          const QString &nameIn,
-         const QString &dir,
          FileSize sizeIn,
          mode_t modeIn,
          const QString &ownerIn,
          const QString &groupIn,
-         const QString &permIn,
          time_t timeIn,
          bool symLinkIn,
          const QString &mimeTypeIn)
         : m_parent(parentIn)
         , m_name(nameIn)
-        , m_directory(dir)
         , m_size(sizeIn)
         , m_ownSize(sizeIn)
-        , m_mode(modeIn)
-        , m_owner(ownerIn)
-        , m_group(groupIn)
-        , m_perm(permIn)
         , m_time(timeIn)
+        , m_mode(modeIn)
+        , m_percent(-1)
+        , m_owner(StringTable::index(ownerIn))
+        , m_group(StringTable::index(groupIn))
+        , m_mimeType(StringTable::index(mimeTypeIn))
         , m_symLink(symLinkIn)
-        , m_mimeType(mimeTypeIn)
         , m_excluded(false)
-        , m_percent(-1)
     {
     }
 
     File(const QString &nameIn, FileSize sizeIn)
         : m_parent(nullptr)
         , m_name(nameIn)
-        , m_directory(QString())
         , m_size(sizeIn)
         , m_ownSize(sizeIn)
-        , m_mode(0)
-        , m_owner(QString())
-        , m_group(QString())
-        , m_perm(QString())
         , m_time(-1)
+        , m_mode(0)
+        , m_percent(-1)
+        , m_owner(0)
+        , m_group(0)
+        , m_mimeType(0)
         , m_symLink(false)
-        , m_mimeType(QString())
         , m_excluded(false)
-        , m_percent(-1)
     {
     }
 
@@ -325,10 +331,8 @@ public:
     {
         return m_name;
     }
-    inline const QString &directory() const
-    {
-        return m_directory;
-    }
+    /// The directory of the file: the path relative to the tree root, or the base path for the root itself
+    QString directory() const;
     inline FileSize size() const
     {
         return m_excluded ? 0 : m_size;
@@ -341,26 +345,20 @@ public:
     {
         return m_mode;
     }
-    inline const QString &owner() const
-    {
-        return m_owner;
-    }
-    inline const QString &group() const
+    inline QString owner() const
     {
-        return m_group;
+        return StringTable::string(m_owner);
     }
-    inline const QString &perm() const
+    inline QString group() const
     {
-        return m_perm;
+        return StringTable::string(m_group);
     }
+    QString perm() const;
     inline time_t time() const
     {
         return m_time;
     }
-    inline const QString &mime() const
-    {
-        return m_mimeType;
-    }
+    QString mime() const;
     inline bool isSymLink() const
     {
         return m_symLink;
@@ -403,6 +401,11 @@ public:
         m_ownSize = ownSize;
         m_size = totalSize;
     }
+    inline void addSizes(KIO::filesize_t totalSize, KIO::filesize_t ownSize)
+    {
+        m_ownSize += ownSize;
+        m_size += totalSize;
+    }
 
     enum UnitPrefix { kilo, mega, giga, tera };
 
@@ -415,24 +418,28 @@ public:
     static QString humanReadableSize(FileSize size, UnitPrefix Key = mega);
 
     friend class Directory;
+    friend class DUSnapshot;
 };
 
-// TODO when you modify this to take into account hardlinks you should make the Chain layered not inherited
-class Directory : public Chain<File>, public File
+/**
+ * A directory with its content. The children are kept in one contiguous array of pointers,
+ * iterate them with a range-based for loop over the directory.
+ */
+class Directory : public File
 {
 public:
+    typedef QVector<File *>::const_iterator const_iterator;
+
     Directory(Directory *parentIn,
               const QString &nameIn,
-              const QString &dir,
               FileSize sizeIn,
               mode_t modeIn,
               const QString &ownerIn,
               const QString &groupIn,
-              const QString &permIn,
               time_t timeIn,
               bool symLinkIn,
               const QString &mimeTypeIn)
-        : File(parentIn, nameIn, dir, sizeIn, modeIn, ownerIn, groupIn, permIn, timeIn, symLinkIn, mimeTypeIn)
+        : File(parentIn, nameIn, sizeIn, modeIn, ownerIn, groupIn, timeIn, symLinkIn, mimeTypeIn)
         , m_fileCount(0)
     {
     }
@@ -440,12 +447,13 @@ public:
     Directory(const QString &name, QString url)
         : File(name, 0)
         , m_fileCount(0)
+        , m_url(std::move(url))
     {
-        m_directory = url;
     }
 
     virtual ~Directory()
     {
+        qDeleteAll(m_children);
     }
     virtual bool isDir() const override
     {
@@ -462,25 +470,47 @@ public:
             parent = parent->m_parent;
         }
 
-        Chain<File>::append(p);
+        m_children.append(p);
         p->m_parent = this;
     }
 
+    /// Remove the file from this directory, the file is not deleted
     void remove(File *p)
     {
-        for (Iterator<File> it = Chain<File>::iterator(); it != Chain<File>::end(); ++it)
-            if ((*it) == p) {
-                --m_fileCount;
+        const int index = m_children.indexOf(p);
+        if (index < 0)
+            return;
+
+        --m_fileCount;
 
-                Directory *parent = m_parent;
-                while (parent) {
-                    parent->m_fileCount--;
-                    parent = parent->m_parent;
-                }
+        Directory *parent = m_parent;
+        while (parent) {
+            parent->m_fileCount--;
+            parent = parent->m_parent;
+        }
+
+        m_children.remove(index);
+    }
 
-                it.remove();
-                break;
-            }
+    const_iterator begin() const
+    {
+        return m_children.constBegin();
+    }
+    const_iterator end() const
+    {
+        return m_children.constEnd();
+    }
+    bool isEmpty() const
+    {
+        return m_children.isEmpty();
+    }
+    int count() const
+    {
+        return m_children.count();
+    }
+    File *at(int index) const
+    {
+        return m_children.at(index);
     }
 
     uint fileCount() const
@@ -492,7 +522,11 @@ private:
     Directory(const Directory &);
     void operator=(const Directory &);
 
+    QVector<File *> m_children;
     uint m_fileCount;
+    QString m_url; //< the base path, only set for the tree root
+
+    friend class File;
 };
 
 #endif
@@ -63,9 +63,9 @@ void RadialMap::Builder::findVisibleDepth(const Directory *const dir, const unsi
     if (*m_depth >= stopDepth)
         return;
 
-    for (ConstIterator<File> it = dir->constIterator(); it != dir->end(); ++it)
-        if ((*it)->isDir() && (*it)->size() > m_minSize)
-            findVisibleDepth(dynamic_cast<const Directory *>(*it), depth + 1); // if no files greater than min size the depth is still recorded
+    for (const File *file : *dir)
+        if (file->isDir() && file->size() > m_minSize)
+            findVisibleDepth(dynamic_cast<const Directory *>(file), depth + 1); // if no files greater than min size the depth is still recorded
 }
 
 void RadialMap::Builder::setLimits(const uint &b) // b = breadth?
@@ -90,7 +90,7 @@ bool RadialMap::Builder::build(const Directory *const dir, const unsigned int de
     FileSize hiddenSize = 0;
     uint hiddenFileCount = 0;
 
-    for (ConstIterator<File> it = dir->constIterator(); it != dir->end(); ++it) {
+    for (Directory::const_iterator it = dir->begin(); it != dir->end(); ++it) {
         if ((*it)->size() > m_limits[depth]) {
             auto a_len = (unsigned int)(5760 * ((double)(*it)->size() / (double)m_root->size()));
 
@@ -8,9 +8,8 @@
 // QtGui
 #include <QFont> //ctor
 #include <QFontMetrics> //ctor
-#include <QImage> //make() & paint()
-#include <QPainter>
-#include <QPolygon>
+#include <QImage> //invalidate()
+#include <QPainter> //resize()
 // QtWidgets
 #include <QApplication> //make()
 
@@ -22,9 +21,6 @@
 #include "builder.h"
 #include "fileTree.h"
 #include "widget.h"
-#include <cmath>
-
-#define COLOR_GREY QColor::fromHsv(0, 0, 140)
 
 RadialMap::Map::Map()
     : m_signature(nullptr)
@@ -45,6 +41,8 @@ RadialMap::Map::~Map()
 
 void RadialMap::Map::invalidate(const bool desaturateTheImage)
 {
+    m_renderer.cancel();
+
     delete[] m_signature;
     m_signature = nullptr;
 
@@ -66,13 +64,13 @@ void RadialMap::Map::make(const Directory *tree, bool refresh)
     //   but is it good to keep the text consistent?
     //   even if it makes it a lie?
 
-    // slow operation so set the wait cursor
-    QApplication::setOverrideCursor(Qt::WaitCursor);
-
     {
-        // build a signature of visible components
+        // build a signature of visible components, slow operation so set the wait cursor
+        // the painting is done in the background by the renderer
+        QApplication::setOverrideCursor(Qt::WaitCursor);
         delete[] m_signature;
         Builder builder(this, tree, refresh);
+        QApplication::restoreOverrideCursor();
     }
 
     // colour the segments
@@ -91,8 +89,6 @@ void RadialMap::Map::make(const Directory *tree, bool refresh)
 
     // paint the pixmap
     aaPaint();
-
-    QApplication::restoreOverrideCursor();
 }
 
 void RadialMap::Map::setRingBreadth()
@@ -133,9 +129,17 @@ bool RadialMap::Map::resize(const QRect &rect)
 
         // resize the pixmap
         size += MAP_2MARGIN;
+        QPixmap previous = *this;
         this->QPixmap::operator=(QPixmap(size, size));
 
         if (m_signature != nullptr) {
+            // show the scaled old map until the renderer delivers the new one
+            fill();
+            if (!previous.isNull()) {
+                QPainter paint(this);
+                paint.drawPixmap(QRect(0, 0, size, size), previous);
+            }
+
             setRingBreadth();
             paint();
         } else
@@ -235,11 +239,7 @@ void RadialMap::Map::colorise()
 
 void RadialMap::Map::aaPaint()
 {
-    // paint() is called during continuous processes
-    // aaPaint() is not and is slower so set overidecursor (make sets it too)
-    QApplication::setOverrideCursor(Qt::WaitCursor);
     paint(Config::antiAliasFactor);
-    QApplication::restoreOverrideCursor();
 }
 
 void RadialMap::Map::paint(unsigned int scaleFactor)
@@ -247,133 +247,26 @@ void RadialMap::Map::paint(unsigned int scaleFactor)
     if (scaleFactor == 0) // just in case
         scaleFactor = 1;
 
-    QPainter paint;
-    QRect rect = m_rect;
-    int step = m_ringBreadth;
-    int excess = -1;
-
-    // scale the pixmap, or do intelligent distribution of excess to prevent nasty resizing
-    if (scaleFactor > 1) {
-        int x1, y1, x2, y2;
-        rect.getCoords(&x1, &y1, &x2, &y2);
-        x1 *= scaleFactor;
-        y1 *= scaleFactor;
-        x2 *= scaleFactor;
-        y2 *= scaleFactor;
-        rect.setCoords(x1, y1, x2, y2);
-
-        step *= scaleFactor;
-        QPixmap::operator=(QPixmap(this->size() * (int)scaleFactor));
-    } else if (m_ringBreadth != MAX_RING_BREADTH && m_ringBreadth != MIN_RING_BREADTH) {
-        excess = rect.width() % m_ringBreadth;
-        ++step;
+    // the segments belong to the GUI thread, the renderer gets a copy of what it paints
+    RenderJob job;
+    job.size = size();
+    job.rect = m_rect;
+    job.ringBreadth = m_ringBreadth;
+    job.centerText = m_centerText;
+    job.font = QFont();
+    job.rings.resize(m_visibleDepth + 1);
+    for (uint i = 0; i <= m_visibleDepth; ++i) {
+        for (ConstIterator<Segment> it = m_signature[i].constIterator(); it != m_signature[i].end(); ++it)
+            job.rings[i].append(SegmentShape{(*it)->start(), (*it)->length(), (*it)->pen(), (*it)->brush(), (*it)->hasHiddenChildren()});
     }
 
-    //**** best option you can think of is to make the circles slightly less perfect,
-    //  ** i.e. slightly elliptic when resizing inbetween
-
-    paint.begin(this);
-
-    fill(); // erase background
-
-    for (int x = m_visibleDepth; x >= 0; --x) {
-        int width = rect.width() / 2;
-        // clever geometric trick to find largest angle that will give biggest arrow head
-        auto a_max = int(acos((double)width / double((width + 5) * scaleFactor)) * (180 * 16 / M_PI));
-
-        for (ConstIterator<Segment> it = m_signature[x].constIterator(); it != m_signature[x].end(); ++it) {
-            // draw the pie segments, most of this code is concerned with drawing the little
-            // arrows on the ends of segments when they have hidden files
+    // the labels and the mouse need the inner circle before the map is painted
+    m_innerRadius = Renderer::innerRect(m_rect, m_ringBreadth, m_visibleDepth, scaleFactor).width() / 2; // rect.width should be multiple of 2
 
-            paint.setPen((*it)->pen());
-
-            if ((*it)->hasHiddenChildren()) {
-                // draw arrow head to indicate undisplayed files/directories
-                QPolygon pts(3);
-                QPoint pos, cpos = rect.center();
-                int a[3] = {static_cast<int>((*it)->start()), static_cast<int>((*it)->length()), 0};
-
-                a[2] = a[0] + (a[1] / 2); // assign to halfway between
-                if (a[1] > a_max) {
-                    a[1] = a_max;
-                    a[0] = a[2] - a_max / 2;
-                }
-
-                a[1] += a[0];
-
-                for (int i = 0, radius = width; i < 3; ++i) {
-                    double ra = M_PI / (180 * 16) * a[i], sinra, cosra;
-
-                    if (i == 2)
-                        radius += 5 * scaleFactor;
-                    sinra = sin(ra);
-                    cosra = cos(ra);
-                    pos.rx() = cpos.x() + static_cast<int>(cosra * radius);
-                    pos.ry() = cpos.y() - static_cast<int>(sinra * radius);
-                    pts.setPoint(i, pos);
-                }
-
-                paint.setBrush((*it)->pen());
-                paint.drawPolygon(pts);
-            }
-
-            paint.setBrush((*it)->brush());
-            paint.drawPie(rect, (*it)->start(), (*it)->length());
-
-            if ((*it)->hasHiddenChildren()) {
-                //**** code is bloated!
-                paint.save();
-                QPen pen = paint.pen();
-                int width = 2 * scaleFactor;
-                pen.setWidth(width);
-                paint.setPen(pen);
-                QRect rect2 = rect;
-                width /= 2;
-                rect2.adjust(width, width, -width, -width);
-                paint.drawArc(rect2, (*it)->start(), (*it)->length());
-                paint.restore();
-            }
-        }
-
-        if (excess >= 0) { // excess allows us to resize more smoothly (still crud tho)
-            if (excess < 2) // only decrease rect by more if even number of excesses left
-                --step;
-            excess -= 2;
-        }
-
-        rect.adjust(step, step, -step, -step);
-    }
-
-    //  if( excess > 0 ) rect.adjust( excess, excess, 0, 0 ); //ugly
-
-    paint.setPen(COLOR_GREY);
-    paint.setBrush(Qt::white);
-    paint.drawEllipse(rect);
-
-    if (scaleFactor > 1) {
-        // have to end in order to smoothscale()
-        paint.end();
-
-        int x1, y1, x2, y2;
-        rect.getCoords(&x1, &y1, &x2, &y2);
-        x1 /= scaleFactor;
-        y1 /= scaleFactor;
-        x2 /= scaleFactor;
-        y2 /= scaleFactor;
-        rect.setCoords(x1, y1, x2, y2);
-
-        QImage img = this->toImage();
-        img = img.scaled(this->size() / (int)scaleFactor, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
-        this->QPixmap::operator=(fromImage(img, Qt::AutoColor));
-
-        paint.begin(this);
-        paint.setPen(COLOR_GREY);
-        paint.setBrush(Qt::white);
-    }
-
-    paint.drawText(rect, Qt::AlignCenter, m_centerText);
-
-    m_innerRadius = rect.width() / 2; // rect.width should be multiple of 2
+    m_renderer.render(job, scaleFactor);
+}
 
-    paint.end();
+void RadialMap::Map::setRendered(const QImage &image)
+{
+    this->QPixmap::operator=(fromImage(image, Qt::AutoColor));
 }
@@ -0,0 +1,209 @@
+/*
+    SPDX-FileCopyrightText: 2026 Krusader Krew <https://krusader.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "renderer.h"
+
+// QtCore
+#include <QtConcurrent/QtConcurrentRun> // krazy:exclude=includes
+// QtGui
+#include <QPainter>
+#include <QPolygon>
+
+#include "radialMap.h" //constants
+#include <cmath>
+
+#define COLOR_GREY QColor::fromHsv(0, 0, 140)
+
+RadialMap::Renderer::Renderer(QObject *parent)
+    : QObject(parent)
+    , m_run(this)
+{
+    // a new render makes the running one obsolete, painting them side by side gains nothing
+    m_pool.setMaxThreadCount(1);
+}
+
+RadialMap::Renderer::~Renderer()
+{
+    cancel();
+    m_pool.waitForDone();
+}
+
+void RadialMap::Renderer::render(const RenderJob &job, uint scaleFactor)
+{
+    cancel();
+    const int generation = m_run.start();
+
+    QtConcurrent::run(&m_pool, [=]() {
+        // the quick pass shows the map at once, the antialiased one replaces it when done
+        postRendered(paint(job, 1, generation), generation);
+        if (scaleFactor > 1)
+            postRendered(paint(job, scaleFactor, generation), generation);
+    });
+}
+
+void RadialMap::Renderer::cancel()
+{
+    if (m_run.cancel())
+        m_pool.clear();
+}
+
+void RadialMap::Renderer::postRendered(const QImage &image, int generation)
+{
+    if (image.isNull())
+        return;
+
+    m_run.post(generation, [this, image]() {
+        emit rendered(image);
+    });
+}
+
+QVector<QRect> RadialMap::Renderer::ringRects(const QRect &rect, uint ringBreadth, int visibleDepth, uint scaleFactor)
+{
+    QVector<QRect> rects;
+    rects.reserve(visibleDepth + 2);
+
+    QRect ringRect = rect;
+    int step = ringBreadth;
+    int excess = -1;
+
+    // scale the rect, or do intelligent distribution of excess to prevent nasty resizing
+    if (scaleFactor > 1) {
+        int x1, y1, x2, y2;
+        ringRect.getCoords(&x1, &y1, &x2, &y2);
+        ringRect.setCoords(x1 * scaleFactor, y1 * scaleFactor, x2 * scaleFactor, y2 * scaleFactor);
+        step *= scaleFactor;
+    } else if (ringBreadth != MAX_RING_BREADTH && ringBreadth != MIN_RING_BREADTH) {
+        excess = ringRect.width() % ringBreadth;
+        ++step;
+    }
+
+    //**** best option you can think of is to make the circles slightly less perfect,
+    //  ** i.e. slightly elliptic when resizing inbetween
+
+    for (int x = visibleDepth; x >= 0; --x) {
+        rects.append(ringRect);
+
+        if (excess >= 0) { // excess allows us to resize more smoothly (still crud tho)
+            if (excess < 2) // only decrease rect by more if even number of excesses left
+                --step;
+            excess -= 2;
+        }
+
+        ringRect.adjust(step, step, -step, -step);
+    }
+    rects.append(ringRect);
+
+    return rects;
+}
+
+QRect RadialMap::Renderer::innerRect(const QRect &rect, uint ringBreadth, int visibleDepth, uint scaleFactor)
+{
+    if (scaleFactor == 0) // just in case
+        scaleFactor = 1;
+
+    int x1, y1, x2, y2;
+    ringRects(rect, ringBreadth, visibleDepth, scaleFactor).last().getCoords(&x1, &y1, &x2, &y2);
+    return QRect(QPoint(x1 / (int)scaleFactor, y1 / (int)scaleFactor), QPoint(x2 / (int)scaleFactor, y2 / (int)scaleFactor));
+}
+
+QImage RadialMap::Renderer::paint(const RenderJob &job, uint scaleFactor, int generation) const
+{
+    const int visibleDepth = job.rings.count() - 1;
+    const QVector<QRect> rects = ringRects(job.rect, job.ringBreadth, visibleDepth, scaleFactor);
+
+    QImage image(job.size * (int)scaleFactor, QImage::Format_RGB32);
+    image.fill(Qt::white); // erase background
+
+    QPainter paint(&image);
+
+    for (int x = visibleDepth; x >= 0; --x) {
+        if (!m_run.isCurrent(generation))
+            return QImage();
+
+        const QRect &rect = rects.at(visibleDepth - x);
+        int width = rect.width() / 2;
+        // clever geometric trick to find largest angle that will give biggest arrow head
+        auto a_max = int(acos((double)width / double((width + 5) * scaleFactor)) * (180 * 16 / M_PI));
+
+        for (const SegmentShape &segment : job.rings.at(x)) {
+            // draw the pie segments, most of this code is concerned with drawing the little
+            // arrows on the ends of segments when they have hidden files
+
+            paint.setPen(segment.pen);
+
+            if (segment.hasHiddenChildren) {
+                // draw arrow head to indicate undisplayed files/directories
+                QPolygon pts(3);
+                QPoint pos, cpos = rect.center();
+                int a[3] = {static_cast<int>(segment.start), static_cast<int>(segment.length), 0};
+
+                a[2] = a[0] + (a[1] / 2); // assign to halfway between
+                if (a[1] > a_max) {
+                    a[1] = a_max;
+                    a[0] = a[2] - a_max / 2;
+                }
+
+                a[1] += a[0];
+
+                for (int i = 0, radius = width; i < 3; ++i) {
+                    double ra = M_PI / (180 * 16) * a[i], sinra, cosra;
+
+                    if (i == 2)
+                        radius += 5 * scaleFactor;
+                    sinra = sin(ra);
+                    cosra = cos(ra);
+                    pos.rx() = cpos.x() + static_cast<int>(cosra * radius);
+                    pos.ry() = cpos.y() - static_cast<int>(sinra * radius);
+                    pts.setPoint(i, pos);
+                }
+
+                paint.setBrush(segment.pen);
+                paint.drawPolygon(pts);
+            }
+
+            paint.setBrush(segment.brush);
+            paint.drawPie(rect, segment.start, segment.length);
+
+            if (segment.hasHiddenChildren) {
+                //**** code is bloated!
+                paint.save();
+                QPen pen = paint.pen();
+                int width = 2 * scaleFactor;
+                pen.setWidth(width);
+                paint.setPen(pen);
+                QRect rect2 = rect;
+                width /= 2;
+                rect2.adjust(width, width, -width, -width);
+                paint.drawArc(rect2, segment.start, segment.length);
+                paint.restore();
+            }
+        }
+    }
+
+    QRect rect = rects.last();
+
+    paint.setPen(COLOR_GREY);
+    paint.setBrush(Qt::white);
+    paint.drawEllipse(rect);
+
+    if (scaleFactor > 1) {
+        // have to end in order to scale the image
+        paint.end();
+
+        rect = innerRect(job.rect, job.ringBreadth, visibleDepth, scaleFactor);
+        image = image.scaled(job.size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+
+        paint.begin(&image);
+        paint.setPen(COLOR_GREY);
+        paint.setBrush(Qt::white);
+    }
+
+    paint.setFont(job.font);
+    paint.drawText(rect, Qt::AlignCenter, job.centerText);
+    paint.end();
+
+    return image;
+}
@@ -0,0 +1,86 @@
+/*
+    SPDX-FileCopyrightText: 2026 Krusader Krew <https://krusader.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef RENDERER_H
+#define RENDERER_H
+
+// QtCore
+#include <QObject>
+#include <QRect>
+#include <QSize>
+#include <QString>
+#include <QThreadPool>
+#include <QVector>
+// QtGui
+#include <QColor>
+#include <QFont>
+#include <QImage>
+
+#include "../../workerrun.h"
+
+namespace RadialMap
+{
+/// A segment as it is painted, copied from the Segment so the worker thread does not touch the file tree
+struct SegmentShape {
+    uint start; //< in 16ths of degrees
+    uint length;
+    QColor pen;
+    QColor brush;
+    bool hasHiddenChildren;
+};
+
+/// Everything needed to paint a map, independent of the Map it was taken from
+struct RenderJob {
+    QSize size; //< the size of the map pixmap
+    QRect rect; //< the outer circle
+    uint ringBreadth;
+    QString centerText;
+    QFont font;
+    QVector<QVector<SegmentShape>> rings; //< from the innermost ring outwards
+};
+
+/**
+ * Paints the radial map into a QImage in a worker thread.
+ *
+ * A quick pass without antialiasing is delivered first, then the map is painted again at the
+ * antialiasing factor and scaled down. A new render() or cancel() drops the passes still running,
+ * their results are never delivered.
+ */
+class Renderer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit Renderer(QObject *parent = nullptr);
+    ~Renderer() override;
+
+    /// Paint @p job in the background, antialiased at @p scaleFactor if it is greater than 1
+    void render(const RenderJob &job, uint scaleFactor);
+    /// Drop the passes still running
+    void cancel();
+
+    /// The inner circle of a map painted at @p scaleFactor, known before the map is painted
+    static QRect innerRect(const QRect &rect, uint ringBreadth, int visibleDepth, uint scaleFactor);
+
+signals:
+    /// A pass of the last render() is done. Not emitted for canceled renders.
+    void rendered(const QImage &image);
+
+private:
+    /// The rectangles of the rings from the outermost one inwards, the last one is the inner circle.
+    /// All coordinates are multiplied by @p scaleFactor.
+    static QVector<QRect> ringRects(const QRect &rect, uint ringBreadth, int visibleDepth, uint scaleFactor);
+    /// Paint the map, called in a worker thread. Returns a null image if the render got canceled.
+    QImage paint(const RenderJob &job, uint scaleFactor, int generation) const;
+    /// Emit rendered() in the GUI thread unless the render was canceled meanwhile
+    void postRendered(const QImage &image, int generation);
+
+    QThreadPool m_pool;
+    WorkerRun m_run; //< the passes of the last render()
+};
+}
+
+#endif // RENDERER_H
@@ -98,7 +98,7 @@ void SegmentTip::moveto(QPoint p, QWidget &canvas, bool placeAbove)
     repaint();
 }
 
-void SegmentTip::updateTip(const File *const file, const Directory *const root)
+void SegmentTip::updateTip(const File *const file, const Directory *const root, const QString &note)
 {
     const QString s1 = file->fullPath(root);
     QString s2 = file->humanReadableSize();
@@ -129,6 +129,15 @@ void SegmentTip::updateTip(const File *const file, const Directory *const root)
         m_text += s3;
     }
 
+    if (!note.isEmpty()) {
+        const auto noteWidth = static_cast<uint>(fontMetrics().horizontalAdvance(note));
+        if (noteWidth > maxw)
+            maxw = noteWidth;
+        h += fontMetrics().height();
+        m_text += '\n';
+        m_text += note;
+    }
+
     uint w = fontMetrics().horizontalAdvance(s1);
     if (w > maxw)
         maxw = w;
@@ -25,7 +25,7 @@ class SegmentTip : public QWidget
 public:
     explicit SegmentTip(uint);
 
-    void updateTip(const File *, const Directory *);
+    void updateTip(const File *, const Directory *, const QString &note = QString());
     void moveto(QPoint, QWidget &, bool);
 
 private:
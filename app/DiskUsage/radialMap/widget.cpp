@@ -37,6 +37,7 @@ RadialMap::Widget::Widget(QWidget *parent)
     connect(this, &Widget::created, this, &Widget::sendFakeMouseEvent);
     connect(this, &Widget::created, this, QOverload<>::of(&Widget::update));
     connect(&m_timer, &QTimer::timeout, this, &Widget::resizeTimeout);
+    connect(&m_map.m_renderer, &Renderer::rendered, this, &Widget::mapRendered);
 }
 
 QString RadialMap::Widget::path() const
@@ -130,6 +131,12 @@ void RadialMap::Widget::resizeTimeout() // slot
     update();
 }
 
+void RadialMap::Widget::mapRendered(const QImage &image) // slot
+{
+    m_map.setRendered(image);
+    update();
+}
+
 void RadialMap::Widget::refresh(int filth)
 {
     // TODO consider a more direct connection
@@ -16,6 +16,7 @@
 #include <QPaintEvent>
 #include <QResizeEvent>
 
+#include "renderer.h"
 #include "segmentTip.h"
 
 template<class T>
@@ -51,8 +52,10 @@ private:
     void aaPaint();
     void colorise();
     void setRingBreadth();
+    void setRendered(const QImage &);
 
     Chain<Segment> *m_signature;
+    Renderer m_renderer;
 
     QRect m_rect;
     uint m_ringBreadth; /// ring breadth
@@ -92,6 +95,7 @@ private slots:
     void sendFakeMouseEvent();
     void deleteJobFinished(KJob *);
     void createFromCache(const Directory *);
+    void mapRendered(const QImage &);
 
 signals:
     void activated(const QUrl &);
@@ -115,6 +119,11 @@ protected:
     {
         return m_focus;
     } /// 0 == nothing in focus
+    /// an additional line for the tooltip of the segment
+    virtual QString segmentNote(const File *) const
+    {
+        return QString();
+    }
 
 private:
     void paintExplodedLabels(QPainter &) const;
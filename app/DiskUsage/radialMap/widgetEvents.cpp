@@ -130,7 +130,7 @@ void RadialMap::Widget::mouseMoveEvent(QMouseEvent *e)
     if (m_focus && m_focus->file() != m_tree) {
         if (m_focus != oldFocus) { // if not same as last time
             setCursor(QCursor(Qt::PointingHandCursor));
-            m_tip.updateTip(m_focus->file(), m_tree);
+            m_tip.updateTip(m_focus->file(), m_tree, segmentNote(m_focus->file()));
             emit mouseHover(m_focus->file()->fullPath());
 
             // repaint required to update labels now before transparency is generated
@@ -0,0 +1,85 @@
+/*
+    SPDX-FileCopyrightText: 2026 Krusader Krew <https://krusader.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "bytesearcher.h"
+
+#include <algorithm>
+#include <cstring>
+
+static inline unsigned char foldCase(unsigned char c)
+{
+    return (c >= 'A' && c <= 'Z') ? static_cast<unsigned char>(c + ('a' - 'A')) : c;
+}
+
+ByteSearcher::ByteSearcher()
+    : m_caseSensitive(true)
+{
+    std::fill(m_skip, m_skip + 256, 1);
+}
+
+ByteSearcher::ByteSearcher(const QByteArray &pattern, bool caseSensitive)
+    : m_pattern(caseSensitive ? pattern : pattern.toLower())
+    , m_caseSensitive(caseSensitive)
+{
+    // QByteArray::toLower() only changes ASCII letters, like foldCase()
+    const int length = m_pattern.size();
+    std::fill(m_skip, m_skip + 256, qMax(length, 1));
+    for (int i = 0; i < length - 1; ++i) {
+        const auto c = static_cast<unsigned char>(m_pattern[i]);
+        m_skip[c] = length - 1 - i;
+        if (!caseSensitive && c >= 'a' && c <= 'z')
+            m_skip[c - ('a' - 'A')] = length - 1 - i;
+    }
+}
+
+qint64 ByteSearcher::indexIn(const char *data, qint64 length) const
+{
+    const int patternLength = m_pattern.size();
+    if (patternLength == 0)
+        return 0;
+    if (length < patternLength)
+        return -1;
+
+    const auto *text = reinterpret_cast<const unsigned char *>(data);
+    const auto *pattern = reinterpret_cast<const unsigned char *>(m_pattern.constData());
+
+    if (patternLength == 1) {
+        if (m_caseSensitive || pattern[0] < 'a' || pattern[0] > 'z') {
+            const void *found = memchr(text, pattern[0], static_cast<size_t>(length));
+            return found ? static_cast<const unsigned char *>(found) - text : -1;
+        }
+        for (qint64 i = 0; i < length; ++i) {
+            if (foldCase(text[i]) == pattern[0])
+                return i;
+        }
+        return -1;
+    }
+
+    const unsigned char last = pattern[patternLength - 1];
+    const qint64 end = length - patternLength;
+    qint64 pos = 0;
+    if (m_caseSensitive) {
+        while (pos <= end) {
+            const unsigned char c = text[pos + patternLength - 1];
+            if (c == last && memcmp(text + pos, pattern, static_cast<size_t>(patternLength - 1)) == 0)
+                return pos;
+            pos += m_skip[c];
+        }
+    } else {
+        while (pos <= end) {
+            const unsigned char c = text[pos + patternLength - 1];
+            if (foldCase(c) == last) {
+                int i = 0;
+                while (i < patternLength - 1 && foldCase(text[pos + i]) == pattern[i])
+                    ++i;
+                if (i == patternLength - 1)
+                    return pos;
+            }
+            pos += m_skip[c];
+        }
+    }
+    return -1;
+}
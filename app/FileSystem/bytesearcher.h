@@ -0,0 +1,48 @@
+/*
+    SPDX-FileCopyrightText: 2026 Krusader Krew <https://krusader.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef BYTESEARCHER_H
+#define BYTESEARCHER_H
+
+// QtCore
+#include <QByteArray>
+
+/**
+ * Fast search for a byte string in raw data, optionally ignoring the case of ASCII letters.
+ *
+ * The pattern is prepared once; searching uses the Boyer-Moore-Horspool algorithm and memchr()
+ * (vectorized by the C library) for single bytes. Nothing is allocated while searching, so one
+ * searcher can be used for gigabytes of data.
+ */
+class ByteSearcher
+{
+public:
+    ByteSearcher();
+    /**
+     * @param pattern the bytes to search for
+     * @param caseSensitive if false, ASCII letters match in both cases (other bytes exactly)
+     */
+    ByteSearcher(const QByteArray &pattern, bool caseSensitive);
+
+    bool isEmpty() const
+    {
+        return m_pattern.isEmpty();
+    }
+    int patternLength() const
+    {
+        return m_pattern.size();
+    }
+
+    /// Return the position of the first match in @p data or -1 if there is none
+    qint64 indexIn(const char *data, qint64 length) const;
+
+private:
+    QByteArray m_pattern; //< the pattern, in lower case if not case sensitive
+    bool m_caseSensitive;
+    int m_skip[256]; //< Horspool shift for each (folded) byte
+};
+
+#endif // BYTESEARCHER_H
@@ -10,6 +10,7 @@
 // QtCore
 #include <QDebug>
 #include <QDir>
+#include <QElapsedTimer>
 #include <QEventLoop>
 
 #include <KDiskFreeSpaceInfo>
@@ -29,13 +30,27 @@
 
 #include "../JobMan/krjob.h"
 #include "../defaults.h"
+#include "../krdebuglogger.h"
 #include "../krglobal.h"
 #include "../krservices.h"
 #include "fileitem.h"
+#include "locallister.h"
 
 DefaultFileSystem::DefaultFileSystem()
+    : _watcherDirDirty(false)
+    , _dirtyWhileRefreshing(false)
 {
     _type = FS_DEFAULT;
+
+    _watcherTimer.setSingleShot(true);
+    connect(&_watcherTimer, &QTimer::timeout, this, &DefaultFileSystem::slotWatcherTimeout);
+}
+
+DefaultFileSystem::~DefaultFileSystem()
+{
+    // the list threads delete themselves when finished
+    cancelRefreshInternal();
+    cancelUpdate();
 }
 
 void DefaultFileSystem::copyFiles(const QList<QUrl> &urls,
@@ -195,6 +210,7 @@ bool DefaultFileSystem::refreshInternal(const QUrl &directory, bool onlyScan)
     }
 
     delete _watcher; // stop watching the old dir
+    cancelUpdate();
 
     if (directory.isLocalFile()) {
         qDebug() << "start local refresh to URL=" << directory.toDisplayString();
@@ -204,7 +220,84 @@ bool DefaultFileSystem::refreshInternal(const QUrl &directory, bool onlyScan)
 
     _currentDirectory = cleanUrl(directory);
 
-    // start the listing job
+    KIO::ListJob *job = startListJob();
+
+    // ugly: we have to wait here until the list job is finished
+    QEventLoop eventLoop;
+    connect(job, &KJob::finished, &eventLoop, &QEventLoop::quit);
+    eventLoop.exec(); // blocking until quit()
+
+    return !_listError;
+}
+
+void DefaultFileSystem::startRefreshInternal(const QUrl &directory, bool onlyScan)
+{
+    qDebug() << "async refresh internal to URL=" << directory.toDisplayString();
+    if (!KProtocolManager::supportsListing(directory)) {
+        emit error(i18n("Protocol not supported by Krusader:\n%1", directory.url()));
+        finishRefresh(false);
+        return;
+    }
+
+    delete _watcher; // stop watching the old dir
+    cancelUpdate();
+
+    if (directory.isLocalFile()) {
+        const QString path = openLocalDirectory(directory);
+        if (path.isEmpty()) {
+            finishRefresh(false);
+            return;
+        }
+
+        // watch while listing, changes after the directory was read must not be missed
+        _dirtyWhileRefreshing = false;
+        if (!onlyScan)
+            startWatcher();
+
+        // list in a background thread, the file items are added when available
+        const bool showHidden = showHiddenFiles();
+        LocalListThread *listThread = new LocalListThread(path, showHidden, showHidden ? QSet<QString>() : filesInDotHidden(path));
+        connect(listThread, &LocalListThread::itemsAvailable, this, [=]() {
+            if (listThread == _listThread)
+                slotListThreadItems();
+        });
+        connect(listThread, &QThread::finished, this, [=]() {
+            if (listThread == _listThread)
+                slotListThreadFinished(onlyScan);
+        });
+        _listThread = listThread;
+        listThread->start();
+        return;
+    }
+
+    _currentDirectory = cleanUrl(directory);
+
+    KIO::ListJob *job = startListJob();
+    _listJob = job;
+    connect(job, &KJob::finished, this, [=]() {
+        if (job == _listJob) {
+            _listJob = nullptr;
+            finishRefresh(!_listError);
+        }
+    });
+}
+
+void DefaultFileSystem::cancelRefreshInternal()
+{
+    if (_listThread) {
+        _listThread->cancel();
+        _listThread = nullptr;
+        delete _watcher;
+    }
+    if (_listJob) {
+        KIO::ListJob *job = _listJob;
+        _listJob = nullptr;
+        job->kill();
+    }
+}
+
+KIO::ListJob *DefaultFileSystem::startListJob()
+{
     KIO::ListJob *job = KIO::listDir(_currentDirectory, KIO::HideProgressInfo, showHiddenFiles());
     connect(job, &KIO::ListJob::entries, this, &DefaultFileSystem::slotAddFiles);
     connect(job, &KIO::ListJob::redirection, this, &DefaultFileSystem::slotRedirection);
@@ -220,12 +313,7 @@ bool DefaultFileSystem::refreshInternal(const QUrl &directory, bool onlyScan)
     emit refreshJobStarted(job);
 
     _listError = false;
-    // ugly: we have to wait here until the list job is finished
-    QEventLoop eventLoop;
-    connect(job, &KJob::finished, &eventLoop, &QEventLoop::quit);
-    eventLoop.exec(); // blocking until quit()
-
-    return !_listError;
+    return job;
 }
 
 // ==== protected slots ====
@@ -243,12 +331,55 @@ void DefaultFileSystem::slotListResult(KJob *job)
 
 void DefaultFileSystem::slotAddFiles(KIO::Job *, const KIO::UDSEntryList &entries)
 {
+    QList<FileItem *> fileItems;
+    fileItems.reserve(entries.count());
     for (const KIO::UDSEntry &entry : entries) {
         FileItem *fileItem = FileSystem::createFileItemFromKIO(entry, _currentDirectory);
         if (fileItem) {
-            addFileItem(fileItem);
+            fileItems << fileItem;
         }
     }
+    addFileItems(fileItems);
+}
+
+void DefaultFileSystem::slotListThreadItems()
+{
+    addFileItems(_listThread->takeItems());
+}
+
+void DefaultFileSystem::slotListThreadFinished(bool onlyScan)
+{
+    addFileItems(_listThread->takeItems());
+    const LocalListThread::Result result = _listThread->result();
+    _listThread = nullptr;
+
+    const QString path = _currentDirectory.path();
+    switch (result) {
+    case LocalListThread::OpenFailed:
+        emit error(i18n("Cannot open the folder %1.", path));
+        break;
+    case LocalListThread::AccessDenied:
+        emit error(i18nc("%1=folder path", "Access to %1 denied", path));
+        break;
+    case LocalListThread::ReadFailed:
+        emit error(i18n("Cannot read the folder %1.", path));
+        break;
+    case LocalListThread::Succeeded:
+        break;
+    case LocalListThread::Canceled:
+        break;
+    }
+
+    if (result != LocalListThread::Succeeded)
+        delete _watcher;
+
+    finishRefresh(result == LocalListThread::Succeeded);
+
+    if (result == LocalListThread::Succeeded && _dirtyWhileRefreshing) {
+        // the directory changed while it was listed, update it
+        _dirtyWhileRefreshing = false;
+        slotWatcherDirty(realPath());
+    }
 }
 
 void DefaultFileSystem::slotRedirection(KIO::Job *job, const QUrl &url)
@@ -261,6 +392,13 @@ void DefaultFileSystem::slotRedirection(KIO::Job *job, const QUrl &url)
     if (newUrl.scheme() != _currentDirectory.scheme()) {
         // abort and start over again,
         // some protocols (iso, zip, tar) do this on transition to local fs
+        if (job == _listJob) {
+            // asynchronous refresh: continue with the new URL
+            _listJob = nullptr;
+            job->kill();
+            startRefreshInternal(newUrl, false);
+            return;
+        }
         job->kill();
         _isRefreshing = false;
         refresh(newUrl);
@@ -278,33 +416,71 @@ void DefaultFileSystem::slotWatcherCreated(const QString &path)
 void DefaultFileSystem::slotWatcherDirty(const QString &path)
 {
     qDebug() << "path dirty: " << path;
+    if (isRefreshing()) {
+        // the listing may have read the directory before the change, update it afterwards
+        _dirtyWhileRefreshing = true;
+        return;
+    }
+
     if (path == realPath()) {
         // this happens
         //   1. if a directory was created/deleted/renamed inside this directory.
         //   2. during and after a file operation (create/delete/rename/touch) inside this directory
-        // KDirWatcher doesn't reveal the name of changed directories and we have to refresh.
-        // (QFileSystemWatcher in Qt5.7 can't help here either)
-        refresh();
-        return;
+        // KDirWatcher doesn't reveal the name of changed directories and we have to list the
+        // directory again. (QFileSystemWatcher in Qt5.7 can't help here either)
+        _watcherDirDirty = true;
+    } else {
+        _watcherDirtyFiles.insert(QUrl::fromLocalFile(path).fileName());
     }
 
-    const QString name = QUrl::fromLocalFile(path).fileName();
+    // NOTE: the timer is not restarted, a directory which changes all the time must be updated too
+    if (!_watcherTimer.isActive()) {
+        const KConfigGroup group(krConfig, "Advanced");
+        _watcherTimer.start(group.readEntry("Watcher Update Delay", _WatcherUpdateDelay));
+    }
+}
 
-    FileItem *fileItem = getFileItem(name);
-    if (!fileItem) {
-        qWarning() << "file not found (unexpected), path=" << path;
-        // this happens at least for cifs mounted filesystems: when a new file is created, a dirty
-        // signal with its file path but no other signals are sent (buggy behaviour of KDirWatch)
-        refresh();
+void DefaultFileSystem::slotWatcherTimeout()
+{
+    if (isRefreshing()) {
+        cancelUpdate();
+        return;
+    }
+    if (_updateThread) {
+        // try again after the running update
+        _watcherTimer.start();
         return;
     }
 
-    // we have an updated file..
-    FileItem *newFileItem = createLocalFileItem(name);
-    addFileItem(newFileItem);
-    emit updatedFileItem(newFileItem);
+    bool needUpdate = _watcherDirDirty;
+    const QSet<QString> dirtyFiles = _watcherDirtyFiles;
+    _watcherDirDirty = false;
+    _watcherDirtyFiles.clear();
+
+    if (!needUpdate) {
+        // only some files were changed, replace them
+        for (const QString &name : dirtyFiles) {
+            FileItem *fileItem = getFileItem(name);
+            if (!fileItem) {
+                qWarning() << "file not found (unexpected), name=" << name;
+                // this happens at least for cifs mounted filesystems: when a new file is created, a
+                // dirty signal with its file path but no other signals are sent (buggy behaviour of
+                // KDirWatch)
+                needUpdate = true;
+                break;
+            }
+
+            // we have an updated file..
+            FileItem *newFileItem = createLocalFileItem(name);
+            addFileItem(newFileItem);
+            emit updatedFileItem(newFileItem);
+
+            delete fileItem;
+        }
+    }
 
-    delete fileItem;
+    if (needUpdate)
+        startUpdate();
 }
 
 void DefaultFileSystem::slotWatcherDeleted(const QString &path)
@@ -317,10 +493,57 @@ void DefaultFileSystem::slotWatcherDeleted(const QString &path)
 
     // the current directory was deleted. Try a refresh, which will fail. An error message will
     // be emitted and the empty (non-existing) directory remains.
-    refresh();
+    refreshAsync();
 }
 
-bool DefaultFileSystem::refreshLocal(const QUrl &directory, bool onlyScan)
+void DefaultFileSystem::startUpdate()
+{
+    const QString path = _currentDirectory.path();
+    const bool showHidden = showHiddenFiles();
+
+    QElapsedTimer timer;
+    timer.start();
+    LocalListThread *updateThread = new LocalListThread(path, showHidden, showHidden ? QSet<QString>() : filesInDotHidden(path));
+    connect(updateThread, &QThread::finished, this, [=]() {
+        if (updateThread == _updateThread)
+            updateFinished(timer.elapsed());
+    });
+    _updateThread = updateThread;
+    updateThread->start();
+}
+
+void DefaultFileSystem::updateFinished(qint64 listTime)
+{
+    const QList<FileItem *> fileItems = _updateThread->takeItems();
+    const LocalListThread::Result result = _updateThread->result();
+    _updateThread = nullptr;
+
+    if (result != LocalListThread::Succeeded) {
+        qDeleteAll(fileItems);
+        // e.g. the directory is not readable anymore, a refresh shows the error
+        refreshAsync();
+        return;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    const int changes = updateFileItems(fileItems);
+    KRDEBUG("updated " << _currentDirectory.path() << ": " << fileItems.count() << " files, " << changes << " changes, listing " << listTime
+                       << " ms, applying changes " << timer.elapsed() << " ms");
+}
+
+void DefaultFileSystem::cancelUpdate()
+{
+    _watcherTimer.stop();
+    _watcherDirDirty = false;
+    _watcherDirtyFiles.clear();
+    if (_updateThread) {
+        _updateThread->cancel();
+        _updateThread = nullptr;
+    }
+}
+
+QString DefaultFileSystem::openLocalDirectory(const QUrl &directory)
 {
     const QString path = KrServices::urlToLocalPath(directory);
 
@@ -333,7 +556,7 @@ bool DefaultFileSystem::refreshLocal(const QUrl &directory, bool onlyScan)
     // check if the new directory exists
     if (!QDir(path).exists()) {
         emit error(i18n("The folder %1 does not exist.", path));
-        return false;
+        return QString();
     }
 
     // mount if needed
@@ -343,63 +566,60 @@ bool DefaultFileSystem::refreshLocal(const QUrl &directory, bool onlyScan)
     _currentDirectory = directory;
     _currentDirectory.setPath(QDir::cleanPath(_currentDirectory.path()));
 
-    // Note: we are using low-level Qt functions here.
-    // It's around twice as fast as using the QDir class.
+    return path;
+}
 
-    QT_DIR *dir = QT_OPENDIR(path.toLocal8Bit());
-    if (!dir) {
+bool DefaultFileSystem::refreshLocal(const QUrl &directory, bool onlyScan)
+{
+    const QString path = openLocalDirectory(directory);
+    if (path.isEmpty())
+        return false;
+
+    // Note: we are not using the QDir class here, the local lister is a lot faster
+    LocalLister lister(path);
+    if (!lister.open()) {
         emit error(i18n("Cannot open the folder %1.", path));
         return false;
     }
-
-    // change directory to the new directory
-    const QString savedDir = QDir::currentPath();
-    if (!QDir::setCurrent(path)) {
+    if (!lister.isSearchable()) {
         emit error(i18nc("%1=folder path", "Access to %1 denied", path));
-        QT_CLOSEDIR(dir);
         return false;
     }
 
-    QT_DIRENT *dirEnt;
-    QString name;
-    const bool showHidden = showHiddenFiles();
-    QSet<QString> hiddenFiles = filesInDotHidden(path);
-    while ((dirEnt = QT_READDIR(dir)) != nullptr) {
-        name = QString::fromLocal8Bit(dirEnt->d_name);
-
-        // show hidden files?
-        if (!showHidden && name.left(1) == ".")
-            continue;
-        // show file in .hidden file?
-        if (!showHidden && hiddenFiles.contains(name))
-            continue;
-        // we don't need the "." and ".." entries
-        if (name == "." || name == "..")
-            continue;
-
-        FileItem *temp = createLocalFileItem(name);
-        addFileItem(temp);
-    }
-    // clean up
-    QT_CLOSEDIR(dir);
-    QDir::setCurrent(savedDir);
-
-    if (!onlyScan) {
-        // start watching the new dir for file changes
-        _watcher = new KDirWatch(this);
-        // if the current dir is a link path the watcher needs to watch the real path - and signal
-        // parameters will be the real path
-        _watcher->addDir(realPath(), KDirWatch::WatchFiles);
-        connect(_watcher.data(), &KDirWatch::dirty, this, &DefaultFileSystem::slotWatcherDirty);
-        // NOTE: not connecting 'created' signal. A 'dirty' is send after that anyway
-        // connect(_watcher.data(), &KDirWatch::created, this, &DefaultFileSystem::slotWatcherCreated);
-        connect(_watcher.data(), &KDirWatch::deleted, this, &DefaultFileSystem::slotWatcherDeleted);
-        _watcher->startScan(false);
+    // show hidden files and files in .hidden file?
+    if (!showHiddenFiles())
+        lister.setSkipHidden(filesInDotHidden(path));
+
+    QByteArray encodedName;
+    unsigned char type;
+    while (lister.next(encodedName, type)) {
+        addFileItem(lister.createFileItem(encodedName, type));
+    }
+    if (lister.error()) {
+        emit error(i18n("Cannot read the folder %1.", path));
+        return false;
     }
 
+    if (!onlyScan)
+        startWatcher();
+
     return true;
 }
 
+void DefaultFileSystem::startWatcher()
+{
+    // start watching the new dir for file changes
+    _watcher = new KDirWatch(this);
+    // if the current dir is a link path the watcher needs to watch the real path - and signal
+    // parameters will be the real path
+    _watcher->addDir(realPath(), KDirWatch::WatchFiles);
+    connect(_watcher.data(), &KDirWatch::dirty, this, &DefaultFileSystem::slotWatcherDirty);
+    // NOTE: not connecting 'created' signal. A 'dirty' is send after that anyway
+    // connect(_watcher.data(), &KDirWatch::created, this, &DefaultFileSystem::slotWatcherCreated);
+    connect(_watcher.data(), &KDirWatch::deleted, this, &DefaultFileSystem::slotWatcherDeleted);
+    _watcher->startScan(false);
+}
+
 QSet<QString> DefaultFileSystem::filesInDotHidden(const QString &dir)
 {
     // code "borrowed" from KIO, Copyright (C) by Bruno Nova <brunomb.nova@gmail.com>
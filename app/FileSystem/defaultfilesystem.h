@@ -10,10 +10,13 @@
 #define DEFAULTFILESYSTEM_H
 
 #include "filesystem.h"
+#include "locallister.h"
 
 #include <QFileSystemWatcher>
+#include <QTimer>
 
 #include <KDirWatch>
+#include <KIO/ListJob>
 
 /**
  * @brief Default filesystem implementation supporting all KIO protocols
@@ -27,12 +30,17 @@
  * refreshing the view after own file operations are performed because the detection is to slow
  * (~500ms delay between operation finished and watcher emits signals).
  *
+ * Watcher notifications are collected for a short delay ("Watcher Update Delay") and the current
+ * directory is then listed again in the background. Only the differences to the current file
+ * items are reported to the view, so the view keeps its selection and scroll position.
+ *
  */
 class DefaultFileSystem : public FileSystem
 {
     Q_OBJECT
 public:
     DefaultFileSystem();
+    ~DefaultFileSystem() override;
 
     void copyFiles(const QList<QUrl> &urls,
                    const QUrl &destination,
@@ -61,22 +69,29 @@ public:
     }
     void updateFilesystemInfo() override;
 
-protected:
-    bool refreshInternal(const QUrl &origin, bool onlyScan) override;
     /**
-     * Get the file list from the .hidden file.
+     * Get the file list from the .hidden file. Thread-safe.
      *
      * @param dir the directory containing the .hidden file
      * @return a list containing all files that must be hidden or an empty set
      * if the file cannot be read.
      */
-    QSet<QString> filesInDotHidden(const QString &dir);
+    static QSet<QString> filesInDotHidden(const QString &dir);
+
+protected:
+    bool refreshInternal(const QUrl &origin, bool onlyScan) override;
+    void startRefreshInternal(const QUrl &origin, bool onlyScan) override;
+    void cancelRefreshInternal() override;
 
 protected slots:
     /// Handle result after dir listing job is finished
     void slotListResult(KJob *job);
     /// Fill directory file list with new files from the dir lister
     void slotAddFiles(KIO::Job *job, const KIO::UDSEntryList &entries);
+    /// Fill directory file list with new files from the local list thread
+    void slotListThreadItems();
+    /// Handle result after local list thread is finished
+    void slotListThreadFinished(bool onlyScan);
     /// URL redirection signal from dir lister
     void slotRedirection(KIO::Job *job, const QUrl &url);
     // React to filesystem changes nofified by watcher
@@ -84,9 +99,24 @@ protected slots:
     void slotWatcherCreated(const QString &path);
     void slotWatcherDirty(const QString &path);
     void slotWatcherDeleted(const QString &path);
+    /// Apply the changes collected from the watcher
+    void slotWatcherTimeout();
 
 private:
     bool refreshLocal(const QUrl &directory, bool onlyScan); // NOTE: this is very fast
+    /// Check and (auto)mount a local directory and change to it. Returns the local path or an
+    /// empty string on error.
+    QString openLocalDirectory(const QUrl &directory);
+    /// Start watching the current directory for changes
+    void startWatcher();
+    /// Create and start a list job for the current directory
+    KIO::ListJob *startListJob();
+    /// List the current local directory in the background and apply the differences
+    void startUpdate();
+    /// Apply the differences of the listing of an update
+    void updateFinished(qint64 listTime);
+    /// Stop a running update and forget about collected watcher changes
+    void cancelUpdate();
     FileItem *createLocalFileItem(const QString &name);
     void freeSpaceResult(KJob *job, KIO::filesize_t size, KIO::filesize_t available);
 
@@ -96,6 +126,13 @@ private:
 
     QPointer<KDirWatch> _watcher; // dir watcher used to detect changes in the current dir
     bool _listError; // for async operation, return list job result
+    QPointer<KIO::ListJob> _listJob; // list job of the running asynchronous refresh
+    QPointer<LocalListThread> _listThread; // list thread of the running asynchronous refresh
+    QPointer<LocalListThread> _updateThread; // list thread of the running update
+    QTimer _watcherTimer; // delays the handling of watcher changes
+    bool _watcherDirDirty; // true if the watcher reported a change of the directory itself
+    bool _dirtyWhileRefreshing; // true if the watcher reported a change during an asynchronous refresh
+    QSet<QString> _watcherDirtyFiles; // names of files reported as changed by the watcher
     QString _mountPoint; // the mount point of the current dir
 };
 
@@ -57,11 +57,22 @@ signals:
      * Emitted when a file was added to the list of file items (not by scan).
      */
     void addedFileItem(FileItem *fileItem);
+    /**
+     * Emitted when file items were added while scanning a new directory asynchronously (the list
+     * of file items is complete when scanDone() is emitted) or when several files were added to
+     * the current directory.
+     */
+    void addedFileItems(const QList<FileItem *> &fileItems);
     /**
      * Emitted when a file item (with the same name) was replaced.
      * The old file item will be deleted after this signal.
      */
     void updatedFileItem(FileItem *newFileItem);
+    /**
+     * Emitted when a file item was removed (not by scan).
+     * The file item will be deleted after this signal.
+     */
+    void removedFileItem(FileItem *fileItem);
 };
 
 #endif // DIRLISTERINTERFACE_H
@@ -12,12 +12,16 @@
 #include <QDateTime>
 #include <QMimeDatabase>
 #include <QMimeType>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSet>
 
 #include <KDesktopFile>
 
 #include "../compat.h"
 #include "filesystemprovider.h"
 #include "krpermhandler.h"
+#include "slabpool.h"
 
 bool FileItem::userDefinedFolderIcons = true;
 
@@ -32,8 +36,20 @@ public:
     }
 };
 
-// cache for calculated directory sizes;
+// cache for calculated directory sizes; items are also created in worker threads
 static QCache<const QUrl, FileSize> s_fileSizeCache(1000);
+static QMutex s_fileSizeCacheMutex;
+
+// pool for the file item memory; never deleted, items may be freed while the application exits
+static SlabPool *fileItemPool()
+{
+    static auto *pool = new SlabPool(sizeof(FileItem));
+    return pool;
+}
+
+// table of interned strings, see FileItem::intern()
+static QSet<QString> s_internedStrings;
+static QMutex s_internedStringsMutex;
 
 FileItem::FileItem(const QString &name,
                    const QUrl &url,
@@ -55,37 +71,45 @@ FileItem::FileItem(const QString &name,
                    const QString &defaultAcl)
     : m_name(name)
     , m_url(url)
-    , m_isDir(isDir)
     , m_size(size)
     , m_mode(mode)
+    , m_uid(uid)
+    , m_gid(gid)
     , m_mtime(mtime)
     , m_ctime(ctime)
     , m_atime(atime)
     , m_btime(btime)
-    , m_uid(uid)
-    , m_gid(gid)
-    , m_owner(owner)
-    , m_group(group)
-    , m_isLink(isLink)
     , m_linkDest(linkDest)
-    , m_isBrokenLink(isBrokenLink)
     , m_acl(acl)
     , m_defaulfAcl(defaultAcl)
-    , m_AclLoaded(false)
     , m_mimeType()
     , m_iconName()
+    , m_urlIsParent(false)
+    , m_isDir(isDir)
+    , m_isLink(isLink)
+    , m_isBrokenLink(isBrokenLink)
+    , m_AclLoaded(false)
 {
-    m_permissions = KrPermHandler::mode2QString(mode);
+    // names from the user/group cache are already shared
+    m_owner = owner.isEmpty() ? KrPermHandler::uid2user(m_uid) : intern(owner);
+    m_group = group.isEmpty() ? KrPermHandler::gid2group(m_gid) : intern(group);
 
-    if (m_owner.isEmpty())
-        m_owner = KrPermHandler::uid2user(m_uid);
+    loadCachedSize();
+}
 
-    if (m_group.isEmpty())
-        m_group = KrPermHandler::gid2group(m_gid);
+void *FileItem::operator new(size_t size)
+{
+    SlabPool *pool = fileItemPool();
+    return size <= pool->slotSize() ? pool->allocate() : ::operator new(size);
+}
 
-    if (m_isDir && !m_isLink) {
-        m_size = s_fileSizeCache.contains(m_url) ? s_fileSizeCache[m_url]->m_size : -1;
-    }
+void FileItem::operator delete(void *p, size_t size)
+{
+    SlabPool *pool = fileItemPool();
+    if (size <= pool->slotSize())
+        pool->deallocate(p);
+    else
+        ::operator delete(p);
 }
 
 FileItem *FileItem::createDummy()
@@ -107,6 +131,28 @@ FileItem *FileItem::createVirtualDir(const QString &name, const QUrl &url)
     return new FileItem(name, url, true, 0, 0700, -1, -1, -1, -1, getuid(), getgid());
 }
 
+FileItem *FileItem::createInDirectory(const QString &name,
+                                      const QUrl &directoryUrl,
+                                      bool isDir,
+                                      KIO::filesize_t size,
+                                      mode_t mode,
+                                      time_t mtime,
+                                      time_t ctime,
+                                      time_t atime,
+                                      time_t btime,
+                                      uid_t uid,
+                                      gid_t gid,
+                                      bool isLink,
+                                      const QString &linkDest,
+                                      bool isBrokenLink)
+{
+    auto *file = new FileItem(name, QUrl(), isDir, size, mode, mtime, ctime, atime, btime, uid, gid, QString(), QString(), isLink, linkDest, isBrokenLink);
+    file->m_url = directoryUrl;
+    file->m_urlIsParent = true;
+    file->loadCachedSize();
+    return file;
+}
+
 FileItem *FileItem::createCopy(const FileItem &file, const QString &newName)
 {
     return new FileItem(newName,
@@ -127,34 +173,72 @@ FileItem *FileItem::createCopy(const FileItem &file, const QString &newName)
                         file.isBrokenLink());
 }
 
+QString FileItem::intern(const QString &string)
+{
+    QMutexLocker locker(&s_internedStringsMutex);
+    const auto it = s_internedStrings.constFind(string);
+    if (it != s_internedStrings.constEnd())
+        return *it;
+    s_internedStrings.insert(string);
+    return string;
+}
+
+QUrl FileItem::getUrl() const
+{
+    if (!m_urlIsParent)
+        return m_url;
+
+    QUrl url(m_url);
+    const QString directoryPath = m_url.path();
+    url.setPath(directoryPath.endsWith('/') ? directoryPath + m_name : directoryPath + '/' + m_name);
+    return url;
+}
+
+QString FileItem::getPerm() const
+{
+    return KrPermHandler::mode2QString(m_mode);
+}
+
 char FileItem::isReadable() const
 {
     if (m_uid != (uid_t)-1 && m_gid != (gid_t)-1)
-        return KrPermHandler::readable(m_permissions, m_gid, m_uid);
+        return KrPermHandler::readable(m_mode, m_gid, m_uid);
     else
-        return KrPermHandler::ftpReadable(m_owner, m_url.userName(), m_permissions);
+        return KrPermHandler::ftpReadable(m_owner, m_url.userName(), m_mode);
 }
 
 char FileItem::isWriteable() const
 {
     if (m_uid != (uid_t)-1 && m_gid != (gid_t)-1)
-        return KrPermHandler::writeable(m_permissions, m_gid, m_uid);
+        return KrPermHandler::writeable(m_mode, m_gid, m_uid);
     else
-        return KrPermHandler::ftpWriteable(m_owner, m_url.userName(), m_permissions);
+        return KrPermHandler::ftpWriteable(m_owner, m_url.userName(), m_mode);
 }
 
 char FileItem::isExecutable() const
 {
     if (m_uid != (uid_t)-1 && m_gid != (gid_t)-1)
-        return KrPermHandler::executable(m_permissions, m_gid, m_uid);
+        return KrPermHandler::executable(m_mode, m_gid, m_uid);
     else
-        return KrPermHandler::ftpExecutable(m_owner, m_url.userName(), m_permissions);
+        return KrPermHandler::ftpExecutable(m_owner, m_url.userName(), m_mode);
 }
 
 void FileItem::setSize(KIO::filesize_t size)
 {
     m_size = size;
-    s_fileSizeCache.insert(m_url, new FileSize(size));
+    const QUrl url = getUrl();
+    QMutexLocker locker(&s_fileSizeCacheMutex);
+    s_fileSizeCache.insert(url, new FileSize(size));
+}
+
+void FileItem::loadCachedSize()
+{
+    if (m_isDir && !m_isLink) {
+        const QUrl url = getUrl();
+        QMutexLocker locker(&s_fileSizeCacheMutex);
+        const FileSize *cached = s_fileSizeCache.object(url);
+        m_size = cached ? cached->m_size : -1;
+    }
 }
 
 const QString &FileItem::getMime()
@@ -169,8 +253,8 @@ const QString &FileItem::getMime()
         } else {
             const QMimeDatabase db;
             const QMimeType mt = db.mimeTypeForUrl(getUrl());
-            m_mimeType = mt.isValid() ? mt.name() : "unknown";
-            m_iconName = mt.isValid() ? mt.iconName() : "file-broken";
+            m_mimeType = intern(mt.isValid() ? mt.name() : "unknown");
+            m_iconName = intern(mt.isValid() ? mt.iconName() : "file-broken");
 
             if (m_mimeType == "inode/directory") {
                 // TODO view update needed? and does this ever happen?
@@ -21,6 +21,12 @@
  * A file item gives access all meta information of a (virtual, dummy or real) file or directory in
  * the filesystem.
  *
+ * File items are kept for every file in a directory or search result, so they are kept small:
+ * items in the same directory share the URL of the directory, the file URL is built on demand.
+ * Owner, group, mime type and icon names are interned and the permission string is derived from
+ * the mode. The memory of file items is taken from a slab pool, so the items deleted by a refresh
+ * are reused for the new listing.
+ *
  * NOTE: The name of a file item is supposed to be unique within a directory.
  */
 class FileItem
@@ -74,6 +80,10 @@ public:
              const QString &acl = QString(),
              const QString &defaultAcl = QString());
 
+    /** File items are allocated from a shared pool, see SlabPool. */
+    static void *operator new(size_t size);
+    static void operator delete(void *p, size_t size);
+
     /** Create a new ".." dummy file item. */
     static FileItem *createDummy();
     /** Create a file item for a broken file which metadata could not be read. */
@@ -82,6 +92,26 @@ public:
     static FileItem *createVirtualDir(const QString &name, const QUrl &url);
     /** Create a new file item copy with a different name. */
     static FileItem *createCopy(const FileItem &file, const QString &newName);
+    /**
+     * Create a new file item for a file inside a directory. The file URL is the directory URL
+     * with the name appended. See constructor for the other parameters.
+     *
+     * @param directoryUrl the URL of the directory, should be shared by all items in the directory
+     */
+    static FileItem *createInDirectory(const QString &name,
+                                       const QUrl &directoryUrl,
+                                       bool isDir,
+                                       KIO::filesize_t size,
+                                       mode_t mode,
+                                       time_t mtime,
+                                       time_t ctime,
+                                       time_t atime,
+                                       time_t btime,
+                                       uid_t uid,
+                                       gid_t gid,
+                                       bool isLink,
+                                       const QString &linkDest,
+                                       bool isBrokenLink);
 
     // following functions give-out file details
     inline const QString &getName() const
@@ -98,10 +128,8 @@ public:
     {
         return m_size;
     }
-    inline const QString &getPerm() const
-    {
-        return m_permissions;
-    }
+    /** Return the permission string, e.g. "drwxr-xr-x". */
+    QString getPerm() const;
     /** Return true if the file is a directory or a symlink to a directory, otherwise false. */
     inline bool isDir() const
     {
@@ -143,10 +171,7 @@ public:
     {
         return m_btime;
     }
-    inline const QUrl &getUrl() const
-    {
-        return m_url;
-    }
+    QUrl getUrl() const;
     inline const QString &getOwner() const
     {
         return m_owner;
@@ -177,43 +202,51 @@ public:
         userDefinedFolderIcons = load;
     }
 
+    /**
+     * Return a shared copy of a string. Used for strings which are the same for many file
+     * items. Thread-safe.
+     */
+    static QString intern(const QString &string);
+
 private:
     void setIconName(const QString &icon)
     {
-        m_iconName = icon;
-        m_mimeType = "?";
+        m_iconName = intern(icon);
+        m_mimeType = intern("?");
     }
     void loadACL();
+    void loadCachedSize();
 
     QString m_name; //< file name
-    QUrl m_url; //< file URL
-    bool m_isDir; //< flag, true if it's a directory
+    QUrl m_url; //< file URL or URL of the parent directory if m_urlIsParent is set
 
     KIO::filesize_t m_size; //< file size
     mode_t m_mode; //< file mode (file type and permissions)
 
+    uid_t m_uid; //< file owner id
+    gid_t m_gid; //< file group id
+
     time_t m_mtime; //< file modification time
     time_t m_ctime; //< file change time
     time_t m_atime; //< file access time
     time_t m_btime; //< file creation time
 
-    uid_t m_uid; //< file owner id
-    gid_t m_gid; //< file group id
-    QString m_owner; //< file owner name
-    QString m_group; //< file group name
+    QString m_owner; //< file owner name, interned
+    QString m_group; //< file group name, interned
 
-    bool m_isLink; //< true if the file is a symlink
     QString m_linkDest; //< if it's a symlink - its destination
-    bool m_isBrokenLink; //< true if the link destination does not exist
-
-    QString m_permissions; //< file permissions string
 
     QString m_acl; //< ACL permission string, may lazy initialized
     QString m_defaulfAcl; //< ACL default string, may lazy initialized
-    bool m_AclLoaded; //< flag, indicates that ACL permissions already loaded
 
-    QString m_mimeType; //< file mimetype, lazy initialized
-    QString m_iconName; //< the name of the icon file, lazy initialized
+    QString m_mimeType; //< file mimetype, lazy initialized and interned
+    QString m_iconName; //< the name of the icon file, lazy initialized and interned
+
+    bool m_urlIsParent; //< true if m_url is the URL of the parent directory
+    bool m_isDir; //< flag, true if it's a directory
+    bool m_isLink; //< true if the file is a symlink
+    bool m_isBrokenLink; //< true if the link destination does not exist
+    bool m_AclLoaded; //< flag, indicates that ACL permissions already loaded
 
     static bool userDefinedFolderIcons;
 };
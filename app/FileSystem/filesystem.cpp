@@ -8,6 +8,7 @@
 
 #include "filesystem.h"
 
+#include <fcntl.h>
 #include <memory>
 
 // QtCore
@@ -27,15 +28,19 @@
 #include "../krglobal.h"
 #include "fileitem.h"
 #include "krpermhandler.h"
+#include "locallister.h"
 
 FileSystem::FileSystem()
     : DirListerInterface(nullptr)
     , _isRefreshing(false)
+    , _dirChange(false)
+    , _isAsyncRefresh(false)
 {
 }
 
 FileSystem::~FileSystem()
 {
+    clear(_oldFileItems);
     clear(_fileItems);
     // please don't remove this line. This informs the view about deleting the file items.
     emit cleared();
@@ -89,11 +94,60 @@ QUrl FileSystem::preferLocalUrl(const QUrl &url)
 }
 
 bool FileSystem::scanOrRefresh(const QUrl &directory, bool onlyScan)
+{
+    const QUrl toRefresh = beginRefresh(directory);
+    if (toRefresh.isEmpty())
+        return false;
+
+    _isAsyncRefresh = false;
+    const bool refreshed = refreshInternal(toRefresh, onlyScan);
+    return endRefresh(refreshed);
+}
+
+bool FileSystem::refreshAsync(const QUrl &directory)
+{
+    const QUrl toRefresh = beginRefresh(directory);
+    if (toRefresh.isEmpty())
+        return false;
+
+    _isAsyncRefresh = true;
+    startRefreshInternal(toRefresh, false);
+    return true;
+}
+
+void FileSystem::cancelRefresh()
+{
+    if (!_isRefreshing || !_isAsyncRefresh)
+        return;
+
+    cancelRefreshInternal();
+    _isAsyncRefresh = false;
+    endRefresh(false);
+}
+
+void FileSystem::startRefreshInternal(const QUrl &origin, bool onlyScan)
+{
+    finishRefresh(refreshInternal(origin, onlyScan));
+}
+
+void FileSystem::finishRefresh(bool succeeded)
+{
+    if (!_isRefreshing || !_isAsyncRefresh) {
+        // canceled or blocking refresh
+        return;
+    }
+
+    _isAsyncRefresh = false;
+    endRefresh(succeeded);
+    emit refreshFinished(succeeded);
+}
+
+QUrl FileSystem::beginRefresh(const QUrl &directory)
 {
     qDebug() << "from current dir=" << _currentDirectory.toDisplayString() << "; to=" << directory.toDisplayString();
     if (_isRefreshing) {
-        // NOTE: this does not happen (unless async)";
-        return false;
+        // NOTE: this happens if a refresh is requested while refreshing async
+        return QUrl();
     }
 
     // workaround for krarc: find out if transition to local fs is wanted and adjust URL manually
@@ -102,36 +156,40 @@ bool FileSystem::scanOrRefresh(const QUrl &directory, bool onlyScan)
         url.setScheme("file");
     }
 
-    const bool dirChange = !url.isEmpty() && cleanUrl(url) != _currentDirectory;
+    _dirChange = !url.isEmpty() && cleanUrl(url) != _currentDirectory;
 
-    const QUrl toRefresh = dirChange ? url.adjusted(QUrl::NormalizePathSegments) : _currentDirectory;
+    const QUrl toRefresh = _dirChange ? url.adjusted(QUrl::NormalizePathSegments) : _currentDirectory;
     if (!toRefresh.isValid()) {
         emit error(i18n("Malformed URL:\n%1", toRefresh.toDisplayString()));
-        return false;
+        return QUrl();
     }
 
     _isRefreshing = true;
 
-    FileItemDict tempFileItems(_fileItems); // old file items are still used during refresh
+    _oldFileItems = _fileItems; // old file items are still used during refresh
     _fileItems.clear();
-    if (dirChange)
+    if (_dirChange)
         // show an empty directory while loading the new one and clear selection
         emit cleared();
 
-    const bool refreshed = refreshInternal(toRefresh, onlyScan);
+    return toRefresh;
+}
+
+bool FileSystem::endRefresh(bool succeeded)
+{
     _isRefreshing = false;
 
-    if (!refreshed) {
+    if (!succeeded) {
         // cleanup and abort
-        if (!dirChange)
+        if (!_dirChange)
             emit cleared();
-        clear(tempFileItems);
+        clear(_oldFileItems);
         return false;
     }
 
-    emit scanDone(dirChange);
+    emit scanDone(_dirChange);
 
-    clear(tempFileItems);
+    clear(_oldFileItems);
 
     updateFilesystemInfo();
 
@@ -193,63 +251,82 @@ void FileSystem::addFileItem(FileItem *item)
     _fileItems.insert(item->getName(), item);
 }
 
-FileItem *FileSystem::createLocalFileItem(const QString &name, const QString &directory, bool virt)
+void FileSystem::addFileItems(const QList<FileItem *> &items)
 {
-    const QDir dir = QDir(directory);
-    const QString path = dir.filePath(name);
-    const QByteArray pathByteArray = path.toLocal8Bit();
-    const QString fileItemName = virt ? path : name;
-    const QUrl fileItemUrl = QUrl::fromLocalFile(path);
-
-    // read file status; in case of error create a "broken" file item
-    QT_STATBUF stat_p;
-    memset(&stat_p, 0, sizeof(stat_p));
-    if (QT_LSTAT(pathByteArray.data(), &stat_p) < 0)
-        return FileItem::createBroken(fileItemName, fileItemUrl);
-
-    const KIO::filesize_t size = stat_p.st_size;
-    bool isDir = S_ISDIR(stat_p.st_mode);
-    const bool isLink = S_ISLNK(stat_p.st_mode);
+    for (FileItem *item : items) {
+        addFileItem(item);
+    }
+    // when refreshing the current directory the view still shows the old items until scan is done
+    if (_isAsyncRefresh && _dirChange && !items.isEmpty()) {
+        emit addedFileItems(items);
+    }
+}
 
-    // for links, read link destination and determine whether it's broken or not
-    QString linkDestination;
-    bool brokenLink = false;
-    if (isLink) {
-        linkDestination = readLinkSafely(pathByteArray.data());
+/// Return true if the file status of both file items is the same
+static bool hasSameStatus(const FileItem *fileItem, const FileItem *other)
+{
+    return fileItem->getModificationTime() == other->getModificationTime() && fileItem->getChangeTime() == other->getChangeTime()
+        && fileItem->getUISize() == other->getUISize() && fileItem->getMode() == other->getMode() && fileItem->getOwner() == other->getOwner()
+        && fileItem->getGroup() == other->getGroup() && fileItem->isDir() == other->isDir() && fileItem->isBrokenLink() == other->isBrokenLink()
+        && fileItem->getSymDest() == other->getSymDest();
+}
 
-        if (linkDestination.isNull()) {
-            brokenLink = true;
+int FileSystem::updateFileItems(const QList<FileItem *> &newItems)
+{
+    int changes = 0;
+
+    QList<FileItem *> addedItems;
+    FileItemDict removedItems = _fileItems;
+    for (FileItem *newItem : newItems) {
+        const QString name = newItem->getName();
+        FileItem *oldItem = removedItems.take(name);
+        if (!oldItem) {
+            addFileItem(newItem);
+            addedItems << newItem;
+            ++changes;
+        } else if (!hasSameStatus(oldItem, newItem)) {
+            addFileItem(newItem);
+            emit updatedFileItem(newItem);
+            delete oldItem;
+            ++changes;
         } else {
-            const QFileInfo linkFile(dir, linkDestination);
-            if (!linkFile.exists())
-                brokenLink = true;
-            else if (linkFile.isDir())
-                isDir = true;
+            delete newItem;
         }
     }
 
-    // TODO use statx available in glibc >= 2.28 supporting creation time (btime) and more
-
-    // create normal file item
-    return new FileItem(fileItemName,
-                        fileItemUrl,
-                        isDir,
-                        size,
-                        stat_p.st_mode,
-                        stat_p.st_mtime,
-                        stat_p.st_ctime,
-                        stat_p.st_atime,
-                        -1,
-                        stat_p.st_uid,
-                        stat_p.st_gid,
-                        QString(),
-                        QString(),
-                        isLink,
-                        linkDestination,
-                        brokenLink);
+    for (FileItem *oldItem : qAsConst(removedItems)) {
+        _fileItems.remove(oldItem->getName());
+        emit removedFileItem(oldItem);
+        delete oldItem;
+        ++changes;
+    }
+
+    // new files are inserted into the view at once, e.g. after extracting an archive
+    if (!addedItems.isEmpty())
+        emit addedFileItems(addedItems);
+
+    if (changes > 0)
+        updateFilesystemInfo();
+
+    return changes;
+}
+
+FileItem *FileSystem::createLocalFileItem(const QString &name, const QString &directory, bool virt)
+{
+    const QString path = QDir(directory).filePath(name);
+    const QByteArray pathByteArray = path.toLocal8Bit();
+    const QString fileItemName = virt ? path : name;
+    const QUrl fileItemUrl = QUrl::fromLocalFile(path);
+
+    return LocalLister::createFileItem(AT_FDCWD, pathByteArray.constData(), fileItemName, fileItemUrl);
 }
 
 QString FileSystem::readLinkSafely(const char *path)
+{
+    return readLinkSafely(AT_FDCWD, path);
+}
+
+QString FileSystem::readLinkSafely(int dirFd, const char *path)
 {
     // inspired by the areadlink_with_size function from gnulib, which is used for coreutils
     // idea: start with a small buffer and gradually increase it as we discover it wasn't enough
@@ -260,7 +337,7 @@ QString FileSystem::readLinkSafely(const char *path)
     while (true) {
         // try to read the link
         std::unique_ptr<char[]> buffer(new char[bufferSize]);
-        auto nBytesRead = readlink(path, buffer.get(), bufferSize);
+        auto nBytesRead = readlinkat(dirFd, path, buffer.get(), bufferSize);
 
         // should never happen, asserted by the readlink
         if (nBytesRead > bufferSize) {
@@ -342,7 +419,7 @@ void FileSystem::slotJobResult(KJob *job, bool refresh)
     }
 
     if (refresh) {
-        FileSystem::refresh();
+        refreshAsync();
     }
 }
 
@@ -129,6 +129,19 @@ public:
         return scanOrRefresh(directory, false);
     }
 
+    /**
+     * Change or refresh the current directory and scan it. Not blocking.
+     *
+     * When changing to another directory, the new file items are reported in batches with
+     * addedFileItems() while scanning. When refreshing the current directory the old file items
+     * are kept until the scan is done. refreshFinished() is emitted in both cases.
+     *
+     * @return true if the refresh was started, else false and refreshFinished() is not emitted.
+     */
+    bool refreshAsync(const QUrl &directory = QUrl());
+    /// Abort a running refresh. refreshFinished() is not emitted for an aborted refresh.
+    void cancelRefresh();
+
     /// Returns the current directory path of this filesystem.
     inline QUrl currentDirectory() const
     {
@@ -181,6 +194,8 @@ public:
 
     /// Read a symlink with an extra precaution
     static QString readLinkSafely(const char *path);
+    /// Read a symlink relative to a directory file descriptor with an extra precaution
+    static QString readLinkSafely(int dirFd, const char *path);
 
     /// Set the parent window to be used for dialogs
     void setParentWindow(QWidget *widget)
@@ -203,10 +218,21 @@ signals:
     void fileSystemInfoChanged(const QString &metaInfo, const QString &fsType, KIO::filesize_t total, KIO::filesize_t free);
     /// Emitted before a directory path is opened for reading. Used for automounting.
     void aboutToOpenDir(const QString &path);
+    /// Emitted when an asynchronous refresh is done. If succeeded, scanDone() was emitted before.
+    void refreshFinished(bool succeeded);
 
 protected:
     /// Fill the filesystem dictionary with file items, must be implemented for each filesystem.
     virtual bool refreshInternal(const QUrl &origin, bool stayInDir) = 0;
+    /// Start filling the filesystem dictionary with file items without blocking. Implementations
+    /// must call finishRefresh() when done. The default implementation is blocking.
+    virtual void startRefreshInternal(const QUrl &origin, bool onlyScan);
+    /// Stop a refresh started with startRefreshInternal(). The default implementation does nothing.
+    virtual void cancelRefreshInternal()
+    {
+    }
+    /// Finish a refresh started with startRefreshInternal()
+    void finishRefresh(bool succeeded);
 
     /// Connect the result signal of a file operation job - source URLs.
     void connectJobToSources(KJob *job, const QList<QUrl> &urls);
@@ -216,6 +242,17 @@ protected:
     bool showHiddenFiles();
     /// Add a new file item to the internal dictionary (while refreshing).
     void addFileItem(FileItem *item);
+    /// Add new file items to the internal dictionary (while refreshing) and notify the view about
+    /// them if a new directory is scanned asynchronously.
+    void addFileItems(const QList<FileItem *> &items);
+    /**
+     * Update the file items of the current directory to a new listing of it (not while
+     * refreshing). Only added, removed and changed file items are replaced and reported to the
+     * view. Takes ownership of the new file items.
+     *
+     * @return the number of added, removed and changed file items
+     */
+    int updateFileItems(const QList<FileItem *> &newItems);
 
     FS_TYPE _type; // the filesystem type.
     QUrl _currentDirectory; // the path or file the filesystem originates from.
@@ -229,13 +266,20 @@ protected slots:
 private:
     typedef QHash<QString, FileItem *> FileItemDict;
 
-    // optional TODO: add an async version of this
     bool scanOrRefresh(const QUrl &directory, bool onlyScan);
+    /// Prepare the refresh: check the URL and put the old file items aside.
+    /// Returns the URL to refresh or an invalid URL if the refresh should not be done.
+    QUrl beginRefresh(const QUrl &directory);
+    /// Finish the refresh: delete the old file items and emit the result
+    bool endRefresh(bool succeeded);
 
     /// Delete and clear file items.
     void clear(FileItemDict &fileItems);
 
     FileItemDict _fileItems; // the list of files in the current dictionary
+    FileItemDict _oldFileItems; // the previous file items, still used while refreshing
+    bool _dirChange; // true if refreshing changes to another directory
+    bool _isAsyncRefresh; // true if refresh was started with refreshAsync()
 };
 
 #endif
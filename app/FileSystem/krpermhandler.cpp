@@ -98,66 +98,72 @@ void KrPermHandler::init()
     currentGroups.insert(getegid());
 }
 
-char KrPermHandler::readable(const QString &perm, gid_t gid, uid_t uid)
+// the mode bits for the read, write and execute permission of user, group and others. Same as in
+// mode2QString(), the set-id and sticky bits are counted as execute permission
+static const mode_t userPermBits[] = {0400, 0200, 0100 | 04000};
+static const mode_t groupPermBits[] = {0040, 0020, 0010 | 02000};
+static const mode_t otherPermBits[] = {0004, 0002, 0001 | 01000};
+
+char KrPermHandler::readable(mode_t mode, gid_t gid, uid_t uid)
 {
-    return getLocalPermission(perm, gid, uid, 0);
+    return getLocalPermission(mode, gid, uid, 0);
 }
 
-char KrPermHandler::writeable(const QString &perm, gid_t gid, uid_t uid)
+char KrPermHandler::writeable(mode_t mode, gid_t gid, uid_t uid)
 {
-    return getLocalPermission(perm, gid, uid, 1);
+    return getLocalPermission(mode, gid, uid, 1);
 }
 
-char KrPermHandler::executable(const QString &perm, gid_t gid, uid_t uid)
+char KrPermHandler::executable(mode_t mode, gid_t gid, uid_t uid)
 {
-    return getLocalPermission(perm, gid, uid, 2, true);
+    return getLocalPermission(mode, gid, uid, 2, true);
 }
 
-char KrPermHandler::getLocalPermission(const QString &perm, gid_t gid, uid_t uid, int permOffset, bool ignoreRoot)
+char KrPermHandler::getLocalPermission(mode_t mode, gid_t gid, uid_t uid, int permOffset, bool ignoreRoot)
 {
     // root override
     if (!ignoreRoot && getuid() == 0)
         return ALLOWED_PERM;
     // first check other permissions.
-    if (perm[7 + permOffset] != '-')
+    if (mode & otherPermBits[permOffset])
         return ALLOWED_PERM;
     // now check group permission
-    if ((perm[4 + permOffset] != '-') && currentGroups.contains(gid))
+    if ((mode & groupPermBits[permOffset]) && currentGroups.contains(gid))
         return ALLOWED_PERM;
     // the last chance - user permissions
-    if ((perm[1 + permOffset] != '-') && (uid == getuid()))
+    if ((mode & userPermBits[permOffset]) && (uid == getuid()))
         return ALLOWED_PERM;
     // sorry !
     return NO_PERM;
 }
 
-char KrPermHandler::ftpReadable(const QString &fileOwner, const QString &userName, const QString &perm)
+char KrPermHandler::ftpReadable(const QString &fileOwner, const QString &userName, mode_t mode)
 {
-    return getFtpPermission(fileOwner, userName, perm, 0);
+    return getFtpPermission(fileOwner, userName, mode, 0);
 }
 
-char KrPermHandler::ftpWriteable(const QString &fileOwner, const QString &userName, const QString &perm)
+char KrPermHandler::ftpWriteable(const QString &fileOwner, const QString &userName, mode_t mode)
 {
-    return getFtpPermission(fileOwner, userName, perm, 1);
+    return getFtpPermission(fileOwner, userName, mode, 1);
 }
 
-char KrPermHandler::ftpExecutable(const QString &fileOwner, const QString &userName, const QString &perm)
+char KrPermHandler::ftpExecutable(const QString &fileOwner, const QString &userName, mode_t mode)
 {
-    return getFtpPermission(fileOwner, userName, perm, 2);
+    return getFtpPermission(fileOwner, userName, mode, 2);
 }
 
-char KrPermHandler::getFtpPermission(const QString &fileOwner, const QString &userName, const QString &perm, int permOffset)
+char KrPermHandler::getFtpPermission(const QString &fileOwner, const QString &userName, mode_t mode, int permOffset)
 {
     // first check other permissions.
-    if (perm[7 + permOffset] != '-')
+    if (mode & otherPermBits[permOffset])
         return ALLOWED_PERM;
     // can't check group permission !
     // so check the user permissions
-    if ((perm[1 + permOffset] != '-') && (fileOwner == userName))
+    if ((mode & userPermBits[permOffset]) && (fileOwner == userName))
         return ALLOWED_PERM;
-    if ((perm[1 + permOffset] != '-') && (userName.isEmpty()))
+    if ((mode & userPermBits[permOffset]) && (userName.isEmpty()))
         return UNKNOWN_PERM;
-    if (perm[4 + permOffset] != '-')
+    if (mode & groupPermBits[permOffset])
         return UNKNOWN_PERM;
     return NO_PERM;
 }
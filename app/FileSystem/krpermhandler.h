@@ -33,13 +33,13 @@ public:
     static QString gid2group(gid_t groupId);
     static QString uid2user(uid_t userId);
 
-    static char writeable(const QString &perm, gid_t gid, uid_t uid);
-    static char readable(const QString &perm, gid_t gid, uid_t uid);
-    static char executable(const QString &perm, gid_t gid, uid_t uid);
+    static char writeable(mode_t mode, gid_t gid, uid_t uid);
+    static char readable(mode_t mode, gid_t gid, uid_t uid);
+    static char executable(mode_t mode, gid_t gid, uid_t uid);
 
-    static char ftpWriteable(const QString &fileOwner, const QString &userName, const QString &perm);
-    static char ftpReadable(const QString &fileOwner, const QString &userName, const QString &perm);
-    static char ftpExecutable(const QString &fileOwner, const QString &userName, const QString &perm);
+    static char ftpWriteable(const QString &fileOwner, const QString &userName, mode_t mode);
+    static char ftpReadable(const QString &fileOwner, const QString &userName, mode_t mode);
+    static char ftpExecutable(const QString &fileOwner, const QString &userName, mode_t mode);
 
     static QString mode2QString(mode_t m);
     static QString parseSize(KIO::filesize_t val);
@@ -48,8 +48,8 @@ private:
     KrPermHandler()
     {
     }
-    static char getLocalPermission(const QString &perm, gid_t gid, uid_t uid, int permOffset, bool ignoreRoot = false);
-    static char getFtpPermission(const QString &fileOwner, const QString &userName, const QString &perm, int permOffset);
+    static char getLocalPermission(mode_t mode, gid_t gid, uid_t uid, int permOffset, bool ignoreRoot = false);
+    static char getFtpPermission(const QString &fileOwner, const QString &userName, mode_t mode, int permOffset);
 
     static QSet<int> currentGroups;
     static QHash<int, QString> uidCache;
@@ -19,6 +19,7 @@
 #include <KIO/Job>
 #include <KLocalizedString>
 #include <KUrlCompletion>
+#include <cstring>
 #include <utility>
 
 #include "../Archive/krarchandler.h"
@@ -28,6 +29,17 @@
 
 #define STATUS_SEND_DELAY 250
 #define MAX_LINE_LEN 1000
+#define READ_BUFFER_SIZE (1024 * 1024)
+
+/// Return the position of the last @p c in @p data or -1
+static qint64 lastIndexOf(const char *data, qint64 length, char c)
+{
+    for (qint64 i = length - 1; i >= 0; --i) {
+        if (data[i] == c)
+            return i;
+    }
+    return -1;
+}
 
 // set the defaults
 KrQuery::KrQuery()
@@ -53,11 +65,7 @@ KrQuery::KrQuery()
     , processEventsConnected(0)
     , codec(QTextCodec::codecForLocale())
 {
-    QChar ch = '\n';
-    QTextCodec::ConverterState state(QTextCodec::IgnoreHeader);
-    encodedEnterArray = codec->fromUnicode(&ch, 1, &state);
-    encodedEnter = encodedEnterArray.data();
-    encodedEnterLen = encodedEnterArray.size();
+    prepareContentSearch();
 }
 
 // set the defaults
@@ -83,11 +91,7 @@ KrQuery::KrQuery(const QString &name, bool matchCase)
     , processEventsConnected(0)
     , codec(QTextCodec::codecForLocale())
 {
-    QChar ch = '\n';
-    QTextCodec::ConverterState state(QTextCodec::IgnoreHeader);
-    encodedEnterArray = codec->fromUnicode(&ch, 1, &state);
-    encodedEnter = encodedEnterArray.data();
-    encodedEnterLen = encodedEnterArray.size();
+    prepareContentSearch();
 
     setNameFilter(name, matchCase);
 }
@@ -143,6 +147,11 @@ KrQuery &KrQuery::operator=(const KrQuery &old)
     encodedEnter = encodedEnterArray.data();
     encodedEnterLen = encodedEnterArray.size();
 
+    // the compiled regular expression is shared
+    containRegularExpression = old.containRegularExpression;
+    asciiCompatibleCodec = old.asciiCompatibleCodec;
+    contentSearcher = old.contentSearcher;
+
     return *this;
 }
 
@@ -183,12 +192,10 @@ void KrQuery::load(const KConfigGroup &cfg)
     codec = QTextCodec::codecForName(cfg.readEntry("Codec", codec->name()));
     if (!codec)
         codec = QTextCodec::codecForLocale();
-
-    LOAD("EncodedEnterArray", encodedEnterArray);
-    encodedEnter = encodedEnterArray.data();
-    encodedEnterLen = encodedEnterArray.size();
 #undef LOAD
 
+    prepareContentSearch();
+
     bNull = false;
 }
 
@@ -436,11 +443,19 @@ bool KrQuery::checkBuffer(const char *data, int len) const
 bool KrQuery::checkLine(const QString &line, bool backwards) const
 {
     if (containRegExp) {
-        QRegExp rexp(contain, containCaseSensetive ? Qt::CaseSensitive : Qt::CaseInsensitive, QRegExp::RegExp);
-        int ndx = backwards ? rexp.lastIndexIn(line) : rexp.indexIn(line);
-        bool result = ndx >= 0;
+        QRegularExpressionMatch match;
+        if (backwards) {
+            QRegularExpressionMatchIterator it = containRegularExpression.globalMatch(line);
+            while (it.hasNext())
+                match = it.next();
+        } else {
+            match = containRegularExpression.match(line);
+        }
+        const bool result = match.hasMatch();
         if (result)
-            fixFoundTextForDisplay(lastSuccessfulGrep = line, lastSuccessfulGrepMatchIndex = ndx, lastSuccessfulGrepMatchLength = rexp.matchedLength());
+            fixFoundTextForDisplay(lastSuccessfulGrep = line,
+                                   lastSuccessfulGrepMatchIndex = match.capturedStart(),
+                                   lastSuccessfulGrepMatchLength = match.capturedLength());
         return result;
     }
 
@@ -484,22 +499,110 @@ bool KrQuery::checkLine(const QString &line, bool backwards) const
 bool KrQuery::containsContent(const QString &file) const
 {
     QFile qf(file);
-    if (!qf.open(QIODevice::ReadOnly))
+    if (!qf.open(QIODevice::ReadOnly | QIODevice::Unbuffered))
+        return false;
+
+    if (!asciiCompatibleCodec)
+        return containsDecodedContent(qf);
+
+    // complete lines are searched in large blocks, the rest of the last line is moved to the
+    // beginning of the buffer and searched with the next block
+    QByteArray buffer(READ_BUFFER_SIZE, Qt::Uninitialized);
+    char *data = buffer.data();
+    qint64 filled = 0;
+    bool atEnd = false;
+    while (!atEnd) {
+        const qint64 bytes = qf.read(data + filled, READ_BUFFER_SIZE - filled);
+        atEnd = bytes <= 0;
+        if (!atEnd) {
+            filled += bytes;
+            receivedBytes += static_cast<KIO::filesize_t>(bytes);
+        }
+
+        qint64 end = filled; // the bytes searched now
+        qint64 overlap = 0; // the searched bytes searched again with the next block
+        if (!atEnd) {
+            end = lastIndexOf(data, filled, '\n') + 1;
+            if (end == 0 && filled == READ_BUFFER_SIZE) {
+                // very long line: search all of it, its end can be the beginning of a match
+                end = filled;
+                overlap = contentSearcher.isEmpty() ? MAX_LINE_LEN : contentSearcher.patternLength() - 1;
+            }
+        }
+
+        if (end > 0) {
+            if (checkBlock(data, end))
+                return true;
+            memmove(data, data + end - overlap, static_cast<size_t>(filled - end + overlap));
+            filled -= end - overlap;
+        }
+
+        if (checkTimer()) {
+            bool stopped = false;
+            emit(const_cast<KrQuery *>(this))->processEvents(stopped);
+            if (stopped)
+                return false;
+        }
+    }
+
+    lastSuccessfulGrep.clear(); // nothing was found
+    return false;
+}
+
+bool KrQuery::checkBlock(const char *data, qint64 length) const
+{
+    if (!contentSearcher.isEmpty()) {
+        // find the content in the raw bytes and decode only the line of a match
+        qint64 pos = 0;
+        while (pos < length) {
+            const qint64 found = contentSearcher.indexIn(data + pos, length - pos);
+            if (found < 0)
+                return false;
+            const qint64 match = pos + found;
+
+            qint64 lineStart = match;
+            const qint64 minLineStart = qMax<qint64>(0, match - MAX_LINE_LEN);
+            while (lineStart > minLineStart && data[lineStart - 1] != '\n')
+                --lineStart;
+            const auto *enter = static_cast<const char *>(memchr(data + match, '\n', static_cast<size_t>(length - match)));
+            const qint64 lineEnd = enter ? enter - data : length;
+            const qint64 shownEnd = qMin(lineEnd, match + contentSearcher.patternLength() + MAX_LINE_LEN);
+
+            // the decoded line decides, e.g. for whole words
+            if (checkLine(codec->toUnicode(data + lineStart, static_cast<int>(shownEnd - lineStart))))
+                return true;
+            pos = shownEnd == lineEnd ? lineEnd + 1 : match + 1;
+        }
         return false;
+    }
 
-    char buffer[1440]; // 2k buffer
+    // regular expression or content which can only be compared decoded: check each line
+    qint64 lineStart = 0;
+    while (lineStart < length) {
+        const auto *enter = static_cast<const char *>(memchr(data + lineStart, '\n', static_cast<size_t>(length - lineStart)));
+        const qint64 lineEnd = enter ? enter - data : length;
+        if (checkLine(codec->toUnicode(data + lineStart, static_cast<int>(lineEnd - lineStart))))
+            return true;
+        lineStart = lineEnd + 1;
+    }
+    return false;
+}
+
+bool KrQuery::containsDecodedContent(QFile &qf) const
+{
+    QByteArray buffer(READ_BUFFER_SIZE, Qt::Uninitialized);
 
     while (!qf.atEnd()) {
         // Note: As it's stated in the documentation, "`qint64 QIODevice::read(char *data,
         // qint64 maxSize)` Reads at most `maxSize` bytes"
-        int bytes = static_cast<int>(qf.read(buffer, sizeof(buffer)));
+        int bytes = static_cast<int>(qf.read(buffer.data(), buffer.size()));
 
         if (bytes <= 0)
             break;
 
         receivedBytes += bytes;
 
-        if (checkBuffer(buffer, bytes))
+        if (checkBuffer(buffer.constData(), bytes))
             return true;
 
         if (checkTimer()) {
@@ -509,7 +612,7 @@ bool KrQuery::containsContent(const QString &file) const
                 return false;
         }
     }
-    if (checkBuffer(buffer, 0))
+    if (checkBuffer(buffer.constData(), 0))
         return true;
 
     lastSuccessfulGrep.clear(); // nothing was found
@@ -695,11 +798,44 @@ void KrQuery::setContent(const QString &content, bool cs, bool wholeWord, const
             codec = QTextCodec::codecForLocale();
     }
 
+    prepareContentSearch();
+}
+
+void KrQuery::prepareContentSearch()
+{
     QChar ch = '\n';
     QTextCodec::ConverterState state(QTextCodec::IgnoreHeader);
     encodedEnterArray = codec->fromUnicode(&ch, 1, &state);
     encodedEnter = encodedEnterArray.data();
     encodedEnterLen = encodedEnterArray.size();
+
+    containRegularExpression = QRegularExpression(containRegExp ? contain : QString(),
+                                                  containCaseSensetive ? QRegularExpression::NoPatternOption : QRegularExpression::CaseInsensitiveOption);
+    if (containRegExp)
+        containRegularExpression.optimize();
+
+    // raw bytes can be searched if the encoding has no shift states and ASCII is encoded as is
+    const QString asciiText = QStringLiteral("\n\t azAZ09.~");
+    QTextCodec::ConverterState asciiState(QTextCodec::IgnoreHeader);
+    const QByteArray codecName = codec->name();
+    asciiCompatibleCodec = codec->fromUnicode(asciiText.constData(), asciiText.length(), &asciiState) == asciiText.toLatin1()
+        && !codecName.contains("2022") && !codecName.startsWith("UTF-7") && !codecName.startsWith("HZ");
+
+    // only ASCII letters can be compared ignoring the case in raw bytes
+    bool asciiContent = true;
+    for (const QChar &c : qAsConst(contain)) {
+        if (c.unicode() >= 0x80) {
+            asciiContent = false;
+            break;
+        }
+    }
+
+    if (!contain.isEmpty() && !containRegExp && asciiCompatibleCodec && (containCaseSensetive || asciiContent)) {
+        QTextCodec::ConverterState contentState(QTextCodec::IgnoreHeader);
+        contentSearcher = ByteSearcher(codec->fromUnicode(contain.constData(), contain.length(), &contentState), containCaseSensetive);
+    } else {
+        contentSearcher = ByteSearcher();
+    }
 }
 
 void KrQuery::setMinimumFileSize(KIO::filesize_t minimumSize)
@@ -11,12 +11,16 @@
 // QtCore
 #include <QDateTime>
 #include <QElapsedTimer>
+#include <QRegularExpression>
 #include <QStringList>
 #include <QUrl>
 
 #include <KConfigGroup>
 #include <KIO/Job>
 
+#include "bytesearcher.h"
+
+class QFile;
 class QTextCodec;
 
 class FileItem;
@@ -236,7 +240,13 @@ private:
     bool checkType(const QString &mime) const;
     bool containsContent(const QString &file) const;
     bool containsContent(const QUrl &url) const;
+    /// Search the content of a file in an encoding which is not ASCII compatible
+    bool containsDecodedContent(QFile &file) const;
     bool checkBuffer(const char *data, int len) const;
+    /// Search complete lines of raw bytes in an ASCII compatible encoding
+    bool checkBlock(const char *data, qint64 length) const;
+    /// Prepare the content search after the content or the encoding changed
+    void prepareContentSearch();
     bool checkTimer() const;
     QStringList split(QString);
 
@@ -264,6 +274,10 @@ private:
     const char *encodedEnter;
     int encodedEnterLen;
     QByteArray encodedEnterArray;
+
+    QRegularExpression containRegularExpression; // compiled once for all lines
+    bool asciiCompatibleCodec; // line breaks and ASCII characters are single bytes
+    ByteSearcher contentSearcher; // searches the encoded content in raw bytes; empty if lines must be decoded
 };
 
 #endif
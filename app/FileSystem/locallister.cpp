@@ -0,0 +1,386 @@
+/*
+    SPDX-FileCopyrightText: 2026 Krusader Krew <https://krusader.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "locallister.h"
+
+// QtCore
+#include <QAtomicInt>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QMutexLocker>
+
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef Q_OS_LINUX
+#include <sys/syscall.h>
+#endif
+
+#include "fileitem.h"
+#include "filesystem.h"
+
+// size of the buffer for raw directory entries; big enough to read a few hundred entries with
+// one system call, which matters for network filesystems
+static const int DIRENT_BUFFER_SIZE = 64 * 1024;
+
+// number of items in the first batch of a threaded listing, about one screen
+static const int FIRST_BATCH_SIZE = 100;
+// following batches are handed over after this interval (ms) or number of items
+static const int BATCH_INTERVAL = 100;
+static const int MAX_BATCH_SIZE = 5000;
+
+#ifdef HAVE_STATX
+// set once statx() turned out to be missing (before Linux 4.11) or blocked by a seccomp sandbox
+static QAtomicInt s_statxUnsupported;
+#endif
+
+/// Return a file item for an entry which status could not be read
+static FileItem *createUnreadableFileItem(const QString &name, const QUrl &url, unsigned char type)
+{
+    if (type == DT_DIR) {
+        // the dirent type still tells us that it's a directory, e.g. in a non-searchable parent
+        return new FileItem(name, url, true, 0, S_IFDIR, -1, -1, -1, -1);
+    }
+    return FileItem::createBroken(name, url);
+}
+
+/// Return the URL of a file in a local directory
+static QUrl fileUrl(const QUrl &directoryUrl, const QString &name)
+{
+    const QString directory = directoryUrl.toLocalFile();
+    return QUrl::fromLocalFile(directory.endsWith('/') ? directory + name : directory + '/' + name);
+}
+
+LocalLister::LocalLister(const QString &directory)
+    : m_directory(directory)
+    , m_pathPrefix(directory.endsWith('/') ? directory : directory + '/')
+    , m_directoryUrl(QUrl::fromLocalFile(directory))
+    , m_fd(-1)
+    , m_bufferPos(0)
+    , m_bufferEnd(0)
+    , m_dir(nullptr)
+    , m_skipHidden(false)
+    , m_error(0)
+{
+}
+
+LocalLister::~LocalLister()
+{
+    if (m_dir) {
+        closedir(m_dir);
+    }
+    if (m_fd >= 0) {
+        ::close(m_fd);
+    }
+}
+
+bool LocalLister::open()
+{
+    m_fd = ::open(QFile::encodeName(m_directory).constData(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (m_fd < 0) {
+        return false;
+    }
+
+#ifdef SYS_getdents64
+    m_buffer.resize(DIRENT_BUFFER_SIZE);
+#else
+    // readdir() needs its own descriptor, fdopendir() takes ownership of it
+    const int fd = dup(m_fd);
+    m_dir = fd >= 0 ? fdopendir(fd) : nullptr;
+    if (!m_dir) {
+        if (fd >= 0)
+            ::close(fd);
+        ::close(m_fd);
+        m_fd = -1;
+        return false;
+    }
+#endif
+    return true;
+}
+
+bool LocalLister::isSearchable() const
+{
+    return m_fd >= 0 && faccessat(AT_FDCWD, QFile::encodeName(m_directory).constData(), X_OK, 0) == 0;
+}
+
+bool LocalLister::directoryId(dev_t &device, ino_t &inode) const
+{
+    struct stat stat_p;
+    if (!directoryStatus(stat_p)) {
+        return false;
+    }
+    device = stat_p.st_dev;
+    inode = stat_p.st_ino;
+    return true;
+}
+
+bool LocalLister::directoryStatus(struct stat &status) const
+{
+    return m_fd >= 0 && fstat(m_fd, &status) == 0;
+}
+
+bool LocalLister::entryStatus(const QByteArray &name, struct stat &status) const
+{
+    return m_fd >= 0 && fstatat(m_fd, name.constData(), &status, AT_SYMLINK_NOFOLLOW) == 0;
+}
+
+void LocalLister::setSkipHidden(const QSet<QString> &hiddenFiles)
+{
+    m_skipHidden = true;
+    m_hiddenFiles = hiddenFiles;
+}
+
+bool LocalLister::next(QByteArray &name, unsigned char &type)
+{
+    if (m_fd < 0) {
+        return false;
+    }
+
+    while (true) {
+        const char *entryName;
+#ifdef SYS_getdents64
+        if (m_bufferPos >= m_bufferEnd) {
+            const long read = syscall(SYS_getdents64, m_fd, m_buffer.data(), static_cast<size_t>(m_buffer.size()));
+            if (read <= 0) {
+                if (read < 0) {
+                    m_error = errno;
+                    qWarning() << "failed to read directory" << m_directory << "errno=" << m_error;
+                }
+                return false;
+            }
+            m_bufferPos = 0;
+            m_bufferEnd = static_cast<int>(read);
+        }
+
+        // glibc's dirent64 has the same layout as the kernel's linux_dirent64
+        const auto *entry = reinterpret_cast<const struct dirent64 *>(m_buffer.constData() + m_bufferPos);
+        m_bufferPos += entry->d_reclen;
+#else
+        errno = 0;
+        const struct dirent *entry = readdir(m_dir);
+        if (!entry) {
+            m_error = errno;
+            return false;
+        }
+#endif
+        entryName = entry->d_name;
+
+        // we don't need the "." and ".." entries
+        if (entryName[0] == '.' && (entryName[1] == '\0' || (entryName[1] == '.' && entryName[2] == '\0'))) {
+            continue;
+        }
+        if (m_skipHidden && entryName[0] == '.') {
+            continue;
+        }
+
+        name = QByteArray(entryName);
+        if (m_skipHidden && !m_hiddenFiles.isEmpty() && m_hiddenFiles.contains(QFile::decodeName(name))) {
+            continue;
+        }
+#ifdef _DIRENT_HAVE_D_TYPE
+        type = entry->d_type;
+#else
+        type = DT_UNKNOWN;
+#endif
+        return true;
+    }
+}
+
+FileItem *LocalLister::createFileItem(const QByteArray &name, unsigned char type, bool virt) const
+{
+    const QString fileName = QFile::decodeName(name);
+    if (virt) {
+        const QString path = m_pathPrefix + fileName;
+        return createFileItem(m_fd, name.constData(), path, QUrl::fromLocalFile(path), type);
+    }
+
+    return createFileItem(m_fd, name.constData(), fileName, m_directoryUrl, type, true);
+}
+
+FileItem *LocalLister::createFileItem(int dirFd, const char *path, const QString &fileItemName, const QUrl &url, unsigned char type, bool urlIsDirectory)
+{
+    // read file status; in case of error create a "broken" file item
+    mode_t mode;
+    KIO::filesize_t size;
+    time_t mtime, ctime, atime, btime;
+    uid_t uid;
+    gid_t gid;
+    bool statusRead = false;
+
+#ifdef HAVE_STATX
+    if (!s_statxUnsupported.loadAcquire()) {
+        // only request the fields we actually show
+        const unsigned int mask = STATX_TYPE | STATX_MODE | STATX_UID | STATX_GID | STATX_SIZE | STATX_ATIME | STATX_MTIME | STATX_CTIME | STATX_BTIME;
+        struct statx stx;
+        if (statx(dirFd, path, AT_SYMLINK_NOFOLLOW | AT_NO_AUTOMOUNT, mask, &stx) == 0) {
+            mode = stx.stx_mode;
+            size = stx.stx_size;
+            mtime = stx.stx_mtime.tv_sec;
+            ctime = stx.stx_ctime.tv_sec;
+            atime = stx.stx_atime.tv_sec;
+            btime = (stx.stx_mask & STATX_BTIME) ? static_cast<time_t>(stx.stx_btime.tv_sec) : -1;
+            uid = stx.stx_uid;
+            gid = stx.stx_gid;
+            statusRead = true;
+        } else if (errno == ENOSYS || errno == EPERM) {
+            s_statxUnsupported.storeRelease(1); // use fstatat() from now on
+        } else {
+            return createUnreadableFileItem(fileItemName, urlIsDirectory ? fileUrl(url, fileItemName) : url, type);
+        }
+    }
+#endif
+
+    if (!statusRead) {
+        struct stat stat_p;
+        if (fstatat(dirFd, path, &stat_p, AT_SYMLINK_NOFOLLOW) < 0)
+            return createUnreadableFileItem(fileItemName, urlIsDirectory ? fileUrl(url, fileItemName) : url, type);
+
+        mode = stat_p.st_mode;
+        size = static_cast<KIO::filesize_t>(stat_p.st_size);
+        mtime = stat_p.st_mtime;
+        ctime = stat_p.st_ctime;
+        atime = stat_p.st_atime;
+        btime = -1;
+        uid = stat_p.st_uid;
+        gid = stat_p.st_gid;
+    }
+
+    bool isDir = S_ISDIR(mode);
+    const bool isLink = S_ISLNK(mode);
+
+    // for links, read link destination and determine whether it's broken or not
+    QString linkDestination;
+    bool brokenLink = false;
+    if (isLink) {
+        linkDestination = FileSystem::readLinkSafely(dirFd, path);
+
+        struct stat linkStat;
+        if (linkDestination.isNull() || fstatat(dirFd, path, &linkStat, 0) < 0)
+            brokenLink = true;
+        else if (S_ISDIR(linkStat.st_mode))
+            isDir = true;
+    }
+
+    if (urlIsDirectory) {
+        return FileItem::createInDirectory(fileItemName, url, isDir, size, mode, mtime, ctime, atime, btime, uid, gid, isLink, linkDestination, brokenLink);
+    }
+
+    return new FileItem(fileItemName,
+                        url,
+                        isDir,
+                        size,
+                        mode,
+                        mtime,
+                        ctime,
+                        atime,
+                        btime,
+                        uid,
+                        gid,
+                        QString(),
+                        QString(),
+                        isLink,
+                        linkDestination,
+                        brokenLink);
+}
+
+LocalListThread::LocalListThread(const QString &directory, bool showHidden, const QSet<QString> &hiddenFiles)
+    : _directory(directory)
+    , _showHidden(showHidden)
+    , _hiddenFiles(hiddenFiles)
+    , _result(Canceled)
+{
+    connect(this, &QThread::finished, this, &QObject::deleteLater);
+}
+
+LocalListThread::~LocalListThread()
+{
+    wait();
+    qDeleteAll(_items);
+}
+
+QList<FileItem *> LocalListThread::takeItems()
+{
+    QMutexLocker locker(&_mutex);
+    QList<FileItem *> items;
+    items.swap(_items);
+    return items;
+}
+
+void LocalListThread::cancel()
+{
+    requestInterruption();
+}
+
+void LocalListThread::run()
+{
+    LocalLister lister(_directory);
+    if (!lister.open()) {
+        _result = OpenFailed;
+        return;
+    }
+    if (!lister.isSearchable()) {
+        _result = AccessDenied;
+        return;
+    }
+    if (!_showHidden) {
+        lister.setSkipHidden(_hiddenFiles);
+    }
+
+    QList<FileItem *> batch;
+    int batchSize = FIRST_BATCH_SIZE;
+    QElapsedTimer timer;
+    timer.start();
+
+    QByteArray name;
+    unsigned char type;
+    while (lister.next(name, type)) {
+        if (isInterruptionRequested()) {
+            qDeleteAll(batch);
+            _result = Canceled;
+            return;
+        }
+
+        batch << lister.createFileItem(name, type);
+
+        if (batch.count() >= batchSize || timer.elapsed() >= BATCH_INTERVAL) {
+            publish(batch);
+            batchSize = MAX_BATCH_SIZE;
+            timer.restart();
+        }
+    }
+
+    if (lister.error()) {
+        // a truncated listing must not look complete
+        qDeleteAll(batch);
+        _result = ReadFailed;
+        return;
+    }
+
+    publish(batch);
+    _result = Succeeded;
+}
+
+void LocalListThread::publish(QList<FileItem *> &batch)
+{
+    if (batch.isEmpty()) {
+        return;
+    }
+
+    bool wasEmpty;
+    {
+        QMutexLocker locker(&_mutex);
+        wasEmpty = _items.isEmpty();
+        _items.append(batch);
+    }
+    batch.clear();
+
+    // if the receiver did not take the last batch yet it is notified already
+    if (wasEmpty) {
+        emit itemsAvailable();
+    }
+}
@@ -0,0 +1,188 @@
+/*
+    SPDX-FileCopyrightText: 2026 Krusader Krew <https://krusader.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef LOCALLISTER_H
+#define LOCALLISTER_H
+
+// QtCore
+#include <QByteArray>
+#include <QList>
+#include <QMutex>
+#include <QSet>
+#include <QString>
+#include <QThread>
+#include <QUrl>
+
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+class FileItem;
+
+/**
+ * Fast lister for local directories.
+ *
+ * The directory is opened once and all entries are read in large batches (getdents64 on Linux).
+ * File status is read relative to the directory file descriptor with statx() (if available,
+ * else fstatat()), so no absolute path has to be built, encoded and resolved by the kernel for
+ * every entry. Only the status fields needed for a file item are requested and the creation time
+ * (btime) is read where the filesystem supports it.
+ *
+ * Usage:
+ * @code
+ * LocalLister lister(path);
+ * if (lister.open()) {
+ *     QByteArray name;
+ *     unsigned char type;
+ *     while (lister.next(name, type)) {
+ *         FileItem *item = lister.createFileItem(name, type);
+ *         ...
+ *     }
+ * }
+ * @endcode
+ */
+class LocalLister
+{
+public:
+    /// @param directory absolute local path of the directory
+    explicit LocalLister(const QString &directory);
+    ~LocalLister();
+
+    /// Open the directory for reading. Returns false if it can not be opened.
+    bool open();
+    /// Return true if the file status of the entries can be read (directory is searchable).
+    bool isSearchable() const;
+    /// Read the device and inode of the opened directory. Returns false on error.
+    bool directoryId(dev_t &device, ino_t &inode) const;
+    /// Read the status of the opened directory. Returns false on error.
+    bool directoryStatus(struct stat &status) const;
+    /// Read the status of an entry, symlinks are not followed. Returns false on error.
+    bool entryStatus(const QByteArray &name, struct stat &status) const;
+    /**
+     * Skip hidden entries while reading the directory.
+     *
+     * @param hiddenFiles additional names to skip, e.g. from the ".hidden" file
+     */
+    void setSkipHidden(const QSet<QString> &hiddenFiles = QSet<QString>());
+
+    /**
+     * Read the next entry of the directory. The "." and ".." entries are skipped.
+     *
+     * @param name the encoded file name of the entry
+     * @param type the dirent type hint (DT_*) of the entry, DT_UNKNOWN if not provided
+     * @return false if there are no more entries or reading failed, see error()
+     */
+    bool next(QByteArray &name, unsigned char &type);
+    /// The errno of the failed read of the directory, 0 if next() returned false at its end
+    int error() const
+    {
+        return m_error;
+    }
+
+    /**
+     * Create a file item for an entry in this directory.
+     *
+     * @param name the encoded file name as returned by next()
+     * @param type the dirent type hint as returned by next()
+     * @param virt if true, the file item name is the absolute path
+     */
+    FileItem *createFileItem(const QByteArray &name, unsigned char type = DT_UNKNOWN, bool virt = false) const;
+
+    /**
+     * Create a file item for a file relative to a directory file descriptor.
+     *
+     * @param dirFd the file descriptor of the directory or AT_FDCWD if @p path is absolute
+     * @param path the encoded file path relative to @p dirFd
+     * @param fileItemName the name of the new file item
+     * @param url the URL of the new file item or of its directory if @p urlIsDirectory is true
+     * @param type the dirent type hint or DT_UNKNOWN
+     * @param urlIsDirectory if true, the file item shares the directory URL (see FileItem::createInDirectory())
+     */
+    static FileItem *
+    createFileItem(int dirFd, const char *path, const QString &fileItemName, const QUrl &url, unsigned char type = DT_UNKNOWN, bool urlIsDirectory = false);
+
+private:
+    const QString m_directory; //< the directory path
+    const QString m_pathPrefix; //< the directory path with trailing slash
+    const QUrl m_directoryUrl; //< the directory URL, shared by all file items
+    int m_fd; //< file descriptor of the opened directory or -1
+
+    QByteArray m_buffer; //< buffer for the raw directory entries
+    int m_bufferPos; //< position of the next entry in the buffer
+    int m_bufferEnd; //< end of valid data in the buffer
+
+    DIR *m_dir; //< only used if getdents64 is not available
+
+    bool m_skipHidden; //< true if hidden entries are skipped
+    QSet<QString> m_hiddenFiles; //< additional names of hidden entries
+    int m_error; //< errno of the failed directory read or 0
+};
+
+/**
+ * Lists a local directory in a background thread.
+ *
+ * The file items are handed over in batches: itemsAvailable() is emitted when new items can be
+ * taken with takeItems(). The first batch is small to show the first screen of files as soon as
+ * possible.
+ *
+ * The thread deletes itself after it finished, the receivers of finished() are called before.
+ * Use cancel() to stop it early.
+ */
+class LocalListThread : public QThread
+{
+    Q_OBJECT
+public:
+    enum Result {
+        /// Directory was listed completely
+        Succeeded,
+        /// Directory could not be opened
+        OpenFailed,
+        /// Directory is not searchable
+        AccessDenied,
+        /// Reading the directory failed, the items listed before are dropped
+        ReadFailed,
+        /// Listing was canceled
+        Canceled
+    };
+
+    /**
+     * @param directory absolute local path of the directory
+     * @param showHidden if false, hidden entries and entries in @p hiddenFiles are skipped
+     */
+    LocalListThread(const QString &directory, bool showHidden, const QSet<QString> &hiddenFiles);
+    ~LocalListThread() override;
+
+    /// Take all file items listed so far. Thread-safe.
+    QList<FileItem *> takeItems();
+    /// Stop listing as soon as possible. The thread (and items not taken) is deleted afterwards.
+    void cancel();
+    /// The listing result, only valid after the thread finished.
+    Result result() const
+    {
+        return _result;
+    }
+
+signals:
+    /// Emitted (from the worker thread) if new file items can be taken.
+    void itemsAvailable();
+
+protected:
+    void run() override;
+
+private:
+    /// Hand over a batch of file items to the receiver
+    void publish(QList<FileItem *> &batch);
+
+    const QString _directory;
+    const bool _showHidden;
+    const QSet<QString> _hiddenFiles;
+
+    QMutex _mutex; //< protects _items
+    QList<FileItem *> _items; //< items listed but not taken yet
+    Result _result;
+};
+
+#endif // LOCALLISTER_H
@@ -0,0 +1,150 @@
+/*
+    SPDX-FileCopyrightText: 2026 Krusader Krew <https://krusader.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "slabpool.h"
+
+// QtCore
+#include <QMutexLocker>
+
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+// slabs are aligned to their size, so the slab of a slot is found by masking the address
+static const size_t SLAB_SIZE = 64 * 1024;
+static const size_t SLOT_ALIGNMENT = alignof(std::max_align_t);
+
+/// Free slots are linked through their own memory
+struct FreeSlot {
+    FreeSlot *next;
+};
+
+/// Header at the beginning of each slab, followed by the slots
+struct SlabPool::Slab {
+    Slab *prev; //< previous slab in the free slab list
+    Slab *next; //< next slab in the free slab list
+    FreeSlot *freeSlots; //< slots which were freed
+    char *unusedSlots; //< first slot which was never used
+    size_t usedCount; //< number of allocated slots
+};
+
+static size_t alignUp(size_t size, size_t alignment)
+{
+    return (size + alignment - 1) / alignment * alignment;
+}
+
+SlabPool::SlabPool(size_t slotSize)
+    : m_slotSize(alignUp(qMax(slotSize, sizeof(FreeSlot)), SLOT_ALIGNMENT))
+    , m_slotsPerSlab((SLAB_SIZE - alignUp(sizeof(Slab), SLOT_ALIGNMENT)) / m_slotSize)
+    , m_freeSlabs(nullptr)
+    , m_emptySlab(nullptr)
+{
+}
+
+SlabPool::~SlabPool()
+{
+    // full slabs are not known to the pool; they are still in use and can not be freed anyway
+    while (m_freeSlabs) {
+        Slab *slab = m_freeSlabs;
+        m_freeSlabs = slab->next;
+        free(slab);
+    }
+}
+
+void *SlabPool::allocate()
+{
+    QMutexLocker locker(&m_mutex);
+
+    Slab *slab = m_freeSlabs ? m_freeSlabs : createSlab();
+    if (!slab) {
+        throw std::bad_alloc();
+    }
+
+    void *p;
+    if (slab->freeSlots) {
+        p = slab->freeSlots;
+        slab->freeSlots = slab->freeSlots->next;
+    } else {
+        p = slab->unusedSlots;
+        slab->unusedSlots += m_slotSize;
+    }
+
+    if (slab == m_emptySlab) {
+        m_emptySlab = nullptr;
+    }
+    if (++slab->usedCount == m_slotsPerSlab) {
+        unlinkSlab(slab);
+    }
+
+    return p;
+}
+
+void SlabPool::deallocate(void *p)
+{
+    if (!p) {
+        return;
+    }
+
+    auto *slab = reinterpret_cast<Slab *>(reinterpret_cast<uintptr_t>(p) & ~(uintptr_t)(SLAB_SIZE - 1));
+
+    QMutexLocker locker(&m_mutex);
+
+    auto *slot = static_cast<FreeSlot *>(p);
+    slot->next = slab->freeSlots;
+    slab->freeSlots = slot;
+
+    if (slab->usedCount-- == m_slotsPerSlab) {
+        linkSlab(slab); // was full
+    }
+
+    if (slab->usedCount == 0) {
+        if (!m_emptySlab) {
+            m_emptySlab = slab;
+        } else {
+            unlinkSlab(slab);
+            free(slab);
+        }
+    }
+}
+
+SlabPool::Slab *SlabPool::createSlab()
+{
+    void *memory = nullptr;
+    if (posix_memalign(&memory, SLAB_SIZE, SLAB_SIZE) != 0) {
+        return nullptr;
+    }
+
+    auto *slab = static_cast<Slab *>(memory);
+    slab->prev = nullptr;
+    slab->next = nullptr;
+    slab->freeSlots = nullptr;
+    slab->unusedSlots = static_cast<char *>(memory) + alignUp(sizeof(Slab), SLOT_ALIGNMENT);
+    slab->usedCount = 0;
+
+    linkSlab(slab);
+    return slab;
+}
+
+void SlabPool::unlinkSlab(Slab *slab)
+{
+    if (slab->prev)
+        slab->prev->next = slab->next;
+    else
+        m_freeSlabs = slab->next;
+    if (slab->next)
+        slab->next->prev = slab->prev;
+    slab->prev = nullptr;
+    slab->next = nullptr;
+}
+
+void SlabPool::linkSlab(Slab *slab)
+{
+    slab->prev = nullptr;
+    slab->next = m_freeSlabs;
+    if (m_freeSlabs)
+        m_freeSlabs->prev = slab;
+    m_freeSlabs = slab;
+}
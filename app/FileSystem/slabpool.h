@@ -0,0 +1,59 @@
+/*
+    SPDX-FileCopyrightText: 2026 Krusader Krew <https://krusader.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef SLABPOOL_H
+#define SLABPOOL_H
+
+// QtCore
+#include <QMutex>
+
+#include <cstddef>
+
+/**
+ * Memory pool for many small objects of the same size.
+ *
+ * Memory is taken from the system in large aligned slabs which are split into fixed size slots.
+ * Freed slots are reused by the next allocation, so listing a directory again after a refresh
+ * does not hit the general purpose allocator for every file item. A slab is returned to the
+ * system when all its slots are free (one empty slab is kept to avoid thrashing).
+ *
+ * Thread-safe: objects may be allocated and freed in different threads.
+ */
+class SlabPool
+{
+public:
+    /// @param slotSize the size of one object in bytes
+    explicit SlabPool(size_t slotSize);
+    ~SlabPool();
+
+    /// Return memory for one object
+    void *allocate();
+    /// Free memory returned by allocate()
+    void deallocate(void *p);
+
+    size_t slotSize() const
+    {
+        return m_slotSize;
+    }
+
+private:
+    struct Slab;
+
+    Slab *createSlab();
+    void unlinkSlab(Slab *slab);
+    void linkSlab(Slab *slab);
+
+    const size_t m_slotSize; //< object size rounded up to the alignment
+    const size_t m_slotsPerSlab; //< number of slots in one slab
+
+    QMutex m_mutex; //< protects all following members
+    Slab *m_freeSlabs; //< list of slabs with at least one free slot
+    Slab *m_emptySlab; //< the kept empty slab or nullptr
+
+    Q_DISABLE_COPY(SlabPool)
+};
+
+#endif // SLABPOOL_H
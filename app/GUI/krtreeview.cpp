@@ -0,0 +1,105 @@
+/*
+    SPDX-FileCopyrightText: 2026 Krusader Krew <https://krusader.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "krtreeview.h"
+#include "krstyleproxy.h"
+
+// QtGui
+#include <QContextMenuEvent>
+#include <QHelpEvent>
+#include <QResizeEvent>
+// QtWidgets
+#include <QAbstractItemDelegate>
+#include <QHeaderView>
+#include <QToolTip>
+
+KrTreeView::KrTreeView(QWidget *parent)
+    : QTreeView(parent)
+    , _stretchingColumn(-1)
+    , _inResize(false)
+{
+    setRootIsDecorated(false);
+    setSortingEnabled(true);
+    setAllColumnsShowFocus(true);
+    setUniformRowHeights(true);
+
+    auto *krstyle = new KrStyleProxy();
+    krstyle->setParent(this);
+    setStyle(krstyle);
+}
+
+bool KrTreeView::event(QEvent *event)
+{
+    switch (event->type()) {
+    case QEvent::ContextMenu: {
+        auto *ce = dynamic_cast<QContextMenuEvent *>(event);
+
+        if (ce->reason() == QContextMenuEvent::Mouse) {
+            QPoint pos = viewport()->mapFromGlobal(ce->globalPos());
+            emit itemRightClicked(indexAt(pos), ce->globalPos(), columnAt(pos.x()));
+            return true;
+        } else if (currentIndex().isValid()) {
+            QRect r = visualRect(currentIndex());
+            QPoint p = viewport()->mapToGlobal(QPoint(r.x() + 5, r.y() + 5));
+            emit itemRightClicked(currentIndex(), p, currentIndex().column());
+            return true;
+        }
+    } break;
+    case QEvent::Resize: {
+        auto *re = dynamic_cast<QResizeEvent *>(event);
+        if (!_inResize && re->oldSize() != re->size() && _stretchingColumn != -1 && header()->count()) {
+            QList<int> columnsSizes;
+            int oldSize = 0;
+
+            for (int i = 0; i != header()->count(); i++) {
+                columnsSizes.append(header()->sectionSize(i));
+                oldSize += header()->sectionSize(i);
+            }
+
+            bool res = QTreeView::event(event);
+
+            int delta = viewport()->width() - oldSize;
+            if (delta) {
+                _inResize = true;
+
+                for (int i = 0; i != header()->count(); i++) {
+                    if (i == _stretchingColumn)
+                        header()->resizeSection(i, qMax(8, columnsSizes[i] + delta));
+                    else if (header()->sectionSize(i) != columnsSizes[i])
+                        header()->resizeSection(i, columnsSizes[i]);
+                }
+                _inResize = false;
+            }
+            return res;
+        }
+    } break;
+    default:
+        break;
+    }
+    return QTreeView::event(event);
+}
+
+bool KrTreeView::viewportEvent(QEvent *event)
+{
+    if (event->type() == QEvent::ToolTip) {
+        auto *he = dynamic_cast<QHelpEvent *>(event);
+        const QModelIndex index = indexAt(he->pos());
+
+        // the tooltips of the model are shown by the default handler
+        if (index.isValid() && index.data(Qt::ToolTipRole).toString().isEmpty()) {
+            const QString tip = index.data(Qt::DisplayRole).toString();
+            const QRect rect = visualRect(index);
+            const int requiredWidth = itemDelegate(index)->sizeHint(viewOptions(), index).width();
+
+            if (!tip.isEmpty() && rect.width() < requiredWidth)
+                QToolTip::showText(he->globalPos(), tip, viewport());
+            else
+                QToolTip::hideText();
+            return true;
+        }
+    }
+    return QTreeView::viewportEvent(event);
+}
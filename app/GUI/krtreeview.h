@@ -0,0 +1,40 @@
+/*
+    SPDX-FileCopyrightText: 2026 Krusader Krew <https://krusader.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef KRTREEVIEW_H
+#define KRTREEVIEW_H
+
+// QtWidgets
+#include <QTreeView>
+
+/**
+ * The model based counterpart of KrTreeWidget: emits itemRightClicked() for the context menu,
+ * keeps the width of the other columns when resized and shows the truncated texts as tooltip.
+ */
+class KrTreeView : public QTreeView
+{
+    Q_OBJECT
+
+public:
+    explicit KrTreeView(QWidget *parent);
+    void setStretchingColumn(int col)
+    {
+        _stretchingColumn = col;
+    }
+
+signals:
+    void itemRightClicked(const QModelIndex &index, const QPoint &pos, int column);
+
+protected:
+    bool event(QEvent *event) override;
+    bool viewportEvent(QEvent *event) override;
+
+private:
+    int _stretchingColumn;
+    bool _inResize;
+};
+
+#endif /* KRTREEVIEW_H */
@@ -58,6 +58,11 @@ void DiskUsageViewer::openUrl(QUrl url)
         diskUsage->setView(view);
     }
 
+    if (DiskUsage::isSnapshotFile(url)) {
+        diskUsage->loadSnapshot(url.toLocalFile());
+        return;
+    }
+
     url.setPath(url.adjusted(QUrl::StripTrailingSlash).path());
 
     QUrl baseURL = diskUsage->getBaseURL();
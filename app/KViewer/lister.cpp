@@ -54,10 +54,14 @@
 #include "../kractions.h"
 #include "../krglobal.h"
 
+#include <cerrno>
+#include <unistd.h>
+
 #define SEARCH_CACHE_CHARS 100000
 #define SEARCH_MAX_ROW_LEN 4000
 #define CONTROL_CHAR 752
-#define CACHE_SIZE 1048576 // cache size set to 1MiB
+#define CACHE_BLOCK_SIZE 262144 // pipes and special files are read in blocks of 256KiB
+#define CACHE_BLOCKS 8 // the number of blocks kept in the memory
 
 ListerTextArea::ListerTextArea(Lister *lister, QWidget *parent)
     : KTextEdit(parent)
@@ -1328,6 +1332,9 @@ bool Lister::openUrl(const QUrl &listerUrl)
     _downloading = false;
     setUrl(listerUrl);
 
+    // invalidate cache
+    resetCache();
+
     _fileSize = 0;
 
     if (listerUrl.isLocalFile()) {
@@ -1367,9 +1374,6 @@ bool Lister::openUrl(const QUrl &listerUrl)
         _downloading = true;
     }
 
-    // invalidate cache
-    _cache.clear();
-
     _textArea->reset();
     emit started(nullptr);
     emit setWindowCaption(listerUrl.toDisplayString());
@@ -1388,37 +1392,94 @@ QByteArray Lister::cacheChunk(const qint64 filePos, const qint64 maxSize)
         size = _fileSize - filePos;
     }
 
-    if (!_cache.isEmpty() && (filePos >= _cachePos) && (filePos + size <= _cachePos + _cache.size())) {
-        return _cache.mid(static_cast<int>(filePos - _cachePos), static_cast<int>(size));
+    if (!openCache()) {
+        return QByteArray();
     }
 
-    const int negativeOffset = CACHE_SIZE * 2 / 5;
-    qint64 cachePos = filePos - negativeOffset;
-    if (cachePos < 0)
-        cachePos = 0;
+    if (!_cacheFile.isSequential()) {
+        // read into a reused buffer, it's copied only if a caller still holds the previous chunk.
+        // A mapping would save this copy, but crash with SIGBUS when the file is truncated.
+        _chunkBuffer.resize(static_cast<int>(size));
+        qint64 done = 0;
+        while (done < size) {
+            const ssize_t count = pread(_cacheFile.handle(), _chunkBuffer.data() + done, static_cast<size_t>(size - done), static_cast<off_t>(filePos + done));
+            if (count < 0 && errno == EINTR) {
+                continue;
+            }
+            if (count <= 0) { // an error, or the file got shorter
+                break;
+            }
+            done += count;
+        }
+        _chunkBuffer.resize(static_cast<int>(done));
+        return _chunkBuffer;
+    }
 
-    QFile sourceFile(_filePath);
-    if (!sourceFile.open(QIODevice::ReadOnly)) {
-        return QByteArray();
+    QByteArray chunk;
+    qint64 pos = filePos;
+    while (size > 0) {
+        const qint64 offset = pos % CACHE_BLOCK_SIZE;
+        const QByteArray block = cacheBlock(pos - offset);
+        if (block.size() <= offset) {
+            break;
+        }
+
+        const qint64 count = qMin(size, block.size() - offset);
+        if (chunk.isEmpty() && count == size) {
+            return block.mid(static_cast<int>(offset), static_cast<int>(count));
+        }
+        chunk.append(block.constData() + offset, static_cast<int>(count));
+
+        pos += count;
+        size -= count;
+        if (block.size() < CACHE_BLOCK_SIZE) { // end of file
+            break;
+        }
     }
+    return chunk;
+}
 
-    if (!sourceFile.seek(cachePos)) {
-        return QByteArray();
+bool Lister::openCache()
+{
+    if (_cacheFile.isOpen()) {
+        return true;
     }
 
-    const QByteArray bytes = sourceFile.read(CACHE_SIZE);
-    if (bytes.isEmpty()) {
-        return bytes;
+    _cacheFile.setFileName(_filePath);
+    return _cacheFile.open(QIODevice::ReadOnly);
+}
+
+void Lister::resetCache()
+{
+    _cacheFile.close();
+    _cacheBlocks.clear();
+}
+
+QByteArray Lister::cacheBlock(const qint64 blockPos)
+{
+    for (int i = 0; i < _cacheBlocks.count(); ++i) {
+        if (_cacheBlocks.at(i).first == blockPos) {
+            if (i > 0) {
+                _cacheBlocks.move(i, 0);
+            }
+            return _cacheBlocks.first().second;
+        }
     }
 
-    _cache = bytes;
-    _cachePos = cachePos;
-    const qint64 cacheRefIndex = filePos - _cachePos;
-    qint64 newSize = bytes.size() - cacheRefIndex;
-    if (newSize < size)
-        size = newSize;
+    if (!_cacheFile.seek(blockPos)) {
+        return QByteArray();
+    }
 
-    return _cache.mid(static_cast<int>(cacheRefIndex), static_cast<int>(size));
+    const QByteArray block = _cacheFile.read(CACHE_BLOCK_SIZE);
+    if (block.isEmpty()) {
+        return block;
+    }
+
+    _cacheBlocks.prepend(qMakePair(blockPos, block));
+    while (_cacheBlocks.count() > CACHE_BLOCKS) {
+        _cacheBlocks.removeLast();
+    }
+    return block;
 }
 
 qint64 Lister::getFileSize()
@@ -1441,8 +1502,11 @@ void Lister::slotUpdate()
 {
     const qint64 oldSize = _fileSize;
     _fileSize = getFileSize();
-    if (oldSize != _fileSize)
+    if (oldSize != _fileSize) {
+        // the last blocks of a pipe cover the old size only
+        resetCache();
         _textArea->sizeChanged();
+    }
 
     int cursorX = 0, cursorY = 0;
     _textArea->getCursorPosition(cursorX, cursorY);
@@ -9,8 +9,10 @@
 #define LISTER_H
 
 // QtCore
+#include <QFile>
 #include <QList>
 #include <QMutex>
+#include <QPair>
 #include <QTextCodec>
 #include <QTimer>
 // QtGui
@@ -191,6 +193,7 @@ public:
     {
         return _fileSize;
     }
+    /// Return at most @p maxSize bytes of the file from @p filePos, less if the file shrank meanwhile.
     QByteArray cacheChunk(const qint64 filePos, const qint64 maxSize);
 
     bool isSearchEnabled();
@@ -256,6 +259,9 @@ protected:
     void resetSearchPosition();
 
     qint64 getFileSize();
+    bool openCache();
+    void resetCache();
+    QByteArray cacheBlock(const qint64 blockPos);
     void search(const bool forward, const bool restart = false);
     QStringList readLines(qint64 &filePos, const qint64 endPos, const int columns, const int lines);
 
@@ -291,8 +297,9 @@ protected:
     QString _filePath;
     qint64 _fileSize = 0;
 
-    QByteArray _cache;
-    qint64 _cachePos = 0;
+    QFile _cacheFile;
+    QByteArray _chunkBuffer; // the last chunk read from a regular file, reused for the next one
+    QList<QPair<qint64, QByteArray>> _cacheBlocks; // the last read blocks of a pipe or special file, the most recent first
 
     KrQuery _searchQuery;
     QByteArray _searchHexQuery;
@@ -97,5 +97,14 @@ KgAdvanced::KgAdvanced(bool first, QWidget *parent)
     KonfiguratorEditBox *updatedbArgs = createEditBox("Locate", "UpdateDB Arguments", "", labelArgUpdate, fineTuneGrp, false);
     fineTuneGrid->addWidget(updatedbArgs, 1, 1);
 
+    const QString watcherTip = i18n(
+        "Changes of the displayed folder are collected for this time before the panel is updated. A longer delay reduces the load when files are changed "
+        "very often.");
+    label = new QLabel(i18n("Delay for updating changed folders (ms):"), fineTuneGrp);
+    fineTuneGrid->addWidget(label, 2, 0);
+    spinBox = createSpinBox("Advanced", "Watcher Update Delay", _WatcherUpdateDelay, 0, 10000, label, fineTuneGrp, false, watcherTip);
+    spinBox->setSizePolicy(QSizePolicy::Fixed, QSizePolicy::Fixed);
+    fineTuneGrid->addWidget(spinBox, 2, 1);
+
     kgAdvancedLayout->addWidget(fineTuneGrp, 2, 0);
 }
@@ -296,6 +296,11 @@ KrViewItem *KrInterView::preAddItem(FileItem *fileitem)
     return getKrViewItem(index);
 }
 
+void KrInterView::preAddItems(const QList<FileItem *> &fileitems)
+{
+    _model->addItems(fileitems);
+}
+
 void KrInterView::preDeleteItem(KrViewItem *item)
 {
     // update selection
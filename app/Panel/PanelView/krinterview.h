@@ -93,6 +93,7 @@ protected:
     KIO::filesize_t calcSelectedSize() override;
     void populate(const QList<FileItem *> &fileItems, FileItem *dummy) override;
     KrViewItem *preAddItem(FileItem *fileitem) override;
+    void preAddItems(const QList<FileItem *> &fileitems) override;
     /**
      * Remove an item. Does not handle new current selection.
      */
@@ -8,8 +8,13 @@
 
 #include "krsort.h"
 
+#include <algorithm>
 #include <utility>
 
+// QtCore
+#include <QThread>
+#include <QtConcurrent/QtConcurrentMap> // krazy:exclude=includes
+
 #include "../FileSystem/fileitem.h"
 #include "krview.h"
 
@@ -72,154 +77,316 @@ void SortProps::init(FileItem *fileitem, int col, const KrViewProperties *props,
     }
 }
 
-// compares numbers within two strings
-int compareNumbers(QString &aS1, int &aPos1, QString &aS2, int &aPos2)
+// minimum number of items for each thread when creating keys or sorting in parallel
+static const int MIN_ITEMS_PER_THREAD = 5000;
+
+/// Encode the digit sequences of a text, so that a simple comparison compares them by value
+static QString encodeNumbers(const QString &text)
+{
+    QString encoded;
+    encoded.reserve(text.length() + 8);
+
+    const int length = text.length();
+    int i = 0;
+    while (i < length) {
+        if (!text.at(i).isDigit()) {
+            encoded += text.at(i++);
+            continue;
+        }
+
+        const int start = i;
+        while (i < length && text.at(i).isDigit())
+            i++;
+        // leading zeros don't change the value
+        int first = start;
+        while (first < i && text.at(first).digitValue() == 0)
+            first++;
+
+        // a number compares like a digit to other characters, two numbers compare by their
+        // number of digits and then by the digits
+        encoded += QLatin1Char('0');
+        encoded += QChar(static_cast<ushort>(i - first));
+        for (int j = first; j < i; j++)
+            encoded += QChar(static_cast<ushort>('0' + text.at(j).digitValue()));
+    }
+
+    return encoded;
+}
+
+/// Run a function for parts [begin, end) of @p count items, in parallel if there are many items
+template<typename Function>
+static void forEachPart(int count, Function function)
+{
+    const int threads = qMin(QThread::idealThreadCount(), count / MIN_ITEMS_PER_THREAD);
+    if (threads < 2) {
+        function(0, count);
+        return;
+    }
+
+    QVector<QPair<int, int>> parts;
+    for (int i = 0; i < threads; ++i)
+        parts << qMakePair(static_cast<int>(qint64(count) * i / threads), static_cast<int>(qint64(count) * (i + 1) / threads));
+    QtConcurrent::blockingMap(parts, [&](const QPair<int, int> &part) {
+        function(part.first, part.second);
+    });
+}
+
+/// std::stable_sort(), in parallel if there are many items
+static void parallelStableSort(QVector<SortProps *> &items, LessThanFunc lessThan)
 {
-    int res = 0;
-    int start1 = aPos1;
-    int start2 = aPos2;
-    while (aPos1 < aS1.length() && aS1.at(aPos1).isDigit())
-        aPos1++;
-    while (aPos2 < aS2.length() && aS2.at(aPos2).isDigit())
-        aPos2++;
+    const int count = items.count();
+    const int threads = qMin(QThread::idealThreadCount(), count / MIN_ITEMS_PER_THREAD);
+    if (threads < 2) {
+        std::stable_sort(items.begin(), items.end(), lessThan);
+        return;
+    }
+
+    // sort parts of the items in parallel, then merge neighboring parts in parallel until done
+    SortProps **data = items.data();
+    QVector<QPair<int, int>> parts;
+    QVector<int> bounds;
+    for (int i = 0; i < threads; ++i) {
+        bounds << static_cast<int>(qint64(count) * i / threads);
+        parts << qMakePair(bounds.last(), static_cast<int>(qint64(count) * (i + 1) / threads));
+    }
+    bounds << count;
+
+    QtConcurrent::blockingMap(parts, [=](const QPair<int, int> &part) {
+        std::stable_sort(data + part.first, data + part.second, lessThan);
+    });
+
+    struct Merge {
+        int begin;
+        int middle;
+        int end;
+    };
+    while (bounds.count() > 2) {
+        const int partCount = bounds.count() - 1;
+        QVector<Merge> merges;
+        QVector<int> newBounds;
+        for (int i = 0; i + 1 < partCount; i += 2) {
+            merges << Merge{bounds[i], bounds[i + 1], bounds[i + 2]};
+            newBounds << bounds[i];
+        }
+        if (partCount % 2 == 1)
+            newBounds << bounds[partCount - 1];
+        newBounds << count;
+
+        QtConcurrent::blockingMap(merges, [=](const Merge &merge) {
+            std::inplace_merge(data + merge.begin, data + merge.middle, data + merge.end, lessThan);
+        });
+        bounds = newBounds;
+    }
+}
+
+/// Compare the numbers at @p pos1 and @p pos2 by value and move the positions behind them
+static int compareNumbers(const QString &text1, int &pos1, const QString &text2, int &pos2)
+{
+    int result = 0;
+    const int start1 = pos1;
+    const int start2 = pos2;
+    while (pos1 < text1.length() && text1.at(pos1).isDigit())
+        pos1++;
+    while (pos2 < text2.length() && text2.at(pos2).isDigit())
+        pos2++;
     // the left-most difference determines what's bigger
-    int i1 = aPos1 - 1;
-    int i2 = aPos2 - 1;
-    for (; i1 >= start1 || i2 >= start2; i1--, i2--) {
-        int c1 = 0;
-        int c2 = 0;
-        if (i1 >= start1)
-            c1 = aS1.at(i1).digitValue();
-        if (i2 >= start2)
-            c2 = aS2.at(i2).digitValue();
-        if (c1 < c2)
-            res = -1;
-        else if (c1 > c2)
-            res = 1;
+    for (int i1 = pos1 - 1, i2 = pos2 - 1; i1 >= start1 || i2 >= start2; i1--, i2--) {
+        const int digit1 = i1 >= start1 ? text1.at(i1).digitValue() : 0;
+        const int digit2 = i2 >= start2 ? text2.at(i2).digitValue() : 0;
+        if (digit1 != digit2)
+            result = digit1 < digit2 ? -1 : 1;
     }
-    return res;
+    return result;
 }
 
-bool compareTextsAlphabetical(QString &aS1, QString &aS2, const KrViewProperties *_viewProperties, bool aNumbers)
+const QCollatorSortKey *SortKey::characterKey(int position) const
 {
-    int lPositionS1 = 0;
-    int lPositionS2 = 0;
-    // sometimes, localeAwareCompare is not case sensitive. in that case, we need to fallback to a simple string compare (KDE bug #40131)
-    bool lUseLocaleAware = ((_viewProperties->sortOptions & KrViewProperties::IgnoreCase) || _viewProperties->localeAwareCompareIsCaseSensitive)
-        && (_viewProperties->sortOptions & KrViewProperties::LocaleAwareSort);
-    int j = 0;
-    QChar lchar1;
-    QChar lchar2;
-    while (true) {
-        lchar1 = aS1[lPositionS1];
-        lchar2 = aS2[lPositionS2];
-        // detect numbers
-        if (aNumbers && lchar1.isDigit() && lchar2.isDigit()) {
-            int j = compareNumbers(aS1, lPositionS1, aS2, lPositionS2);
-            if (j != 0)
-                return j < 0;
-        } else if (lUseLocaleAware
-                   && ((lchar1 >= 128 && ((lchar2 >= 'A' && lchar2 <= 'Z') || (lchar2 >= 'a' && lchar2 <= 'z') || lchar2 >= 128))
-                       || (lchar2 >= 128 && ((lchar1 >= 'A' && lchar1 <= 'Z') || (lchar1 >= 'a' && lchar1 <= 'z') || lchar1 >= 128)))) {
-            // use localeAwareCompare when a unicode character is encountered
-            j = QString::localeAwareCompare(lchar1, lchar2);
-            if (j != 0)
-                return j < 0;
-            lPositionS1++;
-            lPositionS2++;
-        } else {
-            // if characters are latin or localeAwareCompare is not case sensitive then use simple characters compare is enough
-            if (lchar1 < lchar2)
-                return true;
-            if (lchar1 > lchar2)
-                return false;
-            lPositionS1++;
-            lPositionS2++;
+    const ushort c = _text.at(position).unicode();
+    if (c >= 128)
+        return _characterKeys.at(position).data();
+    if (c >= 'A' && c <= 'Z')
+        return _letterKeys->at(c - 'A').data();
+    if (c >= 'a' && c <= 'z')
+        return _letterKeys->at(26 + c - 'a').data();
+    return nullptr;
+}
+
+int SortKey::compareCharacters(const SortKey &other) const
+{
+    const QString &text1 = _text;
+    const QString &text2 = other._text;
+    int pos1 = 0;
+    int pos2 = 0;
+    while (pos1 < text1.length() && pos2 < text2.length()) {
+        const QChar char1 = text1.at(pos1);
+        const QChar char2 = text2.at(pos2);
+        if (_numbers && char1.isDigit() && char2.isDigit()) {
+            const int result = compareNumbers(text1, pos1, text2, pos2);
+            if (result != 0)
+                return result;
+            continue;
         }
-        // at this point strings are equal, check if ends of strings are reached
-        if (lPositionS1 == aS1.length() && lPositionS2 == aS2.length())
-            return false;
-        if (lPositionS1 == aS1.length() && lPositionS2 < aS2.length())
-            return true;
-        if (lPositionS1 < aS1.length() && lPositionS2 == aS2.length())
-            return false;
+
+        // the locale collation is used when a non-ASCII character meets a letter or another
+        // non-ASCII character, latin characters are compared by their code
+        const QCollatorSortKey *key1 = characterKey(pos1);
+        const QCollatorSortKey *key2 = other.characterKey(pos2);
+        if (key1 && key2 && (char1.unicode() >= 128 || char2.unicode() >= 128)) {
+            const int result = key1->compare(*key2);
+            if (result != 0)
+                return result;
+        } else if (char1 != char2) {
+            return char1 < char2 ? -1 : 1;
+        }
+        pos1++;
+        pos2++;
     }
+    // a text is before the longer texts it begins with
+    return (pos1 < text1.length() ? 1 : 0) - (pos2 < text2.length() ? 1 : 0);
 }
 
-bool compareTextsCharacterCode(QString &aS1, QString &aS2, const KrViewProperties *_viewProperties, bool aNumbers)
+/**
+ * Creates the sort keys for the sort settings of a view. Use one builder for each thread.
+ */
+class SortKeyBuilder
 {
-    Q_UNUSED(_viewProperties);
-
-    int lPositionS1 = 0;
-    int lPositionS2 = 0;
-    while (true) {
-        // detect numbers
-        if (aNumbers && aS1[lPositionS1].isDigit() && aS2[lPositionS2].isDigit()) {
-            int j = compareNumbers(aS1, lPositionS1, aS2, lPositionS2);
-            if (j != 0)
-                return j < 0;
-        } else {
-            if (aS1[lPositionS1] < aS2[lPositionS2])
-                return true;
-            if (aS1[lPositionS1] > aS2[lPositionS2])
-                return false;
-            lPositionS1++;
-            lPositionS2++;
+public:
+    explicit SortKeyBuilder(const KrViewProperties *props)
+    {
+        _column = props->sortColumn;
+        _numbers = props->sortMethod == KrViewProperties::AlphabeticalNumbers || props->sortMethod == KrViewProperties::CharacterCodeNumbers;
+        // sometimes, localeAwareCompare is not case sensitive. in that case, we need to fallback to a simple string compare (KDE bug #40131)
+        const bool localeAware = props->sortMethod != KrViewProperties::CharacterCode && props->sortMethod != KrViewProperties::CharacterCodeNumbers
+            && ((props->sortOptions & KrViewProperties::IgnoreCase) || props->localeAwareCompareIsCaseSensitive)
+            && (props->sortOptions & KrViewProperties::LocaleAwareSort);
+        // the alphabetical methods use the collation only for the non-ASCII characters, the
+        // Krusader method for the whole text
+        const bool alphabetical = props->sortMethod == KrViewProperties::Alphabetical || props->sortMethod == KrViewProperties::AlphabeticalNumbers;
+        _collateText = localeAware && !alphabetical;
+        if (localeAware && alphabetical) {
+            QSharedPointer<SortKey::CharacterKeys> letterKeys(new SortKey::CharacterKeys);
+            for (char c = 'A'; c <= 'Z'; c++)
+                *letterKeys << characterKey(QLatin1Char(c));
+            for (char c = 'a'; c <= 'z'; c++)
+                *letterKeys << characterKey(QLatin1Char(c));
+            _letterKeys = letterKeys;
         }
-        // at this point strings are equal, check if ends of strings are reached
-        if (lPositionS1 == aS1.length() && lPositionS2 == aS2.length())
-            return false;
-        if (lPositionS1 == aS1.length() && lPositionS2 < aS2.length())
+    }
+
+    /// Return true if sorting by the column uses a column key
+    static bool hasColumnKey(int column)
+    {
+        switch (column) {
+        case KrViewProperties::Ext:
+        case KrViewProperties::Type:
+        case KrViewProperties::Permissions:
+        case KrViewProperties::KrPermissions:
+        case KrViewProperties::Owner:
+        case KrViewProperties::Group:
             return true;
-        if (lPositionS1 < aS1.length() && lPositionS2 == aS2.length())
+        default:
             return false;
+        }
     }
-}
 
-bool compareTextsKrusader(const QString &aS1, const QString &aS2, const KrViewProperties *_viewProperties)
-{
-    // sometimes, localeAwareCompare is not case sensitive. in that case, we need to fallback to a simple string compare (KDE bug #40131)
-    if (((_viewProperties->sortOptions & KrViewProperties::IgnoreCase) || _viewProperties->localeAwareCompareIsCaseSensitive)
-        && (_viewProperties->sortOptions & KrViewProperties::LocaleAwareSort))
-        return QString::localeAwareCompare(aS1, aS2) < 0;
-    else
-        // if localeAwareCompare is not case sensitive then use simple compare is enough
-        return QString::compare(aS1, aS2) < 0;
-}
+    SortKey key(const QString &text) const
+    {
+        SortKey key;
+        if (_collateText) {
+            key._collatorKey.reset(new QCollatorSortKey(_collator.sortKey(text)));
+        } else if (_letterKeys) {
+            key._text = text;
+            key._letterKeys = _letterKeys;
+            key._numbers = _numbers;
+            for (int i = 0; i < text.length(); ++i) {
+                if (text.at(i).unicode() < 128)
+                    continue;
+                if (key._characterKeys.isEmpty())
+                    key._characterKeys.resize(text.length());
+                key._characterKeys[i] = characterKey(text.at(i));
+            }
+        } else {
+            key._text = _numbers ? encodeNumbers(text) : text;
+        }
+        return key;
+    }
 
-bool compareTexts(QString aS1, QString aS2, const KrViewProperties *_viewProperties, bool asc, bool isName)
+    void createKeys(SortProps *props) const
+    {
+        props->_nameKey = key(props->name());
+        if (hasColumnKey(_column))
+            props->_columnKey = key(_column == KrViewProperties::Ext ? props->extension() : props->data());
+        props->_hasKeys = true;
+    }
+
+private:
+    /// Return the collation key of a single character, keys are shared between the texts
+    QSharedPointer<QCollatorSortKey> characterKey(QChar c) const
+    {
+        QSharedPointer<QCollatorSortKey> &key = _characterKeys[c.unicode()];
+        if (!key)
+            key.reset(new QCollatorSortKey(_collator.sortKey(QString(c))));
+        return key;
+    }
+
+    QCollator _collator;
+    int _column;
+    bool _numbers;
+    bool _collateText; //< use the collation key of the whole text
+    QSharedPointer<const SortKey::CharacterKeys> _letterKeys; //< keys of the ASCII letters if the collation is used per character
+    mutable QHash<ushort, QSharedPointer<QCollatorSortKey>> _characterKeys; //< keys of the characters seen so far
+};
+
+/// Compare two texts by their keys. Empty texts are always first, ".." is always on top.
+static bool compareTexts(const QString &text1, const SortKey &key1, const QString &text2, const SortKey &key2, bool asc)
 {
     // check empty strings
-    if (aS1.length() == 0 && aS2.length() == 0) {
-        return false;
-    } else if (aS1.length() == 0) {
-        return true;
-    } else if (aS2.length() == 0) {
+    if (text1.isEmpty()) {
+        return !text2.isEmpty();
+    } else if (text2.isEmpty()) {
         return false;
     }
 
-    if (isName) {
-        if (aS1 == "..") {
-            return !asc;
-        } else {
-            if (aS2 == "..")
-                return asc;
-        }
+    if (text1 == "..") {
+        return !asc;
+    } else if (text2 == "..") {
+        return asc;
     }
 
-    switch (_viewProperties->sortMethod) {
-    case KrViewProperties::Alphabetical:
-        return compareTextsAlphabetical(aS1, aS2, _viewProperties, false);
-    case KrViewProperties::AlphabeticalNumbers:
-        return compareTextsAlphabetical(aS1, aS2, _viewProperties, true);
-    case KrViewProperties::CharacterCode:
-        return compareTextsCharacterCode(aS1, aS2, _viewProperties, false);
-    case KrViewProperties::CharacterCodeNumbers:
-        return compareTextsCharacterCode(aS1, aS2, _viewProperties, true);
-    case KrViewProperties::Krusader:
-    default:
-        return compareTextsKrusader(aS1, aS2, _viewProperties);
+    return key1.compare(key2) < 0;
+}
+
+static inline bool compareNames(const SortProps *sp, const SortProps *sp2)
+{
+    return compareTexts(sp->name(), sp->nameKey(), sp2->name(), sp2->nameKey(), sp->isAscending());
+}
+
+static inline bool compareColumnTexts(const QString &text1, const QString &text2, const SortProps *sp, const SortProps *sp2)
+{
+    return compareTexts(text1, sp->columnKey(), text2, sp2->columnKey(), sp->isAscending());
+}
+
+SortKeyCache::SortKeyCache()
+    : _properties(nullptr)
+    , _sortMethod(0)
+    , _sortOptions(0)
+    , _column(KrViewProperties::NoColumn)
+{
+}
+
+void SortKeyCache::validate(const KrViewProperties *props)
+{
+    const int keyOptions = props->sortOptions & (KrViewProperties::IgnoreCase | KrViewProperties::LocaleAwareSort);
+    if (props != _properties || props->sortMethod != _sortMethod || keyOptions != _sortOptions || props->atomicExtensions != _atomicExtensions) {
+        clear();
+        _properties = props;
+        _sortMethod = props->sortMethod;
+        _sortOptions = keyOptions;
+        _atomicExtensions = props->atomicExtensions;
+    } else if (props->sortColumn != _column) {
+        _columnKeys.clear();
     }
+    _column = props->sortColumn;
 }
 
 bool itemLessThan(SortProps *sp, SortProps *sp2)
@@ -252,14 +419,14 @@ bool itemLessThan(SortProps *sp, SortProps *sp2)
 
     switch (column) {
     case KrViewProperties::Name:
-        return compareTexts(sp->name(), sp2->name(), sp->properties(), sp->isAscending(), true) ^ alwaysSortDirsByName;
+        return compareNames(sp, sp2) ^ alwaysSortDirsByName;
     case KrViewProperties::Ext:
         if (sp->extension() == sp2->extension())
-            return compareTexts(sp->name(), sp2->name(), sp->properties(), sp->isAscending(), true);
-        return compareTexts(sp->extension(), sp2->extension(), sp->properties(), sp->isAscending(), true);
+            return compareNames(sp, sp2);
+        return compareColumnTexts(sp->extension(), sp2->extension(), sp, sp2);
     case KrViewProperties::Size:
         if (file1->getSize() == file2->getSize())
-            return compareTexts(sp->name(), sp2->name(), sp->properties(), sp->isAscending(), true);
+            return compareNames(sp, sp2);
         return file1->getSize() < file2->getSize();
     case KrViewProperties::Modified:
         return compareTime(file1->getModificationTime(), file2->getModificationTime(), sp, sp2);
@@ -273,15 +440,15 @@ bool itemLessThan(SortProps *sp, SortProps *sp2)
     case KrViewProperties::Owner:
     case KrViewProperties::Group:
         if (sp->data() == sp2->data())
-            return compareTexts(sp->name(), sp2->name(), sp->properties(), sp->isAscending(), true);
-        return compareTexts(sp->data(), sp2->data(), sp->properties(), sp->isAscending(), true);
+            return compareNames(sp, sp2);
+        return compareColumnTexts(sp->data(), sp2->data(), sp, sp2);
     }
     return sp->name() < sp2->name();
 }
 
 bool compareTime(time_t time1, time_t time2, SortProps *sp, SortProps *sp2)
 {
-    return time1 != time2 ? time1 < time2 : compareTexts(sp->name(), sp2->name(), sp->properties(), sp->isAscending(), true);
+    return time1 != time2 ? time1 < time2 : compareNames(sp, sp2);
 }
 
 bool itemGreaterThan(SortProps *sp, SortProps *sp2)
@@ -289,10 +456,11 @@ bool itemGreaterThan(SortProps *sp, SortProps *sp2)
     return !itemLessThan(sp, sp2);
 }
 
-Sorter::Sorter(int reserveItems, const KrViewProperties *viewProperties, LessThanFunc lessThanFunc, LessThanFunc greaterThanFunc)
+Sorter::Sorter(int reserveItems, const KrViewProperties *viewProperties, LessThanFunc lessThanFunc, LessThanFunc greaterThanFunc, SortKeyCache *keyCache)
     : _viewProperties(viewProperties)
     , _lessThanFunc(lessThanFunc)
     , _greaterThanFunc(greaterThanFunc)
+    , _keyCache(keyCache)
 {
     _items.reserve(reserveItems);
     _itemStore.reserve(reserveItems);
@@ -306,18 +474,102 @@ void Sorter::addItem(FileItem *fileitem, bool isDummy, int idx, QVariant customD
 
 void Sorter::sort()
 {
-    std::stable_sort(_items.begin(), _items.end(), descending() ? _greaterThanFunc : _lessThanFunc);
+    prepareKeys();
+    parallelStableSort(_items, descending() ? _greaterThanFunc : _lessThanFunc);
+}
+
+QVector<int> Sorter::insertIndices(const QList<FileItem *> &sortedItems, const FileItem *dummy)
+{
+    prepareKeys();
+
+    const bool hasColumnKey = SortKeyBuilder::hasColumnKey(_viewProperties->sortColumn);
+    const SortKeyBuilder builder(_viewProperties);
+    const LessThanFunc lessThan = descending() ? _greaterThanFunc : _lessThanFunc;
+
+    QVector<int> indices;
+    indices.reserve(_items.count());
+    int first = 0;
+    for (SortProps *props : qAsConst(_items)) {
+        // lower bound; the items are sorted, the position is not before the previous one
+        int count = sortedItems.count() - first;
+        while (count > 0) {
+            const int step = count / 2;
+            const int middle = first + step;
+            FileItem *fileitem = sortedItems[middle];
+            SortProps middleProps(fileitem, _viewProperties->sortColumn, _viewProperties, fileitem == dummy, !descending(), middle, QVariant());
+            if (!takeCachedKeys(&middleProps, hasColumnKey)) {
+                builder.createKeys(&middleProps);
+                cacheKeys(&middleProps, hasColumnKey);
+            }
+
+            if (lessThan(&middleProps, props)) {
+                first = middle + 1;
+                count -= step + 1;
+            } else {
+                count = step;
+            }
+        }
+        indices << first;
+    }
+
+    return indices;
+}
+
+void Sorter::prepareKeys()
+{
+    const bool hasColumnKey = SortKeyBuilder::hasColumnKey(_viewProperties->sortColumn);
+    if (_keyCache)
+        _keyCache->validate(_viewProperties);
+
+    QVector<SortProps *> missingKeys;
+    for (SortProps *props : qAsConst(_items)) {
+        if (!props->_hasKeys && !takeCachedKeys(props, hasColumnKey))
+            missingKeys << props;
+    }
+
+    if (missingKeys.isEmpty())
+        return;
+
+    // creating keys (collation) is expensive, many keys are created in parallel
+    const KrViewProperties *viewProperties = _viewProperties;
+    forEachPart(missingKeys.count(), [&missingKeys, viewProperties](int begin, int end) {
+        const SortKeyBuilder builder(viewProperties);
+        for (int i = begin; i < end; ++i)
+            builder.createKeys(missingKeys[i]);
+    });
+
+    for (const SortProps *props : qAsConst(missingKeys))
+        cacheKeys(props, hasColumnKey);
+}
+
+bool Sorter::takeCachedKeys(SortProps *props, bool hasColumnKey)
+{
+    if (!_keyCache)
+        return false;
+
+    const auto nameKey = _keyCache->_nameKeys.constFind(props->fileitem());
+    if (nameKey == _keyCache->_nameKeys.constEnd())
+        return false;
+    const auto columnKey = hasColumnKey ? _keyCache->_columnKeys.constFind(props->fileitem()) : _keyCache->_columnKeys.constEnd();
+    if (hasColumnKey && columnKey == _keyCache->_columnKeys.constEnd())
+        return false;
+
+    props->_nameKey = *nameKey;
+    if (hasColumnKey)
+        props->_columnKey = *columnKey;
+    props->_hasKeys = true;
+    return true;
 }
 
-int Sorter::insertIndex(FileItem *fileitem, bool isDummy, QVariant customData)
+void Sorter::cacheKeys(const SortProps *props, bool hasColumnKey)
 {
-    SortProps props(fileitem, _viewProperties->sortColumn, _viewProperties, isDummy, !descending(), -1, std::move(customData));
-    const QVector<SortProps *>::iterator it = std::lower_bound(_items.begin(), _items.end(), &props, descending() ? _greaterThanFunc : _lessThanFunc);
+    // the dummy item is recreated often, don't keep its keys
+    if (!_keyCache || props->isDummy())
+        return;
 
-    if (it != _items.end())
-        return _items.indexOf((*it));
-    else
-        return _items.count();
+    _keyCache->_nameKeys.insert(props->fileitem(), props->nameKey());
+    if (hasColumnKey)
+        _keyCache->_columnKeys.insert(props->fileitem(), props->columnKey());
 }
 
 bool Sorter::descending() const
@@ -12,7 +12,11 @@
 #include <sys/types.h>
 
 // QtCore
+#include <QCollator>
+#include <QHash>
+#include <QSharedPointer>
 #include <QString>
+#include <QStringList>
 #include <QVariant>
 #include <QVector>
 
@@ -23,15 +27,91 @@ class KrViewProperties;
 namespace KrSort
 {
 
-class SortProps
+/**
+ * Precomputed key for comparing a text with the configured sort method.
+ *
+ * Comparing keys is a lot faster than comparing the texts: numbers and the locale collation are
+ * handled once when the key is created.
+ */
+class SortKey
 {
 public:
-    SortProps()
+    SortKey()
+        : _numbers(false)
+    {
+    }
+
+    /// Compare with another key created for the same sort settings, like QString::compare()
+    inline int compare(const SortKey &other) const
+    {
+        if (_collatorKey)
+            return _collatorKey->compare(*other._collatorKey);
+        if (_letterKeys)
+            return compareCharacters(other);
+        return QString::compare(_text, other._text);
+    }
+
+private:
+    friend class SortKeyBuilder;
+
+    typedef QVector<QSharedPointer<QCollatorSortKey>> CharacterKeys;
+
+    /// Compare character by character, with the locale collation for non-ASCII characters
+    int compareCharacters(const SortKey &other) const;
+    /// Return the collation key of the character at @p position, or null if it is compared by its code
+    const QCollatorSortKey *characterKey(int position) const;
+
+    QString _text; //< the encoded text if no locale collation is used, else the text itself
+    QSharedPointer<QCollatorSortKey> _collatorKey; //< key of the locale collation of the whole text, else null
+    CharacterKeys _characterKeys; //< keys of the non-ASCII characters of _text, empty if there are none
+    QSharedPointer<const CharacterKeys> _letterKeys; //< keys of the ASCII letters if the collation is used per character, else null
+    bool _numbers; //< compare numbers by value when the collation is used per character
+};
+
+/**
+ * Sort keys of file items which are kept between sorts. Keys are dropped automatically when the
+ * sort settings change.
+ *
+ * NOTE: the keys of a file item must be removed when the file item is deleted.
+ */
+class SortKeyCache
+{
+public:
+    SortKeyCache();
+
+    void remove(const FileItem *fileitem)
+    {
+        _nameKeys.remove(fileitem);
+        _columnKeys.remove(fileitem);
+    }
+    void clear()
     {
+        _nameKeys.clear();
+        _columnKeys.clear();
     }
-    SortProps(const SortProps &other)
+
+private:
+    friend class Sorter;
+
+    /// Drop all keys which were created for other sort settings
+    void validate(const KrViewProperties *props);
+
+    QHash<const FileItem *, SortKey> _nameKeys; //< keys of the file names
+    QHash<const FileItem *, SortKey> _columnKeys; //< keys of the extension or text of the sort column
+
+    // the sort settings of the keys
+    const KrViewProperties *_properties;
+    int _sortMethod;
+    int _sortOptions;
+    int _column;
+    QStringList _atomicExtensions;
+};
+
+class SortProps
+{
+public:
+    SortProps()
     {
-        init(other.fileitem(), other.column(), other.properties(), other.isDummy(), other.isAscending(), other.originalIndex(), other.customData());
     }
     SortProps(FileItem *fileitem, int col, const KrViewProperties *props, bool isDummy, bool asc, int origNdx, QVariant customData)
     {
@@ -78,8 +158,21 @@ public:
     {
         return _customData;
     }
+    /// Key of name(), only valid after the sorter prepared the keys
+    inline const SortKey &nameKey() const
+    {
+        return _nameKey;
+    }
+    /// Key of extension() or data() depending on the column, only valid after the sorter prepared the keys
+    inline const SortKey &columnKey() const
+    {
+        return _columnKey;
+    }
 
 private:
+    friend class Sorter;
+    friend class SortKeyBuilder;
+
     void init(FileItem *fileitem, int col, const KrViewProperties *props, bool isDummy, bool asc, int origNdx, QVariant customData);
 
     int _col;
@@ -92,19 +185,29 @@ private:
     int _index;
     QString _data;
     QVariant _customData;
+    SortKey _nameKey;
+    SortKey _columnKey;
+    bool _hasKeys = false;
 };
 
-bool compareTexts(QString aS1, QString aS2, const KrViewProperties *_viewProperties, bool asc, bool isName);
 bool itemLessThan(SortProps *sp, SortProps *sp2);
 bool itemGreaterThan(SortProps *sp, SortProps *sp2);
 bool compareTime(time_t time1, time_t time2, SortProps *sp, SortProps *sp2);
 
 typedef bool (*LessThanFunc)(SortProps *, SortProps *);
 
+class SortKeyBuilder;
+
+/**
+ * Sorts file items.
+ *
+ * The sort keys of all items are created before sorting (in parallel for many items) and taken
+ * from and stored in the key cache, if given. Many items are sorted in parallel.
+ */
 class Sorter
 {
 public:
-    Sorter(int reserveItems, const KrViewProperties *viewProperties, LessThanFunc lessThanFunc, LessThanFunc greaterThanFunc);
+    Sorter(int reserveItems, const KrViewProperties *viewProperties, LessThanFunc lessThanFunc, LessThanFunc greaterThanFunc, SortKeyCache *keyCache = nullptr);
     Sorter(const Sorter &other);
 
     const QVector<SortProps *> &items() const
@@ -113,15 +216,29 @@ public:
     }
     void sort();
     void addItem(FileItem *fileitem, bool isDummy, int idx, QVariant customData);
-    int insertIndex(FileItem *fileitem, bool isDummy, QVariant customData);
+    /**
+     * Return the insert positions of the (sorted) items of this sorter in other sorted file items.
+     * Uses binary search, only the sort properties of the compared file items are created.
+     *
+     * @param sortedItems file items sorted with the same settings
+     * @param dummy the dummy file item in @p sortedItems or nullptr
+     */
+    QVector<int> insertIndices(const QList<FileItem *> &sortedItems, const FileItem *dummy);
 
 private:
     bool descending() const;
+    /// Create the sort keys of all items which don't have them yet
+    void prepareKeys();
+    /// Take the sort keys of an item from the cache. Returns false if not cached.
+    bool takeCachedKeys(SortProps *props, bool hasColumnKey);
+    /// Put the sort keys of an item into the cache
+    void cacheKeys(const SortProps *props, bool hasColumnKey);
 
     const KrViewProperties *_viewProperties;
     QVector<SortProps *> _items;
     QVector<SortProps> _itemStore;
     LessThanFunc _lessThanFunc, _greaterThanFunc;
+    SortKeyCache *_keyCache;
 };
 
 } // namespace KrSort
@@ -76,11 +76,21 @@ void KrViewOperator::fileAdded(FileItem *fileitem)
     _view->addItem(fileitem);
 }
 
+void KrViewOperator::filesAdded(const QList<FileItem *> &fileitems)
+{
+    _view->addItems(fileitems);
+}
+
 void KrViewOperator::fileUpdated(FileItem *newFileitem)
 {
     _view->updateItem(newFileitem);
 }
 
+void KrViewOperator::fileRemoved(FileItem *fileitem)
+{
+    _view->deleteItem(fileitem->getName());
+}
+
 void KrViewOperator::startDrag()
 {
     QStringList items;
@@ -587,6 +597,45 @@ void KrView::addItem(FileItem *fileItem, bool onUpdate)
     }
 }
 
+void KrView::addItems(const QList<FileItem *> &fileItems)
+{
+    if (!_files)
+        return;
+
+    QList<FileItem *> newItems;
+    newItems.reserve(fileItems.count() + 1);
+    for (FileItem *fileItem : fileItems) {
+        if (isFiltered(fileItem))
+            continue;
+        if (fileItem->isDir())
+            ++_numDirs;
+        ++_count;
+        newItems << fileItem;
+    }
+
+    if (!getFirst()) {
+        // first items of a new directory, the current item is set when the scan is done
+        if (!_files->isRoot()) {
+            _dummyFileItem = FileItem::createDummy();
+            newItems.prepend(_dummyFileItem);
+        }
+        populate(newItems, _dummyFileItem);
+        setCurrentKrViewItem(getFirst(), false);
+    } else if (!newItems.isEmpty()) {
+        preAddItems(newItems);
+        if (_previews) {
+            for (FileItem *fileItem : qAsConst(newItems)) {
+                KrViewItem *viewItem = findItemByName(fileItem->getName());
+                if (viewItem)
+                    _previews->updatePreview(viewItem);
+            }
+        }
+    }
+
+    redraw();
+    op()->emitSelectionChanged();
+}
+
 void KrView::updateItem(FileItem *newFileItem)
 {
     // file name did not change
@@ -1075,7 +1124,9 @@ void KrView::setFiles(DirListerInterface *files)
     QObject::connect(_files, &DirListerInterface::scanDone, op(), &KrViewOperator::startUpdate);
     QObject::connect(_files, &DirListerInterface::cleared, op(), &KrViewOperator::cleared);
     QObject::connect(_files, &DirListerInterface::addedFileItem, op(), &KrViewOperator::fileAdded);
+    QObject::connect(_files, &DirListerInterface::addedFileItems, op(), &KrViewOperator::filesAdded);
     QObject::connect(_files, &DirListerInterface::updatedFileItem, op(), &KrViewOperator::fileUpdated);
+    QObject::connect(_files, &DirListerInterface::removedFileItem, op(), &KrViewOperator::fileRemoved);
 }
 
 void KrView::setFilter(KrViewProperties::FilterSpec filter, const FilterSettings &customFilter, bool applyToDirs)
@@ -161,7 +161,9 @@ public slots:
     void startUpdate();
     void cleared();
     void fileAdded(FileItem *fileitem);
+    void filesAdded(const QList<FileItem *> &fileitems);
     void fileUpdated(FileItem *newFileitem);
+    void fileRemoved(FileItem *fileitem);
 
 signals:
     void selectionChanged();
@@ -294,6 +296,7 @@ public:
 
 protected:
     virtual KrViewItem *preAddItem(FileItem *fileitem) = 0;
+    virtual void preAddItems(const QList<FileItem *> &fileitems) = 0;
     virtual void preDeleteItem(KrViewItem *item) = 0;
     virtual void copySettingsFrom(KrView *other) = 0;
     virtual void populate(const QList<FileItem *> &fileItems, FileItem *dummy) = 0;
@@ -301,6 +304,8 @@ protected:
     virtual void clear();
 
     void addItem(FileItem *fileItem, bool onUpdate = false);
+    /// Add multiple file items at once, e.g. while a directory is loaded
+    void addItems(const QList<FileItem *> &fileItems);
     void deleteItem(const QString &name, bool onUpdate = false);
     void updateItem(FileItem *newFileItem);
 
@@ -19,8 +19,14 @@
 #include <KLocalizedString>
 #include <KSharedConfig>
 
+// batches with more insert positions are inserted with one layout change
+static const int MAX_INSERT_RANGES = 16;
+
+static const QModelIndex invalidIndex;
+
 ListModel::ListModel(KrInterView *view)
     : QAbstractListModel(nullptr)
+    , _validIndices(0)
     , _extensionEnabled(true)
     , _view(view)
     , _dummyFileItem(nullptr)
@@ -38,13 +44,17 @@ void ListModel::populate(const QList<FileItem *> &files, FileItem *dummy)
     _dummyFileItem = dummy;
     _ready = true;
 
+    _nameNdx.reserve(_fileItems.count());
+    _urlNdx.reserve(_fileItems.count());
+    for (FileItem *fileItem : qAsConst(_fileItems))
+        addIndices(fileItem);
+    _validIndices = 0;
+
     if (lastSortOrder() != KrViewProperties::NoColumn)
         sort();
     else {
         emit layoutAboutToBeChanged();
-        for (int i = 0; i < _fileItems.count(); i++) {
-            updateIndices(_fileItems[i], i);
-        }
+        updateIndices();
         emit layoutChanged();
     }
 }
@@ -67,8 +77,10 @@ void ListModel::clear(bool emitLayoutChanged)
 
     _fileItems.clear();
     _fileItemNdx.clear();
+    _validIndices = 0;
     _nameNdx.clear();
     _urlNdx.clear();
+    _sortKeyCache.clear();
     _dummyFileItem = nullptr;
 
     if (emitLayoutChanged)
@@ -268,27 +280,33 @@ void ListModel::sort(int column, Qt::SortOrder order)
         return;
 
     emit layoutAboutToBeChanged();
+    const bool sortOrderChanged = sortItems();
+    emit layoutChanged();
 
+    if (sortOrderChanged)
+        _view->makeItemVisible(_view->getCurrentKrViewItem());
+}
+
+bool ListModel::sortItems()
+{
     QModelIndexList oldPersistentList = persistentIndexList();
 
     KrSort::Sorter sorter(createSorter());
     sorter.sort();
 
     _fileItems.clear();
-    _fileItemNdx.clear();
-    _nameNdx.clear();
-    _urlNdx.clear();
+    _validIndices = 0;
 
     bool sortOrderChanged = false;
-    QHash<int, int> changeMap;
+    QVector<int> changeMap(sorter.items().count());
     for (int i = 0; i < sorter.items().count(); ++i) {
         const KrSort::SortProps *props = sorter.items()[i];
         _fileItems.append(props->fileitem());
         changeMap[props->originalIndex()] = i;
         if (i != props->originalIndex())
             sortOrderChanged = true;
-        updateIndices(props->fileitem(), i);
     }
+    updateIndices();
 
     QModelIndexList newPersistentList;
     for (const QModelIndex &mndx : qAsConst(oldPersistentList))
@@ -296,55 +314,109 @@ void ListModel::sort(int column, Qt::SortOrder order)
 
     changePersistentIndexList(oldPersistentList, newPersistentList);
 
-    emit layoutChanged();
-    if (sortOrderChanged)
-        _view->makeItemVisible(_view->getCurrentKrViewItem());
+    return sortOrderChanged;
 }
 
 QModelIndex ListModel::addItem(FileItem *fileitem)
 {
-    emit layoutAboutToBeChanged();
+    QList<FileItem *> files({fileitem});
+    const int row = lastSortOrder() == KrViewProperties::NoColumn ? _fileItems.count() : insertIndices(files).first();
+
+    beginInsertRows(QModelIndex(), row, row);
+    _fileItems.insert(row, fileitem);
+    addIndices(fileitem);
+    _validIndices = qMin(_validIndices, row);
+    endInsertRows();
+
+    return index(row, 0);
+}
+
+void ListModel::addItems(const QList<FileItem *> &files)
+{
+    if (files.isEmpty())
+        return;
 
     if (lastSortOrder() == KrViewProperties::NoColumn) {
-        int idx = _fileItems.count();
-        _fileItems.append(fileitem);
-        updateIndices(fileitem, idx);
-        emit layoutChanged();
-        return index(idx, 0);
+        const int first = _fileItems.count();
+        beginInsertRows(QModelIndex(), first, first + files.count() - 1);
+        _fileItems.append(files);
+        for (FileItem *fileItem : files)
+            addIndices(fileItem);
+        endInsertRows();
+        return;
     }
 
-    QModelIndexList oldPersistentList = persistentIndexList();
-
-    KrSort::Sorter sorter(createSorter());
+    QList<FileItem *> sortedFiles = files;
+    const QVector<int> positions = insertIndices(sortedFiles);
+    for (FileItem *fileItem : qAsConst(sortedFiles))
+        addIndices(fileItem);
+    _validIndices = qMin(_validIndices, positions.first());
 
-    const bool isDummy = fileitem == _dummyFileItem;
-    const int insertIndex = sorter.insertIndex(fileitem, isDummy, customSortData(fileitem));
-    if (insertIndex != _fileItems.count())
-        _fileItems.insert(insertIndex, fileitem);
-    else
-        _fileItems.append(fileitem);
+    int insertRanges = 1;
+    for (int i = 1; i < positions.count(); ++i) {
+        if (positions[i] != positions[i - 1])
+            ++insertRanges;
+    }
 
-    for (int i = insertIndex; i < _fileItems.count(); ++i) {
-        updateIndices(_fileItems[i], i);
+    if (insertRanges <= MAX_INSERT_RANGES) {
+        // insert each range of new items at one position
+        int inserted = 0;
+        int i = 0;
+        while (i < positions.count()) {
+            int end = i + 1;
+            while (end < positions.count() && positions[end] == positions[i])
+                ++end;
+
+            const int row = positions[i] + inserted;
+            beginInsertRows(QModelIndex(), row, row + end - i - 1);
+            for (int j = i; j < end; ++j)
+                _fileItems.insert(row + j - i, sortedFiles[j]);
+            endInsertRows();
+
+            inserted += end - i;
+            i = end;
+        }
+        return;
     }
 
-    QModelIndexList newPersistentList;
-    for (const QModelIndex &mndx : qAsConst(oldPersistentList)) {
-        int newRow = mndx.row();
-        if (newRow >= insertIndex)
-            newRow++;
-        newPersistentList << index(newRow, mndx.column());
+    // many insert positions: merge the items and remap the persistent indices once
+    emit layoutAboutToBeChanged();
+    const QModelIndexList oldPersistentList = persistentIndexList();
+
+    QList<FileItem *> mergedItems;
+    mergedItems.reserve(_fileItems.count() + sortedFiles.count());
+    QVector<int> changeMap(_fileItems.count());
+    int oldRow = 0;
+    for (int i = 0; i < sortedFiles.count(); ++i) {
+        for (; oldRow < positions[i]; ++oldRow) {
+            changeMap[oldRow] = mergedItems.count();
+            mergedItems << _fileItems[oldRow];
+        }
+        mergedItems << sortedFiles[i];
+    }
+    for (; oldRow < _fileItems.count(); ++oldRow) {
+        changeMap[oldRow] = mergedItems.count();
+        mergedItems << _fileItems[oldRow];
     }
+    _fileItems = mergedItems;
 
+    QModelIndexList newPersistentList;
+    newPersistentList.reserve(oldPersistentList.count());
+    for (const QModelIndex &mndx : oldPersistentList)
+        newPersistentList << index(changeMap[mndx.row()], mndx.column());
     changePersistentIndexList(oldPersistentList, newPersistentList);
-    emit layoutChanged();
 
-    return index(insertIndex, 0);
+    emit layoutChanged();
 }
 
 void ListModel::removeItem(FileItem *fileItem)
 {
-    const int rowToRemove = _fileItems.indexOf(fileItem);
+    _sortKeyCache.remove(fileItem);
+
+    // the row index may be outdated, searching is still cheaper than updating all indices
+    const QModelIndex cachedIndex = _fileItemNdx.value(fileItem);
+    const int rowToRemove =
+        cachedIndex.isValid() && cachedIndex.row() < _fileItems.count() && _fileItems[cachedIndex.row()] == fileItem ? cachedIndex.row() : _fileItems.indexOf(fileItem);
     if (rowToRemove < 0)
         return;
 
@@ -355,11 +427,7 @@ void ListModel::removeItem(FileItem *fileItem)
     _fileItemNdx.remove(fileItem);
     _nameNdx.remove(fileItem->getName());
     _urlNdx.remove(fileItem->getUrl());
-
-    // update indices for fileItems following the removed fileitem
-    for (int i = rowToRemove; i < _fileItems.count(); i++) {
-        updateIndices(_fileItems[i], i);
-    }
+    _validIndices = qMin(_validIndices, rowToRemove);
 
     endRemoveRows();
 }
@@ -411,12 +479,23 @@ FileItem *ListModel::fileItemAt(const QModelIndex &index)
 
 const QModelIndex &ListModel::fileItemIndex(const FileItem *fileitem)
 {
-    return _fileItemNdx[const_cast<FileItem *>(fileitem)];
+    auto *fileItem = const_cast<FileItem *>(fileitem);
+    auto it = _fileItemNdx.constFind(fileItem);
+    if (it == _fileItemNdx.constEnd() || it->row() >= _validIndices) {
+        if (_validIndices == _fileItems.count())
+            return invalidIndex; // not in this model
+        updateIndices();
+        it = _fileItemNdx.constFind(fileItem);
+        if (it == _fileItemNdx.constEnd())
+            return invalidIndex;
+    }
+    return *it;
 }
 
 const QModelIndex &ListModel::nameIndex(const QString &st)
 {
-    return _nameNdx[st];
+    FileItem *fileItem = _nameNdx.value(st);
+    return fileItem ? fileItemIndex(fileItem) : invalidIndex;
 }
 
 Qt::ItemFlags ListModel::flags(const QModelIndex &index) const
@@ -470,22 +549,42 @@ QString ListModel::nameWithoutExtension(const FileItem *fileItem, bool checkEnab
 
 const QModelIndex &ListModel::indexFromUrl(const QUrl &url)
 {
-    return _urlNdx[url];
+    FileItem *fileItem = _urlNdx.value(url);
+    return fileItem ? fileItemIndex(fileItem) : invalidIndex;
 }
 
 KrSort::Sorter ListModel::createSorter()
 {
-    KrSort::Sorter sorter(_fileItems.count(), properties(), lessThanFunc(), greaterThanFunc());
+    KrSort::Sorter sorter(_fileItems.count(), properties(), lessThanFunc(), greaterThanFunc(), &_sortKeyCache);
     for (int i = 0; i < _fileItems.count(); i++)
         sorter.addItem(_fileItems[i], _fileItems[i] == _dummyFileItem, i, customSortData(_fileItems[i]));
     return sorter;
 }
 
-void ListModel::updateIndices(FileItem *file, int i)
+QVector<int> ListModel::insertIndices(QList<FileItem *> &files)
+{
+    KrSort::Sorter sorter(files.count(), properties(), lessThanFunc(), greaterThanFunc(), &_sortKeyCache);
+    for (int i = 0; i < files.count(); i++)
+        sorter.addItem(files[i], files[i] == _dummyFileItem, i, customSortData(files[i]));
+    sorter.sort();
+
+    for (int i = 0; i < files.count(); i++)
+        files[i] = sorter.items()[i]->fileitem();
+
+    return sorter.insertIndices(_fileItems, _dummyFileItem);
+}
+
+void ListModel::addIndices(FileItem *file)
+{
+    _nameNdx.insert(file->getName(), file);
+    _urlNdx.insert(file->getUrl(), file);
+}
+
+void ListModel::updateIndices()
 {
-    _fileItemNdx[file] = index(i, 0);
-    _nameNdx[file->getName()] = index(i, 0);
-    _urlNdx[file->getUrl()] = index(i, 0);
+    for (int i = _validIndices; i < _fileItems.count(); i++)
+        _fileItemNdx[_fileItems[i]] = index(i, 0);
+    _validIndices = _fileItems.count();
 }
 
 QString ListModel::toolTipText(FileItem *fileItem) const
@@ -37,6 +37,8 @@ public:
     }
     void populate(const QList<FileItem *> &files, FileItem *dummy);
     QModelIndex addItem(FileItem *);
+    /// Insert file items at their sorted position. A lot faster than adding them one by one.
+    void addItems(const QList<FileItem *> &files);
     void removeItem(FileItem *);
 
     int rowCount(const QModelIndex &parent = QModelIndex()) const override;
@@ -98,14 +100,24 @@ protected:
     QString nameWithoutExtension(const FileItem *fileitem, bool checkEnabled = true) const;
 
 private:
-    void updateIndices(FileItem *file, int index);
+    /// Return the positions for inserting the file items and sort them like the model
+    QVector<int> insertIndices(QList<FileItem *> &files);
+    /// Add the name and URL of a new file item to the indices
+    void addIndices(FileItem *file);
+    /// Update the row indices starting with the first changed row
+    void updateIndices();
+    /// Sort the file items and update the indices. Returns true if the order changed.
+    bool sortItems();
     QString toolTipText(FileItem *fileItem) const;
     static QString dateText(time_t time);
 
     QList<FileItem *> _fileItems;
+    // row indices of the file items, only rows before _validIndices are up to date; updated when
+    // needed, so that inserting and removing items is not linear
     QHash<FileItem *, QModelIndex> _fileItemNdx;
-    QHash<QString, QModelIndex> _nameNdx;
-    QHash<QUrl, QModelIndex> _urlNdx;
+    int _validIndices;
+    QHash<QString, FileItem *> _nameNdx;
+    QHash<QUrl, FileItem *> _urlNdx;
     bool _extensionEnabled;
     KrInterView *_view;
     FileItem *_dummyFileItem;
@@ -113,6 +125,7 @@ private:
     QFont _defaultFont;
     bool _justForSizeHint;
     bool _alternatingTable;
+    KrSort::SortKeyCache _sortKeyCache; // sort keys of the file items, kept for re-sorting
 };
 
 #endif // __listmodel__
@@ -288,15 +288,14 @@ void ListPanelFunc::doRefresh()
 
         // disconnect older signals
         disconnect(fileSystemP, nullptr, panel, nullptr);
+        disconnect(fileSystemP, &FileSystem::refreshFinished, this, nullptr);
 
+        fileSystemP->cancelRefresh();
         fileSystemP->deleteLater();
         fileSystemP = fileSystem; // v != 0 so this is safe
-    } else {
-        if (fileSystemP->isRefreshing()) {
-            // TODO remove busy waiting here
-            delayTimer.start(100); /* if filesystem is busy try refreshing later */
-            return;
-        }
+    } else if (fileSystemP->isRefreshing()) {
+        // abort the old refresh, it's not wanted anymore
+        fileSystemP->cancelRefresh();
     }
     // (re)connect filesystem signals
     disconnect(files(), nullptr, panel, nullptr);
@@ -312,17 +311,28 @@ void ListPanelFunc::doRefresh()
         panel->view->setNameToMakeCurrent(history->currentItem());
     }
 
-    // workaround for detecting panel deletion while filesystem is refreshing
-    QPointer<ListPanel> panelSave = panel;
-    // NOTE: this is blocking. Returns false on error or interruption (cancel requested or panel
-    // was deleted)
-    const bool scanned = fileSystemP->refresh(url);
+    // NOTE: this is not blocking, slotRefreshFinished() is called when done. The file items of a
+    // new directory are shown while scanning
+    _refreshUrl = url;
+    disconnect(fileSystemP, &FileSystem::refreshFinished, this, nullptr);
+    connect(fileSystemP, &FileSystem::refreshFinished, this, &ListPanelFunc::slotRefreshFinished);
+    if (!fileSystemP->refreshAsync(url))
+        slotRefreshFinished(false);
+}
+
+void ListPanelFunc::slotRefreshFinished(bool scanned)
+{
+    if (_refreshUrl.isEmpty()) {
+        // refresh was not started by us, e.g. by the directory watcher
+        return;
+    }
+    const QUrl url = _refreshUrl;
+    _refreshUrl = QUrl();
+
     if (scanned) {
         // update the history and address bar, as the actual url might differ from the one requested
         history->setCurrentUrl(fileSystemP->currentDirectory());
         panel->setNavigatorUrl(fileSystemP->currentDirectory());
-    } else if (!panelSave) {
-        return;
     }
 
     panel->view->setNameToMakeCurrent(QString());
@@ -131,6 +131,8 @@ public:
 protected slots:
     // Load the current url from history and refresh filesystem and panel to it
     void doRefresh();
+    // Finish refreshing to the current url
+    void slotRefreshFinished(bool scanned);
     void slotFileCreated(KJob *job, const QUrl filePath); // a file has been created by askEditFile() or slotStatEdit()
     void historyGotoPos(int pos);
     void clipboardChanged(QClipboard::Mode mode);
@@ -165,6 +167,7 @@ private:
     bool _isPaused; // do not refresh while panel is not visible
     bool _refreshAfterPaused; // refresh after not paused anymore
     QPointer<SizeCalculator> _quickSizeCalculator;
+    QUrl _refreshUrl; // the URL currently refreshed to, empty if not refreshing
 };
 
 #endif
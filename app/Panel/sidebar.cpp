@@ -261,7 +261,7 @@ void Sidebar::update(const FileItem *fileitem)
         dataLine->setText(i18n("View: %1", url.fileName()));
         break;
     case DskUsage: {
-        if (fileitem && !fileitem->isDir())
+        if (fileitem && !fileitem->isDir() && !DiskUsage::isSnapshotFile(url))
             url = KIO::upUrl(url);
         dataLine->setText(i18n("Disk Usage: %1", url.fileName()));
         diskusage->openUrl(url);
@@ -17,6 +17,7 @@
 #include <QApplication>
 #include <qplatformdefs.h>
 
+#include <KConfigGroup>
 #include <KIO/Global>
 
 #include "../Archive/krarchandler.h"
@@ -25,9 +26,12 @@
 #include "../FileSystem/krpermhandler.h"
 #include "../FileSystem/krquery.h"
 #include "../FileSystem/virtualfilesystem.h"
+#include "../defaults.h"
 #include "../krglobal.h"
+#include "localsearch.h"
 
 #define EVENT_PROCESS_DELAY 250 // milliseconds
+#define RESULT_BATCH_DELAY 100 // milliseconds
 
 static const QStringList TAR_TYPES = QStringList() << "tbz"
                                                    << "tgz"
@@ -62,9 +66,20 @@ void KrSearchMod::start()
 
     const QList<QUrl> whereToSearch = m_query->searchInDirs();
 
-    // search every dir that needs to be searched
-    for (int i = 0; i < whereToSearch.count(); ++i)
-        scanUrl(whereToSearch[i]);
+    QList<QUrl> localUrls;
+    for (const QUrl &url : whereToSearch) {
+        if (url.isLocalFile())
+            localUrls << url;
+    }
+    searchLocal(localUrls);
+
+    // search every other dir that needs to be searched and the archives found
+    for (int i = 0; i < whereToSearch.count(); ++i) {
+        if (!whereToSearch[i].isLocalFile())
+            scanUrl(whereToSearch[i]);
+    }
+    while (!m_unScannedUrls.isEmpty() && !m_stopSearch)
+        scanUrl(m_unScannedUrls.pop());
 
     emit finished();
 }
@@ -74,6 +89,47 @@ void KrSearchMod::stop()
     m_stopSearch = true;
 }
 
+void KrSearchMod::searchLocal(const QList<QUrl> &urls)
+{
+    if (urls.isEmpty() || m_stopSearch)
+        return;
+
+    QStringList directories;
+    for (const QUrl &url : urls)
+        directories << url.adjusted(QUrl::StripTrailingSlash).toLocalFile();
+
+    const KConfigGroup group(krConfig, "Look&Feel");
+    LocalSearch search(m_query, group.readEntry("Show Hidden", _ShowHidden));
+    search.start(directories);
+
+    // hand over the results in batches and keep the GUI responsive
+    bool done = false;
+    while (!done) {
+        done = search.wait(RESULT_BATCH_DELAY);
+
+        emit searching(search.status());
+
+        const QList<LocalSearch::Result> results = search.takeResults();
+        for (const LocalSearch::Result &result : results) {
+            if (!m_stopSearch)
+                emit found(*result.fileItem, result.foundText); // emitting copy of file item
+            delete result.fileItem;
+        }
+
+        const QList<QPair<QUrl, QString>> archives = search.takeArchiveCandidates();
+        for (const QPair<QUrl, QString> &archive : archives)
+            addArchive(archive.first, archive.second);
+
+        const QList<QUrl> errors = search.takeErrors();
+        for (const QUrl &url : errors)
+            emit error(url);
+
+        qApp->processEvents();
+        if (m_stopSearch)
+            search.stop();
+    }
+}
+
 void KrSearchMod::scanUrl(const QUrl &url)
 {
     if (m_stopSearch)
@@ -122,16 +178,9 @@ void KrSearchMod::scanDirectory(const QUrl &url)
             m_unScannedUrls.push(fileUrl);
         }
 
-        if (m_query->searchInArchives() && fileUrl.isLocalFile() && KrArcHandler::arcSupported(fileItem->getMime())) {
+        if (m_query->searchInArchives() && fileUrl.isLocalFile()) {
             // query search in archive; NOTE: only supported for local files
-            QUrl archiveURL = fileUrl;
-            bool encrypted;
-            const QString type = krArcMan.getType(encrypted, fileUrl.path(), fileItem->getMime());
-
-            if (!encrypted) {
-                archiveURL.setScheme(TAR_TYPES.contains(type) ? "tar" : "krarc");
-                m_unScannedUrls.push(archiveURL);
-            }
+            addArchive(fileUrl, fileItem->getMime());
         }
 
         if (m_query->match(fileItem)) {
@@ -148,6 +197,23 @@ void KrSearchMod::scanDirectory(const QUrl &url)
     }
 }
 
+void KrSearchMod::addArchive(const QUrl &fileUrl, const QString &mime)
+{
+    auto supported = m_archiveMimes.constFind(mime);
+    if (supported == m_archiveMimes.constEnd())
+        supported = m_archiveMimes.insert(mime, KrArcHandler::arcSupported(mime));
+    if (!*supported)
+        return;
+
+    bool encrypted;
+    const QString type = krArcMan.getType(encrypted, fileUrl.path(), mime);
+    if (!encrypted) {
+        QUrl archiveURL = fileUrl;
+        archiveURL.setScheme(TAR_TYPES.contains(type) ? "tar" : "krarc");
+        m_unScannedUrls.push(archiveURL);
+    }
+}
+
 FileSystem *KrSearchMod::getFileSystem(const QUrl &url)
 {
     FileSystem *fileSystem;
@@ -12,6 +12,7 @@
 // QtCore
 #include <QDateTime>
 #include <QElapsedTimer>
+#include <QHash>
 #include <QObject>
 #include <QStack>
 #include <QStringList>
@@ -29,6 +30,10 @@ class VirtualFileSystem;
  * Search for files based on a search query.
  *
  * Subdirectories are included if query->isRecursive() is true.
+ *
+ * Local folders are searched with several threads (see LocalSearch), other URLs and archives
+ * one folder after another. start() returns when the search is done; events are processed
+ * while searching.
  */
 class KrSearchMod : public QObject
 {
@@ -41,8 +46,12 @@ public:
     void stop();
 
 private:
+    /// Search local folders in parallel; archives found are added to the unscanned URLs
+    void searchLocal(const QList<QUrl> &urls);
     void scanUrl(const QUrl &url);
     void scanDirectory(const QUrl &url);
+    /// Add the archive URL of a file to the unscanned URLs if it is a supported archive
+    void addArchive(const QUrl &fileUrl, const QString &mime);
     FileSystem *getFileSystem(const QUrl &url);
 
 signals:
@@ -65,6 +74,7 @@ private:
     QStack<QUrl> m_scannedUrls;
     QStack<QUrl> m_unScannedUrls;
     QElapsedTimer m_timer;
+    QHash<QString, bool> m_archiveMimes; //< cache: is an archive with this MIME type supported
 };
 
 #endif
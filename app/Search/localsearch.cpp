@@ -0,0 +1,313 @@
+/*
+    SPDX-FileCopyrightText: 2026 Krusader Krew <https://krusader.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "localsearch.h"
+
+// QtCore
+#include <QElapsedTimer>
+#include <QFile>
+#include <QMutexLocker>
+#include <QSemaphore>
+#include <QThread>
+
+#ifdef Q_OS_LINUX
+#include <sys/sysmacros.h>
+#endif
+
+#include "../FileSystem/defaultfilesystem.h"
+#include "../FileSystem/fileitem.h"
+#include "../FileSystem/krquery.h"
+#include "../FileSystem/locallister.h"
+
+// number of threads reading from the same spinning disk; more than one lets the disk reorder
+// requests, more would only make it seek
+static const int ROTATIONAL_DISK_THREADS = 2;
+// limit for fast devices, more threads don't help if listing is bound by the filesystem
+static const int MAX_THREADS = 16;
+// how long (ms) a thread waits for a free device slot before checking for stop requests
+static const int DEVICE_WAIT_INTERVAL = 100;
+
+class LocalSearchThread : public QThread
+{
+public:
+    LocalSearchThread(LocalSearch *search, int worker)
+        : m_search(search)
+        , m_worker(worker)
+    {
+    }
+
+protected:
+    void run() override
+    {
+        m_search->work(m_worker);
+    }
+
+private:
+    LocalSearch *const m_search;
+    const int m_worker;
+};
+
+LocalSearch::LocalSearch(const KrQuery *query, bool showHidden)
+    : m_showHidden(showHidden)
+    , m_threadCount(qBound(1, QThread::idealThreadCount(), MAX_THREADS))
+{
+    for (int i = 0; i < m_threadCount; ++i) {
+        auto *threadQuery = new KrQuery(*query);
+        // progress of content searches and stop requests; direct calls from the search thread
+        QObject::connect(threadQuery, &KrQuery::status, [this](const QString &message) {
+            setStatus(message);
+        });
+        QObject::connect(threadQuery, &KrQuery::processEvents, [this](bool &stopped) {
+            stopped = m_stopped.loadAcquire();
+        });
+        m_queries << threadQuery;
+        m_queues << new WorkQueue;
+        m_threads << new LocalSearchThread(this, i);
+    }
+}
+
+LocalSearch::~LocalSearch()
+{
+    stop();
+    for (QThread *thread : qAsConst(m_threads))
+        thread->wait();
+
+    qDeleteAll(m_threads);
+    qDeleteAll(m_queries);
+    qDeleteAll(m_queues);
+    qDeleteAll(m_deviceSlots);
+    for (const Result &result : qAsConst(m_results))
+        delete result.fileItem;
+}
+
+void LocalSearch::start(const QStringList &directories)
+{
+    // distribute the folders, other threads would steal them anyway
+    for (int i = 0; i < directories.count(); ++i)
+        addDirectory(i % m_threadCount, directories[i]);
+
+    for (QThread *thread : qAsConst(m_threads))
+        thread->start();
+}
+
+void LocalSearch::stop()
+{
+    m_stopped.storeRelease(1);
+
+    QMutexLocker locker(&m_idleMutex);
+    m_directoryAdded.wakeAll();
+}
+
+bool LocalSearch::wait(unsigned long msecs)
+{
+    QElapsedTimer timer;
+    timer.start();
+    for (QThread *thread : qAsConst(m_threads)) {
+        const qint64 remaining = static_cast<qint64>(msecs) - timer.elapsed();
+        if (!thread->wait(static_cast<unsigned long>(qMax<qint64>(remaining, 0))))
+            return false;
+    }
+    return true;
+}
+
+QList<LocalSearch::Result> LocalSearch::takeResults()
+{
+    QMutexLocker locker(&m_mutex);
+    QList<Result> results;
+    results.swap(m_results);
+    return results;
+}
+
+QList<QPair<QUrl, QString>> LocalSearch::takeArchiveCandidates()
+{
+    QMutexLocker locker(&m_mutex);
+    QList<QPair<QUrl, QString>> candidates;
+    candidates.swap(m_archiveCandidates);
+    return candidates;
+}
+
+QList<QUrl> LocalSearch::takeErrors()
+{
+    QMutexLocker locker(&m_mutex);
+    QList<QUrl> errors;
+    errors.swap(m_errors);
+    return errors;
+}
+
+QString LocalSearch::status()
+{
+    QMutexLocker locker(&m_mutex);
+    return m_status;
+}
+
+void LocalSearch::setStatus(const QString &status)
+{
+    QMutexLocker locker(&m_mutex);
+    m_status = status;
+}
+
+void LocalSearch::work(int worker)
+{
+    QString directory;
+    while (takeDirectory(worker, directory)) {
+        if (!m_stopped.loadAcquire())
+            searchDirectory(worker, directory);
+        finishDirectory();
+    }
+}
+
+bool LocalSearch::takeDirectory(int worker, QString &directory)
+{
+    while (!m_stopped.loadAcquire()) {
+        // own queue first: the folder added last
+        {
+            WorkQueue *queue = m_queues[worker];
+            QMutexLocker locker(&queue->mutex);
+            if (!queue->directories.isEmpty()) {
+                directory = queue->directories.takeLast();
+                m_queuedDirectories.fetchAndAddOrdered(-1);
+                return true;
+            }
+        }
+        // steal the oldest folder of another thread, it probably has the most subfolders
+        for (int i = 1; i < m_threadCount; ++i) {
+            WorkQueue *queue = m_queues[(worker + i) % m_threadCount];
+            QMutexLocker locker(&queue->mutex);
+            if (!queue->directories.isEmpty()) {
+                directory = queue->directories.takeFirst();
+                m_queuedDirectories.fetchAndAddOrdered(-1);
+                return true;
+            }
+        }
+
+        QMutexLocker locker(&m_idleMutex);
+        if (m_pendingDirectories.loadAcquire() == 0)
+            return false; // all done
+        m_idleWorkers.fetchAndAddOrdered(1);
+        if (m_queuedDirectories.loadAcquire() == 0 && !m_stopped.loadAcquire())
+            m_directoryAdded.wait(&m_idleMutex);
+        m_idleWorkers.fetchAndAddOrdered(-1);
+    }
+    return false;
+}
+
+void LocalSearch::addDirectory(int worker, const QString &directory)
+{
+    m_pendingDirectories.fetchAndAddOrdered(1);
+    {
+        WorkQueue *queue = m_queues[worker];
+        QMutexLocker locker(&queue->mutex);
+        queue->directories.append(directory);
+    }
+    m_queuedDirectories.fetchAndAddOrdered(1);
+
+    if (m_idleWorkers.loadAcquire() > 0) {
+        QMutexLocker locker(&m_idleMutex);
+        m_directoryAdded.wakeOne();
+    }
+}
+
+void LocalSearch::finishDirectory()
+{
+    if (m_pendingDirectories.fetchAndAddOrdered(-1) == 1) {
+        // the last folder is done, wake up the waiting threads to finish
+        QMutexLocker locker(&m_idleMutex);
+        m_directoryAdded.wakeAll();
+    }
+}
+
+void LocalSearch::searchDirectory(int worker, const QString &directory)
+{
+    LocalLister lister(directory);
+    if (!lister.open() || !lister.isSearchable()) {
+        QMutexLocker locker(&m_mutex);
+        m_errors << QUrl::fromLocalFile(directory);
+        return;
+    }
+
+    // don't search a folder twice, e.g. when following symlinks in a loop
+    dev_t device = 0;
+    ino_t inode = 0;
+    if (lister.directoryId(device, inode)) {
+        QMutexLocker locker(&m_mutex);
+        const QPair<quint64, quint64> id(device, inode);
+        if (m_visitedDirectories.contains(id))
+            return;
+        m_visitedDirectories.insert(id);
+    }
+
+    QSemaphore *deviceSemaphore = deviceSlots(device);
+    while (!deviceSemaphore->tryAcquire(1, DEVICE_WAIT_INTERVAL)) {
+        if (m_stopped.loadAcquire())
+            return;
+    }
+
+    setStatus(directory);
+
+    if (!m_showHidden)
+        lister.setSkipHidden(DefaultFileSystem::filesInDotHidden(directory));
+
+    KrQuery *query = m_queries[worker];
+    const QString pathPrefix = directory.endsWith('/') ? directory : directory + '/';
+
+    QList<Result> results;
+    QList<QPair<QUrl, QString>> archiveCandidates;
+    QByteArray encodedName;
+    unsigned char type;
+    while (lister.next(encodedName, type) && !m_stopped.loadAcquire()) {
+        FileItem *fileItem = lister.createFileItem(encodedName, type);
+
+        if (query->isRecursive() && ((!fileItem->isSymLink() && fileItem->isDir()) || (fileItem->isSymLink() && query->followLinks()))) {
+            // search in subfolder
+            const QString path = pathPrefix + fileItem->getName();
+            if (!query->isExcluded(QUrl::fromLocalFile(path)))
+                addDirectory(worker, path);
+        }
+
+        if (query->searchInArchives() && !fileItem->isDir())
+            archiveCandidates << qMakePair(fileItem->getUrl(), fileItem->getMime());
+
+        if (query->match(fileItem))
+            results << Result{fileItem, query->foundText()};
+        else
+            delete fileItem;
+    }
+
+    deviceSemaphore->release();
+
+    if (!results.isEmpty() || !archiveCandidates.isEmpty() || lister.error()) {
+        QMutexLocker locker(&m_mutex);
+        m_results.append(results);
+        m_archiveCandidates.append(archiveCandidates);
+        if (lister.error())
+            m_errors << QUrl::fromLocalFile(directory);
+    }
+}
+
+QSemaphore *LocalSearch::deviceSlots(dev_t device)
+{
+    QMutexLocker locker(&m_mutex);
+    QSemaphore *&deviceSemaphore = m_deviceSlots[device];
+    if (!deviceSemaphore)
+        deviceSemaphore = new QSemaphore(maxThreadsForDevice(device));
+    return deviceSemaphore;
+}
+
+int LocalSearch::maxThreadsForDevice(dev_t device) const
+{
+#ifdef Q_OS_LINUX
+    // the block device of a partition has no queue attributes, they are found at the disk
+    const QString devicePath = QStringLiteral("/sys/dev/block/%1:%2/").arg(major(device)).arg(minor(device));
+    QFile rotational(devicePath + QLatin1String("queue/rotational"));
+    if (!rotational.exists())
+        rotational.setFileName(devicePath + QLatin1String("../queue/rotational"));
+    if (rotational.open(QIODevice::ReadOnly) && rotational.read(1) == "1")
+        return qMin(ROTATIONAL_DISK_THREADS, m_threadCount);
+#else
+    Q_UNUSED(device)
+#endif
+    return m_threadCount;
+}
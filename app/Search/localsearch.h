@@ -0,0 +1,132 @@
+/*
+    SPDX-FileCopyrightText: 2026 Krusader Krew <https://krusader.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef LOCALSEARCH_H
+#define LOCALSEARCH_H
+
+// QtCore
+#include <QAtomicInt>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QPair>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QUrl>
+#include <QVector>
+#include <QWaitCondition>
+
+#include <sys/types.h>
+
+class FileItem;
+class KrQuery;
+class QSemaphore;
+class QThread;
+
+/**
+ * Searches local folders recursively with several threads.
+ *
+ * Each thread has its own queue of folders; a thread takes the folder it added last (depth first,
+ * keeps the working set small) and steals the oldest folder of another thread when its own queue
+ * is empty. Every thread matches with its own copy of the query.
+ *
+ * The number of threads reading from the same device at the same time is limited; only a few
+ * threads read from a spinning disk, so the disk heads are not sent back and forth.
+ *
+ * Results are collected and can be taken in batches from the GUI thread with takeResults(), the
+ * folders which could not be read with takeErrors().
+ *
+ * Usage:
+ * @code
+ * LocalSearch search(query, showHidden);
+ * search.start(paths);
+ * while (!search.wait(100)) {
+ *     for (const LocalSearch::Result &result : search.takeResults())
+ *         ...
+ * }
+ * @endcode
+ */
+class LocalSearch
+{
+public:
+    struct Result {
+        FileItem *fileItem; //< the matching file item, owned by the receiver
+        QString foundText; //< the found text for content searches
+    };
+
+    /**
+     * @param query the search query, copied for each thread
+     * @param showHidden if false, hidden files and files in ".hidden" files are not searched
+     */
+    LocalSearch(const KrQuery *query, bool showHidden);
+    /// Stops the search and waits for the threads
+    ~LocalSearch();
+
+    /// Start searching in local folders (absolute paths)
+    void start(const QStringList &directories);
+    /// Stop searching as soon as possible
+    void stop();
+    /// Wait until the search is done or the time (ms) passed. Returns true if done.
+    bool wait(unsigned long msecs);
+
+    /// Take the results found so far. Thread-safe.
+    QList<Result> takeResults();
+    /// Take the URLs and MIME types of all files found so far which could be archives. Only
+    /// collected if the query searches in archives. Thread-safe.
+    QList<QPair<QUrl, QString>> takeArchiveCandidates();
+    /// Take the URLs of the folders found so far which could not be read. Thread-safe.
+    QList<QUrl> takeErrors();
+    /// The last status message: the folder entered last or the progress of a content search. Thread-safe.
+    QString status();
+
+private:
+    struct WorkQueue {
+        QMutex mutex;
+        QList<QString> directories;
+    };
+
+    friend class LocalSearchThread;
+    /// Search folders until all are done; executed by the search threads
+    void work(int worker);
+    /// Take a folder to search, wait if there is none. Returns false if the search is done.
+    bool takeDirectory(int worker, QString &directory);
+    /// Add a folder to the queue of a thread
+    void addDirectory(int worker, const QString &directory);
+    /// Mark a folder as done which was taken with takeDirectory()
+    void finishDirectory();
+    void setStatus(const QString &status);
+    void searchDirectory(int worker, const QString &directory);
+    /// Return the semaphore limiting the threads reading from a device
+    QSemaphore *deviceSlots(dev_t device);
+    int maxThreadsForDevice(dev_t device) const;
+
+    const bool m_showHidden;
+    const int m_threadCount;
+    QVector<KrQuery *> m_queries; //< the query copy of each thread
+    QVector<WorkQueue *> m_queues; //< the folder queue of each thread
+    QVector<QThread *> m_threads;
+
+    QAtomicInt m_stopped;
+    QAtomicInt m_pendingDirectories; //< folders in queues or being searched
+    QAtomicInt m_queuedDirectories; //< folders in queues
+    QAtomicInt m_idleWorkers; //< threads waiting for new folders
+
+    QMutex m_idleMutex; //< protects waiting for m_directoryAdded
+    QWaitCondition m_directoryAdded;
+
+    QMutex m_mutex; //< protects all following members
+    QSet<QPair<quint64, quint64>> m_visitedDirectories; //< device and inode of searched folders
+    QHash<quint64, QSemaphore *> m_deviceSlots;
+    QList<Result> m_results;
+    QList<QPair<QUrl, QString>> m_archiveCandidates;
+    QList<QUrl> m_errors; //< the folders which could not be read
+    QString m_status;
+
+    Q_DISABLE_COPY(LocalSearch)
+};
+
+#endif // LOCALSEARCH_H
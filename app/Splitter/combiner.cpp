@@ -6,10 +6,13 @@
 */
 
 #include "combiner.h"
+#include "localtransfer.h"
 #include "../FileSystem/filesystem.h"
 
 // QtCore
+#include <QFile>
 #include <QFileInfo>
+#include <QTimer>
 
 #include <KFileItem>
 #include <KIO/Job>
@@ -19,6 +22,8 @@
 #include <kio_version.h>
 #include <utility>
 
+#include <sys/stat.h>
+
 // TODO: delete destination file on error
 // TODO: cache more than one byte array of data
 
@@ -33,6 +38,8 @@ Combiner::Combiner(QWidget *parent, QUrl baseURLIn, QUrl destinationURLIn, bool
     , statJob(nullptr)
     , combineReadJob(nullptr)
     , combineWriteJob(nullptr)
+    , localTransfer(nullptr)
+    , progressTimer(nullptr)
     , unixNaming(unixNamingIn)
 {
     crcContext = new CRC32();
@@ -179,7 +186,7 @@ void Combiner::statDestResult(KJob *job)
 
     if (job->error()) {
         if (job->error() == KIO::ERR_DOES_NOT_EXIST) {
-            openNextFile();
+            startCombining();
         } else {
             dynamic_cast<KIO::Job *>(job)->uiDelegate()->showErrorMessage();
             reject();
@@ -189,7 +196,7 @@ void Combiner::statDestResult(KJob *job)
         KIO::RenameDialog dlg(this, i18n("File Already Exists"), QUrl(), writeURL, mode);
         switch (dlg.exec()) {
         case KIO::Result_Overwrite:
-            openNextFile();
+            startCombining();
             break;
         case KIO::Result_Rename: {
             writeURL = dlg.newDestUrl();
@@ -202,7 +209,16 @@ void Combiner::statDestResult(KJob *job)
     }
 }
 
-void Combiner::openNextFile()
+void Combiner::startCombining()
+{
+    if (baseURL.isLocalFile() && writeURL.isLocalFile()) {
+        if (!startLocalCombine())
+            reject();
+    } else
+        openNextFile();
+}
+
+void Combiner::nextReadURL()
 {
     if (unixNaming) {
         if (readURL.isEmpty())
@@ -230,6 +246,11 @@ void Combiner::openNextFile()
         readURL = baseURL.adjusted(QUrl::RemoveFilename);
         readURL.setPath(readURL.path() + baseURL.fileName() + '.' + index);
     }
+}
+
+void Combiner::openNextFile()
+{
+    nextReadURL();
 
     /* creating a read job */
     combineReadJob = KIO::get(readURL, KIO::NoReload, KIO::HideProgressInfo);
@@ -245,7 +266,7 @@ void Combiner::combineDataReceived(KIO::Job *, const QByteArray &byteArray)
     if (byteArray.size() == 0)
         return;
 
-    crcContext->update(reinterpret_cast<unsigned char *>(const_cast<char *>(byteArray.data())), byteArray.size());
+    crcContext->update(reinterpret_cast<const unsigned char *>(byteArray.constData()), byteArray.size());
     transferArray = QByteArray(byteArray.data(), byteArray.length());
 
     receivedSize += byteArray.size();
@@ -278,14 +299,7 @@ void Combiner::combineReceiveFinished(KJob *job)
                 // write out the remaining part of the file
                 combineWriteJob->resume();
 
-                if (hasValidSplitFile) {
-                    QString crcResult = QString("%1").arg(crcContext->result(), 0, 16).toUpper().trimmed().rightJustified(8, '0');
-
-                    if (receivedSize != expectedSize)
-                        error = i18n("Incorrect filesize, the file might have been corrupted.");
-                    else if (crcResult != expectedCrcSum.toUpper().trimmed())
-                        error = i18n("Incorrect CRC checksum, the file might have been corrupted.");
-                }
+                error = validate(crcContext->result());
             }
         } else {
             combineAbortJobs();
@@ -334,6 +348,11 @@ void Combiner::combineAbortJobs()
         combineWriteJob->kill(KJob::Quietly);
 
     statJob = combineReadJob = combineWriteJob = nullptr;
+
+    if (localTransfer)
+        localTransfer->cancel();
+    if (progressTimer)
+        progressTimer->stop();
 }
 
 void Combiner::combineWritePercent(KJob *, unsigned long)
@@ -341,3 +360,98 @@ void Combiner::combineWritePercent(KJob *, unsigned long)
     auto percent = static_cast<int>(((static_cast<long double>(receivedSize) / expectedSize) * 100.) + 0.5);
     setValue(percent);
 }
+
+QString Combiner::validate(unsigned long crc) const
+{
+    if (!hasValidSplitFile)
+        return QString();
+
+    QString crcResult = QString("%1").arg(crc, 0, 16).toUpper().trimmed().rightJustified(8, '0');
+
+    if (receivedSize != expectedSize)
+        return i18n("Incorrect filesize, the file might have been corrupted.");
+    if (crcResult != expectedCrcSum.toUpper().trimmed())
+        return i18n("Incorrect CRC checksum, the file might have been corrupted.");
+    return QString();
+}
+
+bool Combiner::startLocalCombine()
+{
+    const QString target = writeURL.toLocalFile();
+
+    // the split files are known before the transfer, which reads them all at once
+    QList<LocalTransfer::Range> ranges;
+    qint64 offset = 0;
+    while (true) {
+        nextReadURL();
+        if (unixNaming && !ranges.isEmpty() && readURL == baseURL)
+            break; // the names wrapped around
+
+        const QFileInfo part(readURL.toLocalFile());
+        if (!part.isFile()) {
+            if (!unixNaming && fileCounter == 1) { // .000 file doesn't exist but .001 is still a valid first file
+                firstFileIs000 = false;
+                continue;
+            }
+            if (ranges.isEmpty()) {
+                KMessageBox::error(nullptr, i18n("Cannot open the first split file of %1.", baseURL.toDisplayString(QUrl::PreferLocalFile)));
+                return false;
+            }
+            break; // we've found the last file
+        }
+
+        ranges.append({part.filePath(), 0, target, offset, part.size()});
+        offset += part.size();
+    }
+    receivedSize = static_cast<KIO::filesize_t>(offset);
+
+    QFile output(target);
+    if (!output.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        KMessageBox::error(nullptr, i18n("Error writing file %1: %2", writeURL.toDisplayString(QUrl::PreferLocalFile), output.errorString()));
+        return false;
+    }
+    if (permissions != -1)
+        fchmod(output.handle(), static_cast<mode_t>((permissions & 0777) | S_IWUSR));
+    output.resize(offset); // the parts are written at their offsets, in any order
+    output.close();
+
+    localTransfer = new LocalTransfer(this);
+    connect(localTransfer, &LocalTransfer::finished, this, &Combiner::localCombineFinished);
+    connect(this, &QProgressDialog::canceled, this, [this]() {
+        combineAbortJobs();
+        reject();
+    });
+
+    progressTimer = new QTimer(this);
+    progressTimer->setInterval(100);
+    connect(progressTimer, &QTimer::timeout, this, &Combiner::localCombineProgress);
+    progressTimer->start();
+
+    localTransfer->start(ranges);
+    return true;
+}
+
+void Combiner::localCombineProgress()
+{
+    if (receivedSize)
+        setValue(static_cast<int>(localTransfer->bytesDone() * 100 / static_cast<qint64>(receivedSize)));
+}
+
+void Combiner::localCombineFinished()
+{
+    progressTimer->stop();
+
+    if (localTransfer->errorString().isEmpty())
+        error = validate(localTransfer->crc());
+    else
+        error = localTransfer->errorString();
+
+    if (!error.isEmpty()) {
+        KMessageBox::error(nullptr, error);
+        reject();
+        return;
+    }
+
+    setValue(100);
+    accept();
+}
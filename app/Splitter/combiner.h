@@ -18,6 +18,9 @@
 
 #include "crc32.h"
 
+class LocalTransfer;
+class QTimer;
+
 class Combiner : public QProgressDialog
 {
     Q_OBJECT
@@ -38,9 +41,18 @@ private slots:
     void combineDataSend(KIO::Job *, QByteArray &);
     void combineSendFinished(KJob *);
     void combineWritePercent(KJob *, unsigned long);
+    void localCombineProgress();
+    void localCombineFinished();
 
 private:
+    void startCombining();
+    /// Advance readURL to the next split file
+    void nextReadURL();
     void openNextFile();
+    /// Combine local split files to a local file without KIO, return false if it did not start
+    bool startLocalCombine();
+    /// Check the size and CRC of the output against the CRC file, return the error if they differ
+    QString validate(unsigned long crc) const;
     void combineAbortJobs();
 
     QUrl splURL;
@@ -68,6 +80,8 @@ private:
     KIO::Job *statJob;
     KIO::TransferJob *combineReadJob;
     KIO::TransferJob *combineWriteJob;
+    LocalTransfer *localTransfer;
+    QTimer *progressTimer;
 
     bool unixNaming;
 };
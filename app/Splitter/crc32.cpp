@@ -7,38 +7,236 @@
 
 #include "crc32.h"
 
-#define MASK1 0x00FFFFFF
+#include <cstring>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define CRC32_PCLMUL
+#include <immintrin.h>
+#endif
+
 #define MASK2 0xFFFFFFFF
 #define POLYNOMIAL 0xEDB88320
 
-bool CRC32::crc_initialized = false;
-unsigned long CRC32::crc_table[256];
-
-CRC32::CRC32(unsigned long initialValue)
+namespace
 {
-    crc_accum = initialValue;
+struct Tables {
+    uint32_t slice[8][256];
+    uint32_t x2n[32]; // x^(2^n) modulo the polynomial, for combine()
 
-    if (!crc_initialized) {
-        for (int byte = 0; byte != 256; byte++) {
-            unsigned long data = byte;
+    Tables()
+    {
+        for (uint32_t byte = 0; byte != 256; byte++) {
+            uint32_t data = byte;
 
             for (int i = 8; i > 0; --i)
                 data = data & 1 ? (data >> 1) ^ POLYNOMIAL : data >> 1;
 
-            crc_table[byte] = data;
+            slice[0][byte] = data;
         }
 
-        crc_initialized = true;
+        // slice[k][byte] is the CRC of the byte followed by k zero bytes
+        for (int k = 1; k != 8; k++) {
+            for (int byte = 0; byte != 256; byte++)
+                slice[k][byte] = (slice[k - 1][byte] >> 8) ^ slice[0][slice[k - 1][byte] & 0xff];
+        }
+
+        uint32_t p = (uint32_t)1 << 30; // x^1
+        x2n[0] = p;
+        for (int n = 1; n != 32; n++)
+            x2n[n] = p = multiply(p, p);
     }
+
+    // multiply two polynomials modulo the CRC polynomial, the bits are reflected
+    static uint32_t multiply(uint32_t a, uint32_t b)
+    {
+        uint32_t m = (uint32_t)1 << 31, p = 0;
+        for (;;) {
+            if (a & m) {
+                p ^= b;
+                if ((a & (m - 1)) == 0)
+                    break;
+            }
+            m >>= 1;
+            b = b & 1 ? (b >> 1) ^ POLYNOMIAL : b >> 1;
+        }
+        return p;
+    }
+};
+
+const Tables &tables()
+{
+    static const Tables instance;
+    return instance;
 }
 
-void CRC32::update(unsigned char *buffer, int bufferLen)
+uint32_t updateBytes(uint32_t crc, const unsigned char *buffer, size_t length)
 {
-    while (bufferLen-- > 0)
-        crc_accum = ((crc_accum >> 8) & MASK1) ^ crc_table[(crc_accum & 0xff) ^ *buffer++];
+    const uint32_t(&table)[256] = tables().slice[0];
+    while (length-- > 0)
+        crc = (crc >> 8) ^ table[(crc & 0xff) ^ *buffer++];
+    return crc;
+}
+
+uint32_t updateSliced(uint32_t crc, const unsigned char *buffer, size_t length)
+{
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    const uint32_t(&table)[8][256] = tables().slice;
+    while (length >= 8) {
+        uint32_t one, two;
+        memcpy(&one, buffer, 4);
+        memcpy(&two, buffer + 4, 4);
+        one ^= crc;
+        crc = table[7][one & 0xff] ^ table[6][(one >> 8) & 0xff] ^ table[5][(one >> 16) & 0xff] ^ table[4][one >> 24] ^ table[3][two & 0xff]
+            ^ table[2][(two >> 8) & 0xff] ^ table[1][(two >> 16) & 0xff] ^ table[0][two >> 24];
+        buffer += 8;
+        length -= 8;
+    }
+#endif
+    return updateBytes(crc, buffer, length);
+}
+
+#ifdef CRC32_PCLMUL
+// Folding with carry-less multiplication, following "Fast CRC Computation for Generic Polynomials
+// Using PCLMULQDQ Instruction" by Intel. Needs at least 64 bytes, a multiple of 16.
+__attribute__((target("pclmul,sse4.1"))) uint32_t updateFolded(uint32_t crc, const unsigned char *buffer, size_t length)
+{
+    alignas(16) static const uint64_t k1k2[] = {0x0154442bd4, 0x01c6e41596};
+    alignas(16) static const uint64_t k3k4[] = {0x01751997d0, 0x00ccaa009e};
+    alignas(16) static const uint64_t k5k0[] = {0x0163cd6124, 0x0000000000};
+    alignas(16) static const uint64_t poly[] = {0x01db710641, 0x01f7011641};
+
+    __m128i x0, x1, x2, x3, x4, x5, x6, x7, x8, y5, y6, y7, y8;
+
+    x1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(buffer + 0x00));
+    x2 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(buffer + 0x10));
+    x3 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(buffer + 0x20));
+    x4 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(buffer + 0x30));
+
+    x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128(static_cast<int>(crc)));
+
+    x0 = _mm_load_si128(reinterpret_cast<const __m128i *>(k1k2));
+
+    buffer += 64;
+    length -= 64;
+
+    // fold four blocks of 16 bytes in parallel
+    while (length >= 64) {
+        x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x6 = _mm_clmulepi64_si128(x2, x0, 0x00);
+        x7 = _mm_clmulepi64_si128(x3, x0, 0x00);
+        x8 = _mm_clmulepi64_si128(x4, x0, 0x00);
+
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+        x2 = _mm_clmulepi64_si128(x2, x0, 0x11);
+        x3 = _mm_clmulepi64_si128(x3, x0, 0x11);
+        x4 = _mm_clmulepi64_si128(x4, x0, 0x11);
+
+        y5 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(buffer + 0x00));
+        y6 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(buffer + 0x10));
+        y7 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(buffer + 0x20));
+        y8 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(buffer + 0x30));
+
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), y5);
+        x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), y6);
+        x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), y7);
+        x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), y8);
+
+        buffer += 64;
+        length -= 64;
+    }
+
+    // fold into 128 bits
+    x0 = _mm_load_si128(reinterpret_cast<const __m128i *>(k3k4));
+
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+
+    // fold the remaining blocks of 16 bytes one by one
+    while (length >= 16) {
+        x2 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(buffer));
+
+        x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+
+        buffer += 16;
+        length -= 16;
+    }
+
+    // fold 128 bits to 64 bits
+    x2 = _mm_clmulepi64_si128(x1, x0, 0x10);
+    x3 = _mm_setr_epi32(~0, 0, ~0, 0);
+    x1 = _mm_srli_si128(x1, 8);
+    x1 = _mm_xor_si128(x1, x2);
+
+    x0 = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(k5k0));
+
+    x2 = _mm_srli_si128(x1, 4);
+    x1 = _mm_and_si128(x1, x3);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    // Barrett reduction to 32 bits
+    x0 = _mm_load_si128(reinterpret_cast<const __m128i *>(poly));
+
+    x2 = _mm_and_si128(x1, x3);
+    x2 = _mm_clmulepi64_si128(x2, x0, 0x10);
+    x2 = _mm_and_si128(x2, x3);
+    x2 = _mm_clmulepi64_si128(x2, x0, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    return static_cast<uint32_t>(_mm_extract_epi32(x1, 1));
+}
+
+bool hasPclmul()
+{
+    static const bool supported = __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse4.1");
+    return supported;
+}
+#endif
+}
+
+CRC32::CRC32(unsigned long initialValue)
+    : crc_accum(static_cast<uint32_t>(initialValue))
+{
+    tables(); // build the tables before the first update
+}
+
+void CRC32::update(const unsigned char *buffer, size_t bufferLen)
+{
+#ifdef CRC32_PCLMUL
+    if (bufferLen >= 64 && hasPclmul()) {
+        const size_t folded = bufferLen & ~(size_t)15;
+        crc_accum = updateFolded(crc_accum, buffer, folded);
+        buffer += folded;
+        bufferLen -= folded;
+    }
+#endif
+    crc_accum = updateSliced(crc_accum, buffer, bufferLen);
 }
 
 unsigned long CRC32::result()
 {
     return (~crc_accum) & MASK2;
 }
+
+unsigned long CRC32::combine(unsigned long crc1, unsigned long crc2, uint64_t len2)
+{
+    // shift the first CRC over the length of the second piece: multiply by x^(8 * len2)
+    const Tables &t = tables();
+    uint32_t shift = (uint32_t)1 << 31; // x^0
+    for (int n = 3; len2 != 0; len2 >>= 1, n++) {
+        if (len2 & 1)
+            shift = Tables::multiply(t.x2n[n & 31], shift);
+    }
+    return (Tables::multiply(shift, static_cast<uint32_t>(crc1)) ^ static_cast<uint32_t>(crc2)) & MASK2;
+}
@@ -8,18 +8,30 @@
 #ifndef CRC32_H
 #define CRC32_H
 
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * The CRC-32 of zip and gzip (reflected polynomial 0xEDB88320).
+ *
+ * The data is processed eight bytes at a time with the slicing-by-8 tables, or by folding with
+ * carry-less multiplication on x86-64 processors which support PCLMULQDQ. The implementation is
+ * chosen at runtime, all of them give the same results.
+ */
 class CRC32
 {
 private:
-    unsigned long crc_accum;
-    static unsigned long crc_table[256];
-    static bool crc_initialized;
+    uint32_t crc_accum;
 
 public:
     explicit CRC32(unsigned long initialValue = (unsigned long)-1);
 
-    void update(unsigned char *buffer, int bufferLen);
+    void update(const unsigned char *buffer, size_t bufferLen);
     unsigned long result();
+
+    /// The CRC of two pieces of data, from the CRC of the first one, the CRC of the second one and its
+    /// length. The CRCs of the pieces of a file can so be calculated independently of each other.
+    static unsigned long combine(unsigned long crc1, unsigned long crc2, uint64_t len2);
 };
 
 #endif /* __CRC32_H__ */
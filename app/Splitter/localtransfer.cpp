@@ -0,0 +1,271 @@
+/*
+    SPDX-FileCopyrightText: 2026 Krusader Krew <https://krusader.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "localtransfer.h"
+#include "crc32.h"
+
+// QtCore
+#include <QFile>
+#include <QMutexLocker>
+#include <QThread>
+#include <QtConcurrent/QtConcurrentRun> // krazy:exclude=includes
+
+#include <KLocalizedString>
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// the part of the source mapped into the memory at a time
+static const qint64 WINDOW_SIZE = 64 * 1024 * 1024;
+// the buffer of the sources which can't be mapped
+static const int BUFFER_SIZE = 1024 * 1024;
+// the number of ranges copied at a time, they are mostly on the same disk
+static const int MAX_THREADS = 4;
+
+#ifdef Q_OS_LINUX
+typedef loff_t CopyOffset;
+#else
+typedef off_t CopyOffset;
+#endif
+
+namespace
+{
+class FileDescriptor
+{
+public:
+    FileDescriptor(const QString &path, int flags)
+        : fd(::open(QFile::encodeName(path).constData(), flags | O_CLOEXEC))
+    {
+    }
+    ~FileDescriptor()
+    {
+        if (fd >= 0)
+            ::close(fd);
+    }
+    const int fd;
+};
+
+QString errorText(int error)
+{
+    return QString::fromLocal8Bit(strerror(error));
+}
+
+// write the whole buffer, return false on error with errno set
+bool writeAll(int fd, const char *data, qint64 length, qint64 offset)
+{
+    while (length > 0) {
+        const ssize_t written = pwrite(fd, data, static_cast<size_t>(length), static_cast<off_t>(offset));
+        if (written < 0) {
+            if (errno == EINTR)
+                continue;
+            return false;
+        }
+        data += written;
+        offset += written;
+        length -= written;
+    }
+    return true;
+}
+
+// copy in the kernel, return the number of bytes copied before it failed or was not supported
+qint64 copyInKernel(int sourceFd, qint64 sourceOffset, int targetFd, qint64 targetOffset, qint64 length, bool &supported, int &error)
+{
+    error = 0;
+#ifdef HAVE_COPY_FILE_RANGE
+    CopyOffset in = sourceOffset, out = targetOffset;
+    qint64 copied = 0;
+    while (supported && copied < length) {
+        const ssize_t count = copy_file_range(sourceFd, &in, targetFd, &out, static_cast<size_t>(length - copied), 0);
+        if (count < 0) {
+            if (errno == EINTR)
+                continue;
+            if (errno == ENOSYS || errno == EXDEV || errno == EINVAL || errno == EOPNOTSUPP)
+                supported = false; // fall back to writing the data, from where it stopped
+            else
+                error = errno;
+            break;
+        }
+        if (count == 0) { // the source got shorter
+            error = EIO;
+            break;
+        }
+        copied += count;
+    }
+    return copied;
+#else
+    Q_UNUSED(sourceFd)
+    Q_UNUSED(sourceOffset)
+    Q_UNUSED(targetFd)
+    Q_UNUSED(targetOffset)
+    Q_UNUSED(length)
+    supported = false;
+    return 0;
+#endif
+}
+}
+
+LocalTransfer::LocalTransfer(QObject *parent)
+    : QObject(parent)
+    , m_run(this, [this]() {
+        emit finished();
+    })
+{
+    m_pool.setMaxThreadCount(qBound(1, QThread::idealThreadCount(), MAX_THREADS));
+}
+
+LocalTransfer::~LocalTransfer()
+{
+    cancel();
+}
+
+void LocalTransfer::start(const QList<Range> &ranges)
+{
+    cancel();
+
+    m_ranges = ranges;
+    m_bytesDone.storeRelease(0);
+    const int generation = m_run.start(ranges.count());
+    {
+        QMutexLocker locker(&m_mutex);
+        m_crcs = QVector<unsigned long>(ranges.count(), 0);
+        m_error.clear();
+    }
+
+    if (ranges.isEmpty()) {
+        m_run.finish(generation);
+        return;
+    }
+
+    for (int i = 0; i < ranges.count(); ++i) {
+        QtConcurrent::run(&m_pool, [=]() {
+            if (!m_run.isInterrupted())
+                copyRange(i);
+            m_run.taskDone(generation);
+        });
+    }
+}
+
+void LocalTransfer::cancel()
+{
+    if (!m_run.cancel())
+        return;
+
+    m_pool.clear();
+    m_pool.waitForDone();
+}
+
+unsigned long LocalTransfer::crc() const
+{
+    unsigned long result = CRC32().result(); // of no data
+    for (int i = 0; i < m_ranges.count(); ++i)
+        result = CRC32::combine(result, m_crcs.at(i), static_cast<uint64_t>(m_ranges.at(i).length));
+    return result;
+}
+
+void LocalTransfer::copyRange(int index)
+{
+    const Range &range = m_ranges.at(index);
+
+    FileDescriptor source(range.source, O_RDONLY);
+    if (source.fd < 0) {
+        setError(i18n("Error reading file %1: %2", range.source, errorText(errno)));
+        return;
+    }
+    FileDescriptor target(range.target, O_WRONLY);
+    if (target.fd < 0) {
+        setError(i18n("Error writing file %1: %2", range.target, errorText(errno)));
+        return;
+    }
+
+#ifdef POSIX_FADV_SEQUENTIAL
+    posix_fadvise(source.fd, static_cast<off_t>(range.sourceOffset), static_cast<off_t>(range.length), POSIX_FADV_SEQUENTIAL);
+#endif
+
+    const qint64 pageSize = sysconf(_SC_PAGESIZE);
+    bool kernelCopy = true;
+    QByteArray buffer;
+    CRC32 crc;
+
+    for (qint64 done = 0; done < range.length;) {
+        if (m_run.isInterrupted())
+            return;
+
+        // map a window starting at a page boundary
+        const qint64 position = range.sourceOffset + done;
+        const qint64 mapStart = position - position % pageSize;
+        const qint64 length = qMin(WINDOW_SIZE, range.length - done);
+        const qint64 mapLength = length + (position - mapStart);
+
+        // touching mapped pages beyond the end of a truncated file raises SIGBUS
+        struct stat sourceStat;
+        if (fstat(source.fd, &sourceStat) < 0) {
+            setError(i18n("Error reading file %1: %2", range.source, errorText(errno)));
+            return;
+        }
+        if (sourceStat.st_size < position + length) {
+            setError(i18n("The file %1 changed while it was copied.", range.source));
+            return;
+        }
+
+        void *map = mmap(nullptr, static_cast<size_t>(mapLength), PROT_READ, MAP_SHARED, source.fd, static_cast<off_t>(mapStart));
+        const char *data;
+        qint64 count;
+        if (map != MAP_FAILED) {
+            madvise(map, static_cast<size_t>(mapLength), MADV_SEQUENTIAL);
+            data = static_cast<const char *>(map) + (position - mapStart);
+            count = length;
+        } else {
+            // not mappable, read through a buffer
+            if (buffer.isEmpty())
+                buffer.resize(BUFFER_SIZE);
+            count = pread(source.fd, buffer.data(), static_cast<size_t>(qMin<qint64>(BUFFER_SIZE, length)), static_cast<off_t>(position));
+            if (count < 0 && errno == EINTR)
+                continue;
+            if (count <= 0) {
+                setError(i18n("Error reading file %1: %2", range.source, errorText(count < 0 ? errno : EIO)));
+                return;
+            }
+            data = buffer.constData();
+        }
+
+        crc.update(reinterpret_cast<const unsigned char *>(data), static_cast<size_t>(count));
+
+        qint64 copied = 0;
+        int error = 0;
+        if (kernelCopy && map != MAP_FAILED)
+            copied = copyInKernel(source.fd, position, target.fd, range.targetOffset + done, count, kernelCopy, error);
+        if (error == 0 && copied < count && !writeAll(target.fd, data + copied, count - copied, range.targetOffset + done + copied))
+            error = errno;
+
+        if (map != MAP_FAILED)
+            munmap(map, static_cast<size_t>(mapLength));
+
+        if (error != 0) {
+            setError(i18n("Error writing file %1: %2", range.target, errorText(error)));
+            return;
+        }
+
+        done += count;
+        m_bytesDone.fetchAndAddOrdered(count);
+    }
+
+    QMutexLocker locker(&m_mutex);
+    m_crcs[index] = crc.result();
+}
+
+void LocalTransfer::setError(const QString &error)
+{
+    // the other ranges are not needed after an error, finished() reports it
+    m_run.stop();
+
+    QMutexLocker locker(&m_mutex);
+    if (m_error.isEmpty())
+        m_error = error;
+}
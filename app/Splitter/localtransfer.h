@@ -0,0 +1,85 @@
+/*
+    SPDX-FileCopyrightText: 2026 Krusader Krew <https://krusader.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef LOCALTRANSFER_H
+#define LOCALTRANSFER_H
+
+// QtCore
+#include <QAtomicInteger>
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <QString>
+#include <QThreadPool>
+#include <QVector>
+
+#include "../workerrun.h"
+
+/**
+ * Copies byte ranges between local files in a thread pool, the fast path of Splitter and Combiner.
+ *
+ * The source of a range is mapped into the memory window by window. The CRC is calculated on the
+ * mapped pages, then the window is copied with copy_file_range(), so the data is not copied
+ * through the user space at all. Where that is not available, the mapped pages are written to the
+ * target directly. The ranges are copied in parallel, their CRCs are combined in the order of the
+ * ranges.
+ *
+ * The targets must exist, they are opened for writing but not created or truncated.
+ */
+class LocalTransfer : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Range {
+        QString source;
+        qint64 sourceOffset;
+        QString target;
+        qint64 targetOffset;
+        qint64 length;
+    };
+
+    explicit LocalTransfer(QObject *parent = nullptr);
+    ~LocalTransfer() override;
+
+    /// Copy the @p ranges, which follow each other in the data the CRC is calculated of
+    void start(const QList<Range> &ranges);
+    /// Stop copying and wait for the worker threads
+    void cancel();
+
+    /// The number of bytes copied. Thread-safe.
+    qint64 bytesDone() const
+    {
+        return m_bytesDone.loadAcquire();
+    }
+    /// The CRC-32 of all ranges, valid after finished() without an error
+    unsigned long crc() const;
+    /// The message of the first error, empty if there was none. Valid after finished().
+    QString errorString() const
+    {
+        return m_error;
+    }
+
+signals:
+    /// Emitted when all ranges are copied or one of them failed. Not emitted after cancel().
+    void finished();
+
+private:
+    /// Copy a range, called in a worker thread
+    void copyRange(int index);
+    void setError(const QString &error);
+
+    QThreadPool m_pool;
+    QList<Range> m_ranges;
+    WorkerRun m_run;
+    QAtomicInteger<qint64> m_bytesDone;
+
+    QMutex m_mutex; //< protects all following members
+    QVector<unsigned long> m_crcs; //< the CRC of each range
+    QString m_error;
+};
+
+#endif // LOCALTRANSFER_H
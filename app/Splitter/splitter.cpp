@@ -6,10 +6,13 @@
 */
 
 #include "splitter.h"
+#include "localtransfer.h"
 #include "../FileSystem/filesystem.h"
 
 // QtCore
+#include <QFile>
 #include <QFileInfo>
+#include <QTimer>
 // QtWidgets
 #include <QLayout>
 
@@ -21,6 +24,8 @@
 #include <kio_version.h>
 #include <utility>
 
+#include <sys/stat.h>
+
 Splitter::Splitter(QWidget *parent, QUrl fileNameIn, QUrl destinationDirIn, bool overWriteIn)
     : QProgressDialog(parent, Qt::WindowFlags())
     , fileName(std::move(fileNameIn))
@@ -35,7 +40,8 @@ Splitter::Splitter(QWidget *parent, QUrl fileNameIn, QUrl destinationDirIn, bool
     , statJob(nullptr)
     , splitReadJob(nullptr)
     , splitWriteJob(nullptr)
-
+    , localTransfer(nullptr)
+    , progressTimer(nullptr)
 {
     setMaximum(100);
     setAutoClose(false); /* don't close or reset the dialog automatically */
@@ -77,11 +83,16 @@ void Splitter::split(KIO::filesize_t splitSizeIn)
         return;
     }
 
-    splitReadJob = KIO::get(fileName, KIO::NoReload, KIO::HideProgressInfo);
+    if (fileName.isLocalFile() && destinationDir.isLocalFile()) {
+        if (!startLocalSplit(file.size()))
+            return;
+    } else {
+        splitReadJob = KIO::get(fileName, KIO::NoReload, KIO::HideProgressInfo);
 
-    connect(splitReadJob, &KIO::TransferJob::data, this, &Splitter::splitDataReceived);
-    connect(splitReadJob, &KIO::TransferJob::result, this, &Splitter::splitReceiveFinished);
-    connect(splitReadJob, SIGNAL(percent(KJob *, ulong)), this, SLOT(splitReceivePercent(KJob *, ulong)));
+        connect(splitReadJob, &KIO::TransferJob::data, this, &Splitter::splitDataReceived);
+        connect(splitReadJob, &KIO::TransferJob::result, this, &Splitter::splitReceiveFinished);
+        connect(splitReadJob, SIGNAL(percent(KJob *, ulong)), this, SLOT(splitReceivePercent(KJob *, ulong)));
+    }
 
     exec();
 }
@@ -93,7 +104,7 @@ void Splitter::splitDataReceived(KIO::Job *, const QByteArray &byteArray)
     if (byteArray.size() == 0)
         return;
 
-    crcContext->update(reinterpret_cast<unsigned char *>(const_cast<char *>(byteArray.data())), byteArray.size());
+    crcContext->update(reinterpret_cast<const unsigned char *>(byteArray.constData()), byteArray.size());
     receivedSize += byteArray.size();
 
     if (!splitWriteJob)
@@ -122,10 +133,14 @@ void Splitter::splitReceiveFinished(KJob *job)
         return;
     }
 
-    QString crcResult = QString("%1").arg(crcContext->result(), 0, 16).toUpper().trimmed().rightJustified(8, '0');
+    splitInfoFileContent = splitInfo(crcContext->result());
+}
+
+QString Splitter::splitInfo(unsigned long crc) const
+{
+    QString crcResult = QString("%1").arg(crc, 0, 16).toUpper().trimmed().rightJustified(8, '0');
 
-    splitInfoFileContent =
-        QString("filename=%1\n").arg(fileName.fileName()) + QString("size=%1\n").arg(KIO::number(receivedSize)) + QString("crc32=%1\n").arg(crcResult);
+    return QString("filename=%1\n").arg(fileName.fileName()) + QString("size=%1\n").arg(KIO::number(receivedSize)) + QString("crc32=%1\n").arg(crcResult);
 }
 
 void Splitter::splitReceivePercent(KJob *, unsigned long percent)
@@ -143,11 +158,7 @@ void Splitter::nextOutputFile()
 
     QString index("%1"); /* making the split filename */
     index = index.arg(fileNumber).rightJustified(3, '0');
-    QString outFileName = fileName.fileName() + '.' + index;
-
-    writeURL = destinationDir;
-    writeURL = writeURL.adjusted(QUrl::StripTrailingSlash);
-    writeURL.setPath(writeURL.path() + '/' + (outFileName));
+    writeURL = outputFileUrl(fileName.fileName() + '.' + index);
 
     if (overwrite)
         openOutputFile();
@@ -161,6 +172,13 @@ void Splitter::nextOutputFile()
     }
 }
 
+QUrl Splitter::outputFileUrl(const QString &outFileName) const
+{
+    QUrl url = destinationDir.adjusted(QUrl::StripTrailingSlash);
+    url.setPath(url.path() + '/' + outFileName);
+    return url;
+}
+
 void Splitter::statOutputFileResult(KJob *job)
 {
     statJob = nullptr;
@@ -172,23 +190,28 @@ void Splitter::statOutputFileResult(KJob *job)
             dynamic_cast<KIO::Job *>(job)->uiDelegate()->showErrorMessage();
             reject();
         }
-    } else { // destination already exists
-        KIO::RenameDialog dlg(this,
-                              i18n("File Already Exists"),
-                              QUrl(),
-                              writeURL,
-                              static_cast<KIO::RenameDialog_Options>(KIO::M_MULTI | KIO::M_OVERWRITE | KIO::M_NORENAME));
-        switch (dlg.exec()) {
-        case KIO::Result_Overwrite:
-            openOutputFile();
-            break;
-        case KIO::Result_OverwriteAll:
-            overwrite = true;
-            openOutputFile();
-            break;
-        default:
-            reject();
-        }
+    } else if (confirmOverwrite()) { // destination already exists
+        openOutputFile();
+    } else {
+        reject();
+    }
+}
+
+bool Splitter::confirmOverwrite()
+{
+    KIO::RenameDialog dlg(this,
+                          i18n("File Already Exists"),
+                          QUrl(),
+                          writeURL,
+                          static_cast<KIO::RenameDialog_Options>(KIO::M_MULTI | KIO::M_OVERWRITE | KIO::M_NORENAME));
+    switch (dlg.exec()) {
+    case KIO::Result_Overwrite:
+        return true;
+    case KIO::Result_OverwriteAll:
+        overwrite = true;
+        return true;
+    default:
+        return false;
     }
 }
 
@@ -241,9 +264,7 @@ void Splitter::splitSendFinished(KJob *job)
         splitReadJob->resume();
     else { // read job is finished and transfer buffer is empty -> splitting is finished
         /* writing the split information file out */
-        writeURL = destinationDir;
-        writeURL = writeURL.adjusted(QUrl::StripTrailingSlash);
-        writeURL.setPath(writeURL.path() + '/' + (fileName.fileName() + ".crc"));
+        writeURL = outputFileUrl(fileName.fileName() + ".crc");
         splitWriteJob = KIO::put(writeURL, permissions, KIO::HideProgressInfo | KIO::Overwrite);
         connect(splitWriteJob, &KIO::TransferJob::dataReq, this, &Splitter::splitFileSend);
         connect(splitWriteJob, &KIO::TransferJob::result, this, &Splitter::splitFileFinished);
@@ -260,6 +281,11 @@ void Splitter::splitAbortJobs()
         splitWriteJob->kill(KJob::Quietly);
 
     splitReadJob = splitWriteJob = nullptr;
+
+    if (localTransfer)
+        localTransfer->cancel();
+    if (progressTimer)
+        progressTimer->stop();
 }
 
 void Splitter::splitFileSend(KIO::Job *, QByteArray &byteArray)
@@ -280,3 +306,76 @@ void Splitter::splitFileFinished(KJob *job)
 
     accept();
 }
+
+bool Splitter::startLocalSplit(KIO::filesize_t fileSize)
+{
+    const QString source = fileName.toLocalFile();
+    const auto mode = static_cast<mode_t>((permissions & 0777) | S_IWUSR);
+
+    // the parts are created before the transfer, which writes them all at once
+    QList<LocalTransfer::Range> ranges;
+    for (KIO::filesize_t offset = 0; offset < fileSize; offset += splitSize) {
+        fileNumber++;
+        QString index("%1"); /* making the split filename */
+        index = index.arg(fileNumber).rightJustified(3, '0');
+        writeURL = outputFileUrl(fileName.fileName() + '.' + index);
+
+        QFile part(writeURL.toLocalFile());
+        if (!overwrite && part.exists() && !confirmOverwrite())
+            return false;
+        if (!part.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            KMessageBox::error(nullptr, i18n("Error writing file %1: %2", writeURL.toDisplayString(QUrl::PreferLocalFile), part.errorString()));
+            return false;
+        }
+        fchmod(part.handle(), mode);
+
+        const auto length = static_cast<qint64>(qMin(splitSize, fileSize - offset));
+        ranges.append({source, static_cast<qint64>(offset), part.fileName(), 0, length});
+    }
+    receivedSize = fileSize;
+
+    localTransfer = new LocalTransfer(this);
+    connect(localTransfer, &LocalTransfer::finished, this, &Splitter::localSplitFinished);
+    connect(this, &QProgressDialog::canceled, this, [this]() {
+        splitAbortJobs();
+        reject();
+    });
+
+    progressTimer = new QTimer(this);
+    progressTimer->setInterval(100);
+    connect(progressTimer, &QTimer::timeout, this, &Splitter::localSplitProgress);
+    progressTimer->start();
+
+    localTransfer->start(ranges);
+    return true;
+}
+
+void Splitter::localSplitProgress()
+{
+    if (receivedSize)
+        setValue(static_cast<int>(localTransfer->bytesDone() * 100 / static_cast<qint64>(receivedSize)));
+}
+
+void Splitter::localSplitFinished()
+{
+    progressTimer->stop();
+
+    if (!localTransfer->errorString().isEmpty()) {
+        KMessageBox::error(nullptr, localTransfer->errorString());
+        reject();
+        return;
+    }
+    setValue(100);
+
+    /* writing the split information file out */
+    writeURL = outputFileUrl(fileName.fileName() + ".crc");
+    QFile infoFile(writeURL.toLocalFile());
+    if (!infoFile.open(QIODevice::WriteOnly | QIODevice::Truncate) || infoFile.write(splitInfo(localTransfer->crc()).toLocal8Bit()) < 0) {
+        KMessageBox::error(nullptr, i18n("Error writing file %1: %2", writeURL.toDisplayString(QUrl::PreferLocalFile), infoFile.errorString()));
+        reject();
+        return;
+    }
+    fchmod(infoFile.handle(), static_cast<mode_t>((permissions & 0777) | S_IWUSR));
+
+    accept();
+}
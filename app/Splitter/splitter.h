@@ -18,6 +18,9 @@
 
 #include "crc32.h"
 
+class LocalTransfer;
+class QTimer;
+
 class Splitter : public QProgressDialog
 {
     Q_OBJECT
@@ -37,11 +40,19 @@ private slots:
     void splitFileSend(KIO::Job *, QByteArray &);
     void splitFileFinished(KJob *);
     void statOutputFileResult(KJob *job);
+    void localSplitProgress();
+    void localSplitFinished();
 
 private:
     void splitAbortJobs();
     void nextOutputFile();
     void openOutputFile();
+    QUrl outputFileUrl(const QString &outFileName) const;
+    /// Ask whether the existing writeURL may be overwritten
+    bool confirmOverwrite();
+    QString splitInfo(unsigned long crc) const;
+    /// Split a local file to a local folder without KIO, return false if it did not start
+    bool startLocalSplit(KIO::filesize_t fileSize);
 
     // parameters
     QUrl fileName;
@@ -63,6 +74,8 @@ private:
     KIO::Job *statJob;
     KIO::TransferJob *splitReadJob;
     KIO::TransferJob *splitWriteJob;
+    LocalTransfer *localTransfer;
+    QTimer *progressTimer;
 };
 
 #endif /* __SPLITTER_H__ */
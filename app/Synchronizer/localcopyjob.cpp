@@ -0,0 +1,208 @@
+/*
+    SPDX-FileCopyrightText: 2026 Krusader Krew <https://krusader.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "localcopyjob.h"
+
+// QtCore
+#include <QFile>
+#include <QFileInfo>
+#include <QTimer>
+#include <QtConcurrent/QtConcurrentRun> // krazy:exclude=includes
+
+#include <KIO/Global>
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef Q_OS_LINUX
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#endif
+
+// bytes copied with one system call; small enough for a smooth progress and quick canceling
+static const qint64 COPY_BLOCK_SIZE = 8 * 1024 * 1024;
+// size of the buffer if the data has to be copied through user space
+static const int BUFFER_SIZE = 1024 * 1024;
+// interval (ms) of the progress reports
+static const int PROGRESS_INTERVAL = 250;
+
+LocalCopyJob::LocalCopyJob(const QString &source, const QString &destination, bool overwrite, QObject *parent)
+    : KJob(parent)
+    , m_source(source)
+    , m_destination(destination)
+    , m_overwrite(overwrite)
+    , m_watcher(new QFutureWatcher<int>(this))
+    , m_progressTimer(new QTimer(this))
+{
+    setCapabilities(KJob::Killable);
+    connect(m_watcher, &QFutureWatcher<int>::finished, this, &LocalCopyJob::slotFinished);
+    connect(m_progressTimer, &QTimer::timeout, this, &LocalCopyJob::reportProgress);
+}
+
+LocalCopyJob::~LocalCopyJob()
+{
+    if (m_watcher->isRunning()) {
+        m_canceled.storeRelease(1);
+        m_watcher->waitForFinished();
+    }
+}
+
+void LocalCopyJob::start()
+{
+    struct stat sourceStat;
+    if (stat(QFile::encodeName(m_source).constData(), &sourceStat) == 0)
+        setTotalAmount(KJob::Bytes, static_cast<qulonglong>(sourceStat.st_size));
+
+    m_progressTimer->start(PROGRESS_INTERVAL);
+    m_watcher->setFuture(QtConcurrent::run([this]() {
+        return copy();
+    }));
+}
+
+bool LocalCopyJob::doKill()
+{
+    m_progressTimer->stop();
+    m_watcher->disconnect(this);
+    m_canceled.storeRelease(1);
+    m_watcher->waitForFinished();
+    return true;
+}
+
+bool LocalCopyJob::isSameFileSystem(const QString &source, const QString &destination)
+{
+    struct stat sourceStat, destinationStat;
+    const QString destinationDir = QFileInfo(destination).absolutePath();
+    return stat(QFile::encodeName(source).constData(), &sourceStat) == 0 && S_ISREG(sourceStat.st_mode)
+        && stat(QFile::encodeName(destinationDir).constData(), &destinationStat) == 0 && sourceStat.st_dev == destinationStat.st_dev;
+}
+
+void LocalCopyJob::reportProgress()
+{
+    setProcessedAmount(KJob::Bytes, static_cast<qulonglong>(m_copied.loadAcquire()));
+}
+
+void LocalCopyJob::slotFinished()
+{
+    m_progressTimer->stop();
+    reportProgress();
+
+    const int error = m_watcher->result();
+    if (error) {
+        setError(error);
+        // reading errors concern the source, everything else happened at the destination
+        setErrorText(error == KIO::ERR_DOES_NOT_EXIST || error == KIO::ERR_CANNOT_OPEN_FOR_READING ? m_source : m_destination);
+    }
+    emitResult();
+}
+
+int LocalCopyJob::copy()
+{
+    const int in = ::open(QFile::encodeName(m_source).constData(), O_RDONLY | O_CLOEXEC);
+    if (in < 0)
+        return errno == ENOENT ? KIO::ERR_DOES_NOT_EXIST : KIO::ERR_CANNOT_OPEN_FOR_READING;
+
+    struct stat sourceStat;
+    if (fstat(in, &sourceStat) < 0) {
+        ::close(in);
+        return KIO::ERR_CANNOT_OPEN_FOR_READING;
+    }
+
+    // an existing file is replaced only when the copy is complete, like KIO does with a .part file
+    const QByteArray destination = QFile::encodeName(m_destination);
+    const QByteArray target = m_overwrite ? destination + ".part" : destination;
+    const int out = ::open(target.constData(), O_WRONLY | O_CREAT | O_CLOEXEC | (m_overwrite ? O_TRUNC : O_EXCL), 0666);
+    if (out < 0) {
+        const int openError = errno;
+        ::close(in);
+        return openError == EEXIST ? KIO::ERR_FILE_ALREADY_EXIST : KIO::ERR_CANNOT_OPEN_FOR_WRITING;
+    }
+
+    int error = 0;
+    bool done = false;
+
+#ifdef FICLONE
+    // shares the data blocks on copy-on-write filesystems, no data is copied at all
+    if (ioctl(out, FICLONE, in) == 0) {
+        m_copied.storeRelease(sourceStat.st_size);
+        done = true;
+    }
+#endif
+
+#ifdef HAVE_COPY_FILE_RANGE
+    // the data is copied inside the kernel, or by the server on network filesystems
+    bool useCopyFileRange = true;
+#else
+    const bool useCopyFileRange = false;
+#endif
+    QByteArray buffer;
+
+    while (!done) {
+        if (m_canceled.loadAcquire()) {
+            error = KIO::ERR_USER_CANCELED;
+            break;
+        }
+
+        qint64 copied;
+#ifdef HAVE_COPY_FILE_RANGE
+        if (useCopyFileRange) {
+            copied = copy_file_range(in, nullptr, out, nullptr, static_cast<size_t>(COPY_BLOCK_SIZE), 0);
+            if (copied < 0 && (errno == ENOSYS || errno == EXDEV || errno == EINVAL || errno == EOPNOTSUPP)) {
+                // the file positions are unchanged, continue with read() and write()
+                useCopyFileRange = false;
+                continue;
+            }
+        }
+#endif
+        if (!useCopyFileRange) {
+            if (buffer.isEmpty())
+                buffer.resize(BUFFER_SIZE);
+            copied = ::read(in, buffer.data(), static_cast<size_t>(buffer.size()));
+            if (copied < 0 && errno == EINTR)
+                continue;
+            if (copied < 0) {
+                error = KIO::ERR_CANNOT_OPEN_FOR_READING;
+                break;
+            }
+            for (qint64 written = 0; written < copied && !error;) {
+                const ssize_t bytes = ::write(out, buffer.constData() + written, static_cast<size_t>(copied - written));
+                if (bytes < 0 && errno != EINTR)
+                    error = errno == ENOSPC ? KIO::ERR_DISK_FULL : KIO::ERR_CANNOT_OPEN_FOR_WRITING;
+                else if (bytes > 0)
+                    written += bytes;
+            }
+            if (error)
+                break;
+        } else if (copied < 0) {
+            if (errno == EINTR)
+                continue;
+            error = errno == ENOSPC ? KIO::ERR_DISK_FULL : KIO::ERR_CANNOT_OPEN_FOR_WRITING;
+            break;
+        }
+
+        if (copied == 0) {
+#ifdef HAVE_COPY_FILE_RANGE
+            if (useCopyFileRange && m_copied.loadAcquire() < sourceStat.st_size) {
+                // some filesystems report no data instead of an error, copy the rest with read() and write()
+                useCopyFileRange = false;
+                continue;
+            }
+#endif
+            break;
+        }
+        m_copied.fetchAndAddRelease(copied);
+    }
+
+    ::close(in);
+    if (::close(out) < 0 && !error)
+        error = KIO::ERR_CANNOT_OPEN_FOR_WRITING;
+    if (!error && m_overwrite && rename(target.constData(), destination.constData()) < 0)
+        error = KIO::ERR_CANNOT_RENAME_PARTIAL;
+    if (error)
+        unlink(target.constData()); // don't leave a partial copy, the destination is untouched
+    return error;
+}
@@ -0,0 +1,58 @@
+/*
+    SPDX-FileCopyrightText: 2026 Krusader Krew <https://krusader.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef LOCALCOPYJOB_H
+#define LOCALCOPYJOB_H
+
+// QtCore
+#include <QAtomicInt>
+#include <QFutureWatcher>
+#include <QString>
+
+#include <KJob>
+
+class QTimer;
+
+/**
+ * Copies a local file to the same filesystem in a worker thread, letting the kernel do the work.
+ *
+ * The file is cloned (reflink) if the filesystem supports it, else copied with copy_file_range()
+ * and, where this is not available either, with plain reads and writes. A file to overwrite is
+ * replaced only after the copy to a .part file succeeded. The errors are reported with the KIO
+ * error codes used by KIO::file_copy(), so the job can be handled like one.
+ */
+class LocalCopyJob : public KJob
+{
+    Q_OBJECT
+
+public:
+    LocalCopyJob(const QString &source, const QString &destination, bool overwrite, QObject *parent = nullptr);
+    ~LocalCopyJob() override;
+
+    void start() override;
+
+    /// Return true if both paths are on the same local filesystem (the destination may not exist yet)
+    static bool isSameFileSystem(const QString &source, const QString &destination);
+
+protected:
+    bool doKill() override;
+
+private:
+    /// Copy the file, called in the worker thread. Returns a KIO error code or 0.
+    int copy();
+    void slotFinished();
+    void reportProgress();
+
+    const QString m_source;
+    const QString m_destination;
+    const bool m_overwrite;
+    QAtomicInt m_canceled;
+    QAtomicInteger<qint64> m_copied; //< bytes copied so far
+    QFutureWatcher<int> *m_watcher;
+    QTimer *m_progressTimer;
+};
+
+#endif // LOCALCOPYJOB_H
@@ -0,0 +1,256 @@
+/*
+    SPDX-FileCopyrightText: 2026 Krusader Krew <https://krusader.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "localfilecomparer.h"
+
+// QtCore
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#include <cstring>
+#include <fcntl.h>
+
+// size of the blocks read from both files
+static const qint64 BLOCK_SIZE = 4 * 1024 * 1024;
+// size of the first and last block which are compared first
+static const qint64 QUICK_CHECK_SIZE = 64 * 1024;
+// the cache is dropped if it grows larger, it's rebuilt by the next comparisons
+static const int MAX_CACHED_HASHES = 1000000;
+static const quint32 HASH_CACHE_VERSION = 2;
+// the smallest size of a cache entry (device, inode, size, time, hash)
+static const qint64 MIN_ENTRY_SIZE = 4 * 8 + 4;
+
+ContentHashCache *ContentHashCache::instance()
+{
+    static ContentHashCache cache;
+    return &cache;
+}
+
+ContentHashCache::ContentHashCache()
+    : m_loaded(false)
+    , m_modified(false)
+{
+}
+
+QString ContentHashCache::fileName()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation) + QStringLiteral("/krusader/synchronizer-hashes");
+}
+
+qint64 ContentHashCache::modificationTime(const struct stat &fileStat)
+{
+#ifdef Q_OS_LINUX
+    return static_cast<qint64>(fileStat.st_mtim.tv_sec) * 1000000000 + fileStat.st_mtim.tv_nsec;
+#else
+    return static_cast<qint64>(fileStat.st_mtime) * 1000000000;
+#endif
+}
+
+bool ContentHashCache::find(const struct stat &fileStat, QByteArray &hash)
+{
+    QMutexLocker locker(&m_mutex);
+    load();
+
+    const auto it = m_entries.constFind(qMakePair<quint64, quint64>(fileStat.st_dev, fileStat.st_ino));
+    if (it == m_entries.constEnd() || it->size != fileStat.st_size || it->mtime != modificationTime(fileStat))
+        return false;
+    hash = it->hash;
+    return true;
+}
+
+void ContentHashCache::insert(const struct stat &fileStat, const QByteArray &hash)
+{
+    QMutexLocker locker(&m_mutex);
+    load();
+
+    if (m_entries.count() >= MAX_CACHED_HASHES)
+        m_entries.clear();
+    m_entries.insert(qMakePair<quint64, quint64>(fileStat.st_dev, fileStat.st_ino), Entry{fileStat.st_size, modificationTime(fileStat), hash});
+    m_modified = true;
+}
+
+void ContentHashCache::load()
+{
+    if (m_loaded)
+        return;
+    m_loaded = true;
+
+    QFile file(fileName());
+    if (!file.open(QIODevice::ReadOnly))
+        return;
+
+    QDataStream stream(&file);
+    quint32 version;
+    qint32 count;
+    stream >> version >> count;
+    if (version != HASH_CACHE_VERSION || count < 0)
+        return;
+
+    // the count of a broken file must not allocate more than the file can hold
+    m_entries.reserve(static_cast<int>(qMin<qint64>(qMin(count, MAX_CACHED_HASHES), file.bytesAvailable() / MIN_ENTRY_SIZE)));
+    for (qint32 i = 0; i < count; ++i) {
+        quint64 device, inode;
+        Entry entry;
+        stream >> device >> inode >> entry.size >> entry.mtime >> entry.hash;
+        if (stream.status() != QDataStream::Ok)
+            break;
+        m_entries.insert(qMakePair(device, inode), entry);
+    }
+    if (stream.status() != QDataStream::Ok)
+        m_entries.clear(); // broken file
+}
+
+void ContentHashCache::save()
+{
+    QMutexLocker locker(&m_mutex);
+    if (!m_modified)
+        return;
+
+    QDir().mkpath(QFileInfo(fileName()).absolutePath());
+    QSaveFile file(fileName());
+    if (!file.open(QIODevice::WriteOnly))
+        return;
+
+    QDataStream stream(&file);
+    stream << HASH_CACHE_VERSION << static_cast<qint32>(m_entries.count());
+    for (auto it = m_entries.constBegin(); it != m_entries.constEnd(); ++it)
+        stream << it.key().first << it.key().second << it->size << it->mtime << it->hash;
+
+    if (file.commit())
+        m_modified = false;
+}
+
+/// Read @p length bytes. Returns the number of bytes read (less at the end of the file) or -1 on error.
+static qint64 readBlock(QFile &file, char *data, qint64 length)
+{
+    qint64 total = 0;
+    while (total < length) {
+        const qint64 bytes = file.read(data + total, length - total);
+        if (bytes < 0)
+            return -1;
+        if (bytes == 0)
+            break;
+        total += bytes;
+    }
+    return total;
+}
+
+LocalFileComparer::LocalFileComparer(const QString &leftPath, const QString &rightPath, bool useHashCache)
+    : m_leftPath(leftPath)
+    , m_rightPath(rightPath)
+    , m_useHashCache(useHashCache)
+{
+}
+
+LocalFileComparer::Result LocalFileComparer::compare()
+{
+    QFile leftFile(m_leftPath);
+    struct stat leftStat;
+    if (!leftFile.open(QIODevice::ReadOnly | QIODevice::Unbuffered) || fstat(leftFile.handle(), &leftStat) < 0)
+        return LeftError;
+    QFile rightFile(m_rightPath);
+    struct stat rightStat;
+    if (!rightFile.open(QIODevice::ReadOnly | QIODevice::Unbuffered) || fstat(rightFile.handle(), &rightStat) < 0)
+        return RightError;
+
+    const qint64 size = leftStat.st_size;
+    if (size != rightStat.st_size)
+        return Different;
+    if (leftStat.st_dev == rightStat.st_dev && leftStat.st_ino == rightStat.st_ino)
+        return Equal; // same file
+
+    if (m_useHashCache) {
+        ContentHashCache *cache = ContentHashCache::instance();
+        QByteArray leftHash, rightHash;
+        if (cache->find(leftStat, leftHash) && cache->find(rightStat, rightHash)) {
+            m_compared.storeRelease(size);
+            return leftHash == rightHash ? Equal : Different;
+        }
+    }
+
+#ifdef POSIX_FADV_SEQUENTIAL
+    posix_fadvise(leftFile.handle(), 0, 0, POSIX_FADV_SEQUENTIAL);
+    posix_fadvise(rightFile.handle(), 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+
+    QByteArray leftBuffer(static_cast<int>(qMin(size, BLOCK_SIZE)), Qt::Uninitialized);
+    QByteArray rightBuffer(leftBuffer.size(), Qt::Uninitialized);
+    // equal files are told by their hashes next time, a collision must be practically impossible
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+
+    // compare a block at the current positions; returns Equal if the blocks are equal
+    auto compareBlock = [&](qint64 length) {
+        const qint64 leftBytes = readBlock(leftFile, leftBuffer.data(), length);
+        if (leftBytes < 0)
+            return LeftError;
+        const qint64 rightBytes = readBlock(rightFile, rightBuffer.data(), length);
+        if (rightBytes < 0)
+            return RightError;
+        if (leftBytes != length || rightBytes != length || memcmp(leftBuffer.constData(), rightBuffer.constData(), static_cast<size_t>(length)) != 0)
+            return Different; // also if a file was truncated meanwhile
+        return Equal;
+    };
+
+    // the first block
+    const qint64 headLength = qMin(size, QUICK_CHECK_SIZE);
+    Result result = compareBlock(headLength);
+    if (result != Equal)
+        return result;
+    if (m_useHashCache)
+        hash.addData(leftBuffer.constData(), static_cast<int>(headLength));
+
+    // the last block
+    const qint64 tailLength = qMin(size - headLength, QUICK_CHECK_SIZE);
+    QByteArray tail;
+    if (tailLength > 0) {
+        if (!leftFile.seek(size - tailLength))
+            return LeftError;
+        if (!rightFile.seek(size - tailLength))
+            return RightError;
+        result = compareBlock(tailLength);
+        if (result != Equal)
+            return result;
+        if (m_useHashCache)
+            tail = QByteArray(leftBuffer.constData(), static_cast<int>(tailLength));
+        if (!leftFile.seek(headLength))
+            return LeftError;
+        if (!rightFile.seek(headLength))
+            return RightError;
+    }
+    m_compared.storeRelease(headLength + tailLength);
+
+    // the rest
+    const qint64 middleEnd = size - tailLength;
+    for (qint64 pos = headLength; pos < middleEnd;) {
+        if (m_canceled.loadAcquire())
+            return Canceled;
+
+        const qint64 length = qMin(BLOCK_SIZE, middleEnd - pos);
+        result = compareBlock(length);
+        if (result != Equal)
+            return result;
+        if (m_useHashCache)
+            hash.addData(leftBuffer.constData(), static_cast<int>(length));
+
+        pos += length;
+        m_compared.fetchAndAddRelease(length);
+    }
+
+    if (m_useHashCache) {
+        hash.addData(tail);
+        const QByteArray contentHash = hash.result();
+        ContentHashCache *cache = ContentHashCache::instance();
+        cache->insert(leftStat, contentHash);
+        cache->insert(rightStat, contentHash);
+    }
+    return Equal;
+}
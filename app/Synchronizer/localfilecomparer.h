@@ -0,0 +1,91 @@
+/*
+    SPDX-FileCopyrightText: 2026 Krusader Krew <https://krusader.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef LOCALFILECOMPARER_H
+#define LOCALFILECOMPARER_H
+
+// QtCore
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QHash>
+#include <QMutex>
+#include <QPair>
+#include <QString>
+
+#include <sys/stat.h>
+
+/**
+ * Content hashes of local files which were compared before, so an unchanged pair of files is not
+ * read again when comparing the same folders another time.
+ *
+ * The hashes are SHA-256 digests. A hash is valid as long as the file (device and inode) has the same size and modification time.
+ * The cache is loaded from and saved to the user's cache folder. Thread-safe.
+ */
+class ContentHashCache
+{
+public:
+    static ContentHashCache *instance();
+
+    /// Look up the content hash of a file. Returns false if not cached or changed since.
+    bool find(const struct stat &fileStat, QByteArray &hash);
+    void insert(const struct stat &fileStat, const QByteArray &hash);
+    /// Write the cache file if hashes were added
+    void save();
+
+private:
+    struct Entry {
+        qint64 size;
+        qint64 mtime; //< nanoseconds since the epoch
+        QByteArray hash;
+    };
+
+    ContentHashCache();
+    static QString fileName();
+    static qint64 modificationTime(const struct stat &fileStat);
+    void load();
+
+    QMutex m_mutex; //< protects all following members
+    QHash<QPair<quint64, quint64>, Entry> m_entries; //< key: device and inode
+    bool m_loaded;
+    bool m_modified;
+};
+
+/**
+ * Compares the content of two local files. Made to run in a worker thread.
+ *
+ * Files are read in large blocks. The first and the last block are compared before the rest, as
+ * most different files of the same size differ there. Optionally the content hashes of equal files
+ * are remembered in the ContentHashCache.
+ */
+class LocalFileComparer
+{
+public:
+    enum Result { Equal, Different, LeftError, RightError, Canceled };
+
+    LocalFileComparer(const QString &leftPath, const QString &rightPath, bool useHashCache);
+
+    /// Compare the files, blocking
+    Result compare();
+    /// Stop a running compare() as soon as possible. Thread-safe.
+    void cancel()
+    {
+        m_canceled.storeRelease(1);
+    }
+    /// The number of bytes compared so far. Thread-safe.
+    qint64 compared() const
+    {
+        return m_compared.loadAcquire();
+    }
+
+private:
+    const QString m_leftPath;
+    const QString m_rightPath;
+    const bool m_useHashCache;
+    QAtomicInt m_canceled;
+    QAtomicInteger<qint64> m_compared;
+};
+
+#endif // LOCALFILECOMPARER_H
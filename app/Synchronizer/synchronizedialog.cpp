@@ -101,6 +101,11 @@ SynchronizeDialog::SynchronizeDialog(QWidget *parent,
     cbOverwrite->setChecked(group.readEntry("Confirm overwrites", _ConfirmOverWrites));
     layout->addWidget(cbOverwrite);
 
+    cbFastCopy = new QCheckBox(i18n("Fast copy of local files on the same filesystem"), this);
+    cbFastCopy->setToolTip(i18n("Let the system clone or copy the files without reading them, if the filesystem supports it."));
+    cbFastCopy->setChecked(group.readEntry("Fast Local Copy", false));
+    layout->addWidget(cbFastCopy);
+
     auto *spacer = new QSpacerItem(20, 20, QSizePolicy::Expanding, QSizePolicy::Minimum);
     hbox->addItem(spacer);
 
@@ -140,6 +145,7 @@ SynchronizeDialog::~SynchronizeDialog()
 {
     KConfigGroup group(krConfig, "Synchronize");
     group.writeEntry("Confirm overwrites", cbOverwrite->isChecked());
+    group.writeEntry("Fast Local Copy", cbFastCopy->isChecked());
 }
 
 void SynchronizeDialog::startSynchronization()
@@ -160,8 +166,14 @@ void SynchronizeDialog::startSynchronization()
     if (!cbDeletable->isChecked())
         deleteSize = 0;
 
-    synchronizer
-        ->synchronize(this, cbRightToLeft->isChecked(), cbLeftToRight->isChecked(), cbDeletable->isChecked(), !cbOverwrite->isChecked(), parallelThreads);
+    syncTimer.start();
+    synchronizer->synchronize(this,
+                              cbRightToLeft->isChecked(),
+                              cbLeftToRight->isChecked(),
+                              cbDeletable->isChecked(),
+                              !cbOverwrite->isChecked(),
+                              parallelThreads,
+                              cbFastCopy->isChecked());
 }
 
 void SynchronizeDialog::synchronizationFinished()
@@ -197,6 +209,11 @@ void SynchronizeDialog::processedSizes(int leftNr, KIO::filesize_t leftSize, int
         totalSum++;
 
     progress->setValue((int)(((double)processedSum / (double)totalSum) * 1000));
+
+    // the throughput of all copy jobs together
+    const qint64 elapsed = syncTimer.elapsed();
+    if (elapsed > 0)
+        progress->setFormat(i18nc("%1=throughput", "%p% (%1/s)", KIO::convertSize((leftSize + rightSize) * 1000 / static_cast<KIO::filesize_t>(elapsed))));
 }
 
 void SynchronizeDialog::pauseOrResume()
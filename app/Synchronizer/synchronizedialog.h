@@ -8,6 +8,8 @@
 #ifndef SYNCHRONIZEDIALOG_H
 #define SYNCHRONIZEDIALOG_H
 
+// QtCore
+#include <QElapsedTimer>
 // QtWidgets
 #include <QCheckBox>
 #include <QDialog>
@@ -49,6 +51,7 @@ private:
     QLabel *lbDeletable;
 
     QCheckBox *cbOverwrite;
+    QCheckBox *cbFastCopy;
 
     QPushButton *btnStart;
     QPushButton *btnPause;
@@ -66,6 +69,7 @@ private:
 
     bool isPause;
     bool syncStarted;
+    QElapsedTimer syncTimer; // for the throughput
 };
 
 #endif /* __SYNCHRONIZE_DIALOG__ */
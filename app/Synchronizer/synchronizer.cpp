@@ -10,7 +10,9 @@
 #include "../FileSystem/krquery.h"
 #include "../krglobal.h"
 #include "../krservices.h"
+#include "localcopyjob.h"
 #include "synchronizerdirlist.h"
+#include "synchronizersnapshot.h"
 
 #include <utime.h>
 
@@ -19,6 +21,7 @@
 #include <QDir>
 #include <QEventLoop>
 #include <QRegExp>
+#include <QThread>
 #include <QTime>
 #include <QTimer>
 #include <QUrl>
@@ -34,6 +37,7 @@
 
 #include <KIO/DeleteJob>
 #include <KIO/JobUiDelegate>
+#include <KIO/JobUiDelegateFactory>
 #include <KIO/SkipDialog>
 #include <KLocalizedString>
 #include <KMessageBox>
@@ -47,10 +51,17 @@
 #endif
 #endif
 
-#define DISPLAY_UPDATE_PERIOD 2
+#define DISPLAY_UPDATE_INTERVAL 100 /* ms */
+
+// the number of tasks skipped while waiting for their folders to be created or for a slot
+#define MAX_WAITING_TASKS 1000
+// copies of files from this size on are bound by the disk bandwidth rather than by the latency
+#define LARGE_FILE_SIZE (1024 * 1024)
 
 Synchronizer::Synchronizer()
-    : displayUpdateCount(0)
+    : cacheContentHashes(false)
+    , snapshot(nullptr)
+    , verifySnapshot(false)
     , markEquals(true)
     , markDiffers(true)
     , markCopyToLeft(true)
@@ -59,6 +70,7 @@ Synchronizer::Synchronizer()
     , parentWidget(nullptr)
     , resultListIt(resultList)
 {
+    displayUpdateTimer.start();
 }
 
 Synchronizer::~Synchronizer()
@@ -89,12 +101,12 @@ void Synchronizer::clearLists()
 
 void Synchronizer::reset()
 {
-    displayUpdateCount = 0;
+    displayUpdateTimer.start();
     markEquals = markDiffers = markCopyToLeft = markCopyToRight = markDeletable = true;
     stopped = false;
     recurseSubDirs = followSymLinks = ignoreDate = asymmetric = cmpByContent = ignoreCase = autoScroll = false;
     markEquals = markDiffers = markCopyToLeft = markCopyToRight = markDeletable = markDuplicates = markSingles = false;
-    leftCopyEnabled = rightCopyEnabled = deleteEnabled = overWrite = autoSkip = paused = false;
+    leftCopyEnabled = rightCopyEnabled = deleteEnabled = overWrite = autoSkip = paused = fastLocalCopy = false;
     leftCopyNr = rightCopyNr = deleteNr = 0;
     leftCopySize = rightCopySize = deleteSize = 0;
     comparedDirs = fileCount = 0;
@@ -117,7 +129,9 @@ int Synchronizer::compare(QString leftURL,
                           int equThres,
                           int timeOffs,
                           int parThreads,
-                          bool hiddenFiles)
+                          bool hiddenFiles,
+                          bool cacheHashes,
+                          bool useSnapshot)
 {
     clearLists();
 
@@ -133,6 +147,7 @@ int Synchronizer::compare(QString leftURL,
     timeOffset = timeOffs;
     parallelThreads = parThreads;
     ignoreHidden = hiddenFiles;
+    cacheContentHashes = cacheHashes;
 
     stopped = false;
 
@@ -152,10 +167,35 @@ int Synchronizer::compare(QString leftURL,
             excludedPaths[i].truncate(excludedPaths[i].length() - 1);
 
     comparedDirs = fileCount = 0;
+    caseCollisions.clear();
+
+    if (useSnapshot) {
+        snapshot = new SynchronizerSnapshot(leftURL, rightURL, ignoreHidden);
+        // test mode: read all folders anyway and log where the snapshot differs
+        verifySnapshot = KConfigGroup(krConfig, "Synchronize").readEntry("Verify Snapshot", false);
+    }
 
-    stack.append(new CompareTask(nullptr, leftBaseDir = leftURL, rightBaseDir = rightURL, "", "", ignoreHidden));
+    stack.append(new CompareTask(nullptr, leftBaseDir = leftURL, rightBaseDir = rightURL, "", "", ignoreHidden, ignoreCase));
     compareLoop();
 
+    if (snapshot) {
+        if (!stopped)
+            snapshot->save();
+        delete snapshot;
+        snapshot = nullptr;
+    }
+
+    if (cmpByContent && cacheContentHashes)
+        ContentHashCache::instance()->save();
+
+    if (!stopped && !caseCollisions.isEmpty())
+        KMessageBox::informationList(parentWidget,
+                                     i18n("The following files differ only in the case of their names, only one of them is compared:"),
+                                     caseCollisions,
+                                     i18n("Ambiguous file names"),
+                                     "SynchronizerCaseCollisions");
+    caseCollisions.clear();
+
     QListIterator<SynchronizerFileItem *> it(temporaryList);
     while (it.hasNext()) {
         SynchronizerFileItem *item = it.next();
@@ -174,18 +214,38 @@ int Synchronizer::compare(QString leftURL,
 
 void Synchronizer::compareLoop()
 {
+    // local folder listings and content comparisons work in thread pools and don't count as
+    // parallel threads; only as many are started as can run at once, to keep the number of open
+    // files low
+    const int backgroundThreads = qMax(QThread::idealThreadCount(), 2);
+
     while (!stopped && !stack.isEmpty()) {
-        for (int thread = 0; thread < (int)stack.count() && thread < parallelThreads; thread++) {
+        int foreground = 0;
+        int background = 0;
+        bool idle = true;
+        for (int thread = 0; thread < (int)stack.count() && thread < parallelThreads + backgroundThreads; thread++) {
             SynchronizerTask *entry = stack.at(thread);
 
-            if (entry->state() == ST_STATE_NEW)
+            if (entry->isBackgroundTask() ? background++ >= backgroundThreads : foreground++ >= parallelThreads)
+                continue;
+
+            if (entry->state() == ST_STATE_NEW) {
+                if (auto *ctentry = qobject_cast<CompareTask *>(entry))
+                    ctentry->setSnapshot(snapshot, verifySnapshot);
                 entry->start(parentWidget);
+                idle = false;
+            }
 
             if (entry->inherits("CompareTask")) {
                 if (entry->state() == ST_STATE_READY) {
                     auto *ctentry = qobject_cast<CompareTask *>(entry);
                     if (ctentry->isDuplicate())
-                        compareDirectory(ctentry->parent(), ctentry->leftDirList(), ctentry->rightDirList(), ctentry->leftDir(), ctentry->rightDir());
+                        compareDirectory(ctentry->parent(),
+                                         ctentry->leftDirList(),
+                                         ctentry->rightDirList(),
+                                         ctentry->join(),
+                                         ctentry->leftDir(),
+                                         ctentry->rightDir());
                     else
                         addSingleDirectory(ctentry->parent(), ctentry->dirList(), ctentry->dir(), ctentry->isLeft());
                 }
@@ -195,19 +255,23 @@ void Synchronizer::compareLoop()
             switch (entry->state()) {
             case ST_STATE_STATUS:
                 emit statusInfo(entry->status());
+                idle = false;
                 break;
             case ST_STATE_READY:
             case ST_STATE_ERROR:
+                idle = false;
                 emit statusInfo(i18n("Number of compared folders: %1", comparedDirs));
                 stack.removeAll(entry);
                 delete entry;
+                thread--;
                 continue;
             default:
                 break;
             }
         }
+        // the running tasks report their progress by events, there is nothing to do until then
         if (!stack.isEmpty())
-            qApp->processEvents();
+            qApp->processEvents(idle ? QEventLoop::WaitForMoreEvents : QEventLoop::AllEvents);
     }
 
     QListIterator<SynchronizerTask *> it(stack);
@@ -219,6 +283,7 @@ void Synchronizer::compareLoop()
 void Synchronizer::compareDirectory(SynchronizerFileItem *parent,
                                     SynchronizerDirList *left_directory,
                                     SynchronizerDirList *right_directory,
+                                    const SynchronizerDirJoin &join,
                                     const QString &leftDir,
                                     const QString &rightDir)
 {
@@ -233,8 +298,18 @@ void Synchronizer::compareDirectory(SynchronizerFileItem *parent,
     if (leftDir.isEmpty() && rightDir.isEmpty() && selectedFiles.count())
         checkIfSelected = true;
 
+    if (ignoreCase) {
+        for (const QString &name : left_directory->caseCollisions())
+            caseCollisions << leftURL + name;
+        for (const QString &name : right_directory->caseCollisions())
+            caseCollisions << rightURL + name;
+    }
+
+    // the files of both sides were matched by name in a worker thread, see SynchronizerDirList::join()
+
     /* walking through in the left directory */
-    for (left_file = left_directory->first(); left_file != nullptr && !stopped; left_file = left_directory->next()) {
+    for (int i = 0; i < join.matches.count() && !stopped; i++) {
+        left_file = join.matches[i].first;
         if (isDir(left_file))
             continue;
 
@@ -246,7 +321,7 @@ void Synchronizer::compareDirectory(SynchronizerFileItem *parent,
         if (!query->match(left_file))
             continue;
 
-        if ((right_file = right_directory->search(file_name, ignoreCase)) == nullptr)
+        if ((right_file = join.matches[i].second) == nullptr)
             addLeftOnlyItem(parent,
                             file_name,
                             leftDir,
@@ -283,8 +358,9 @@ void Synchronizer::compareDirectory(SynchronizerFileItem *parent,
         }
     }
 
-    /* walking through in the right directory */
-    for (right_file = right_directory->first(); right_file != nullptr && !stopped; right_file = right_directory->next()) {
+    /* walking through the files only in the right directory */
+    for (int i = 0; i < join.rightOnly.count() && !stopped; i++) {
+        right_file = join.rightOnly[i];
         if (isDir(right_file))
             continue;
 
@@ -296,22 +372,22 @@ void Synchronizer::compareDirectory(SynchronizerFileItem *parent,
         if (!query->match(right_file))
             continue;
 
-        if (left_directory->search(file_name, ignoreCase) == nullptr)
-            addRightOnlyItem(parent,
-                             file_name,
-                             rightDir,
-                             right_file->getSize(),
-                             right_file->getModificationTime(),
-                             readLink(right_file),
-                             right_file->getOwner(),
-                             right_file->getGroup(),
-                             right_file->getMode(),
-                             right_file->getACL());
+        addRightOnlyItem(parent,
+                         file_name,
+                         rightDir,
+                         right_file->getSize(),
+                         right_file->getModificationTime(),
+                         readLink(right_file),
+                         right_file->getOwner(),
+                         right_file->getGroup(),
+                         right_file->getMode(),
+                         right_file->getACL());
     }
 
     /* walking through the subdirectories */
     if (recurseSubDirs) {
-        for (left_file = left_directory->first(); left_file != nullptr && !stopped; left_file = left_directory->next()) {
+        for (int i = 0; i < join.matches.count() && !stopped; i++) {
+            left_file = join.matches[i].first;
             if (left_file->isDir() && (followSymLinks || !left_file->isSymLink())) {
                 QString left_file_name = left_file->getName();
 
@@ -325,7 +401,7 @@ void Synchronizer::compareDirectory(SynchronizerFileItem *parent,
                 if (!query->matchDirName(left_file_name))
                     continue;
 
-                if ((right_file = right_directory->search(left_file_name, ignoreCase)) == nullptr) {
+                if ((right_file = join.matches[i].second) == nullptr) {
                     SynchronizerFileItem *me = addLeftOnlyItem(parent,
                                                                left_file_name,
                                                                leftDir,
@@ -371,13 +447,15 @@ void Synchronizer::compareDirectory(SynchronizerFileItem *parent,
                                                  rightURL + right_file_name + '/',
                                                  leftDir.isEmpty() ? left_file_name : leftDir + '/' + left_file_name,
                                                  rightDir.isEmpty() ? right_file_name : rightDir + '/' + right_file_name,
-                                                 ignoreHidden));
+                                                 ignoreHidden,
+                                                 ignoreCase));
                 }
             }
         }
 
-        /* walking through the right side subdirectories */
-        for (right_file = right_directory->first(); right_file != nullptr && !stopped; right_file = right_directory->next()) {
+        /* walking through the subdirectories only in the right directory */
+        for (int i = 0; i < join.rightOnly.count() && !stopped; i++) {
+            right_file = join.rightOnly[i];
             if (right_file->isDir() && (followSymLinks || !right_file->isSymLink())) {
                 file_name = right_file->getName();
 
@@ -391,22 +469,20 @@ void Synchronizer::compareDirectory(SynchronizerFileItem *parent,
                 if (!query->matchDirName(file_name))
                     continue;
 
-                if (left_directory->search(file_name, ignoreCase) == nullptr) {
-                    SynchronizerFileItem *me = addRightOnlyItem(parent,
-                                                                file_name,
-                                                                rightDir,
-                                                                0,
-                                                                right_file->getModificationTime(),
-                                                                readLink(right_file),
-                                                                right_file->getOwner(),
-                                                                right_file->getGroup(),
-                                                                right_file->getMode(),
-                                                                right_file->getACL(),
-                                                                true,
-                                                                !query->match(right_file));
-                    stack.append(
-                        new CompareTask(me, rightURL + file_name + '/', rightDir.isEmpty() ? file_name : rightDir + '/' + file_name, false, ignoreHidden));
-                }
+                SynchronizerFileItem *me = addRightOnlyItem(parent,
+                                                            file_name,
+                                                            rightDir,
+                                                            0,
+                                                            right_file->getModificationTime(),
+                                                            readLink(right_file),
+                                                            right_file->getOwner(),
+                                                            right_file->getGroup(),
+                                                            right_file->getMode(),
+                                                            right_file->getACL(),
+                                                            true,
+                                                            !query->match(right_file));
+                stack.append(
+                    new CompareTask(me, rightURL + file_name + '/', rightDir.isEmpty() ? file_name : rightDir + '/' + file_name, false, ignoreHidden));
             }
         }
     }
@@ -489,8 +565,10 @@ SynchronizerFileItem *Synchronizer::addItem(SynchronizerFileItem *parent,
         if (doRefresh)
             refresh(true);
 
-        if (marked && (displayUpdateCount++ % DISPLAY_UPDATE_PERIOD == (DISPLAY_UPDATE_PERIOD - 1)))
+        if (marked && displayUpdateTimer.hasExpired(DISPLAY_UPDATE_INTERVAL)) {
             qApp->processEvents();
+            displayUpdateTimer.start();
+        }
     } else
         temporaryList.append(item);
 
@@ -1061,7 +1139,13 @@ void Synchronizer::setScrolling(bool scroll)
     }
 }
 
-void Synchronizer::synchronize(QWidget *syncWdg, bool leftCopyEnabled, bool rightCopyEnabled, bool deleteEnabled, bool overWrite, int parThreads)
+void Synchronizer::synchronize(QWidget *syncWdg,
+                               bool leftCopyEnabled,
+                               bool rightCopyEnabled,
+                               bool deleteEnabled,
+                               bool overWrite,
+                               int parThreads,
+                               bool fastCopy)
 {
     this->leftCopyEnabled = leftCopyEnabled;
     this->rightCopyEnabled = rightCopyEnabled;
@@ -1069,17 +1153,21 @@ void Synchronizer::synchronize(QWidget *syncWdg, bool leftCopyEnabled, bool righ
     this->overWrite = overWrite;
     this->parallelThreads = parThreads;
     this->syncDlgWidget = syncWdg;
+    this->fastLocalCopy = fastCopy;
 
-    autoSkip = paused = disableNewTasks = false;
+    autoSkip = paused = false;
 
     leftCopyNr = rightCopyNr = deleteNr = 0;
     leftCopySize = rightCopySize = deleteSize = 0;
 
     inTaskFinished = 0;
-    lastTask = nullptr;
+    largeCopies[0] = largeCopies[1] = 0;
+    waitingLargeCopies[0] = waitingLargeCopies[1] = 0;
 
     jobMap.clear();
     receivedMap.clear();
+    waitingTasks.clear();
+    creatingDirs.clear();
 
     resultListIt = resultList;
     synchronizeLoop();
@@ -1087,49 +1175,126 @@ void Synchronizer::synchronize(QWidget *syncWdg, bool leftCopyEnabled, bool righ
 
 void Synchronizer::synchronizeLoop()
 {
-    if (disableNewTasks) {
-        if (!resultListIt.hasNext() && jobMap.count() == 0)
-            emit synchronizationFinished();
-        return;
-    }
+    SynchronizerFileItem *task;
+    while ((task = getNextTask()) != nullptr)
+        executeTask(task);
 
-    while ((int)jobMap.count() < parallelThreads) {
-        SynchronizerFileItem *task = getNextTask();
-        if (task == nullptr) {
-            if (jobMap.count() == 0)
-                emit synchronizationFinished();
-            return;
+    // a waiting task can always start if nothing else runs
+    if (jobMap.isEmpty() && waitingTasks.isEmpty() && !resultListIt.hasNext())
+        emit synchronizationFinished();
+}
+
+SynchronizerFileItem *Synchronizer::getNextTask()
+{
+    const int freeSlots = parallelThreads - jobMap.count();
+    if (freeSlots <= 0)
+        return nullptr;
+
+    // the last free slot goes to a small task if there is one, so the large copies don't hold
+    // up the small ones, which are bound by the latency
+    const bool lastSlot = freeSlots == 1 && parallelThreads > 1;
+    SynchronizerFileItem *task = takeNextTask(lastSlot);
+    if (task == nullptr && lastSlot)
+        task = takeNextTask(false);
+    return task;
+}
+
+SynchronizerFileItem *Synchronizer::takeNextTask(bool smallOnly)
+{
+    // the tasks which had to wait come first, in list order
+    for (int i = 0; i < waitingTasks.count(); i++) {
+        if (canStart(waitingTasks[i], smallOnly)) {
+            SynchronizerFileItem *task = waitingTasks.takeAt(i);
+            const int side = largeCopySide(task);
+            if (side >= 0)
+                waitingLargeCopies[side]--;
+            return task;
         }
-        executeTask(task);
-        if (disableNewTasks)
-            break;
     }
+
+    while (waitingTasks.count() < MAX_WAITING_TASKS && resultListIt.hasNext()) {
+        SynchronizerFileItem *currentTask = resultListIt.next();
+        if (!isSynchronized(currentTask))
+            continue;
+        if (canStart(currentTask, smallOnly))
+            return currentTask;
+        waitingTasks.append(currentTask);
+        const int side = largeCopySide(currentTask);
+        if (side >= 0)
+            waitingLargeCopies[side]++;
+    }
+    return nullptr;
 }
 
-SynchronizerFileItem *Synchronizer::getNextTask()
+bool Synchronizer::isSynchronized(SynchronizerFileItem *task)
 {
-    TaskType task;
-    SynchronizerFileItem *currentTask;
+    if (!task->isMarked())
+        return false;
 
-    do {
-        if (!resultListIt.hasNext())
-            return nullptr;
+    switch (task->task()) {
+    case TT_COPY_TO_LEFT:
+        return leftCopyEnabled;
+    case TT_COPY_TO_RIGHT:
+        return rightCopyEnabled;
+    case TT_DELETE:
+        return deleteEnabled;
+    default:
+        return false;
+    }
+}
 
-        currentTask = resultListIt.next();
+bool Synchronizer::canStart(SynchronizerFileItem *task, bool smallOnly)
+{
+    // a file can be copied when its folder exists, independent of other files
+    for (SynchronizerFileItem *parent = task->parent(); parent != nullptr; parent = parent->parent()) {
+        if (creatingDirs.contains(parent))
+            return false;
+    }
 
-        if (currentTask->isMarked()) {
-            task = currentTask->task();
+    const int side = largeCopySide(task);
+    if (side < 0)
+        return true;
+    if (smallOnly)
+        return false;
+    // while there are large copies in both directions they alternate, so both sides read and write
+    const int otherSide = 1 - side;
+    return largeCopies[side] <= largeCopies[otherSide] || waitingLargeCopies[otherSide] == 0;
+}
 
-            if (leftCopyEnabled && task == TT_COPY_TO_LEFT)
-                break;
-            else if (rightCopyEnabled && task == TT_COPY_TO_RIGHT)
-                break;
-            else if (deleteEnabled && task == TT_DELETE)
-                break;
-        }
-    } while (true);
+int Synchronizer::largeCopySide(SynchronizerFileItem *task)
+{
+    if (task->isDir())
+        return -1;
 
-    return lastTask = currentTask;
+    switch (task->task()) {
+    case TT_COPY_TO_LEFT:
+        return task->rightSize() >= LARGE_FILE_SIZE ? 0 : -1;
+    case TT_COPY_TO_RIGHT:
+        return task->leftSize() >= LARGE_FILE_SIZE ? 1 : -1;
+    default:
+        return -1;
+    }
+}
+
+KJob *Synchronizer::copyFile(const QUrl &source, const QUrl &destination, bool overwrite)
+{
+    if (fastLocalCopy && source.isLocalFile() && destination.isLocalFile()
+        && LocalCopyJob::isSameFileSystem(source.toLocalFile(), destination.toLocalFile())) {
+        auto *job = new LocalCopyJob(source.toLocalFile(), destination.toLocalFile(), overwrite, this);
+        job->setUiDelegate(KIO::createDefaultJobUiDelegate());
+        connect(job, &KJob::processedAmount, this, [this](KJob *job, KJob::Unit unit, qulonglong amount) {
+            if (unit == KJob::Bytes)
+                slotProcessedSize(job, amount);
+        });
+        connect(job, &KJob::result, this, &Synchronizer::slotTaskFinished);
+        job->start();
+        return job;
+    }
+
+    KIO::FileCopyJob *job = KIO::file_copy(source, destination, -1, (overwrite ? KIO::Overwrite : KIO::DefaultFlags) | KIO::HideProgressInfo);
+    connect(job, SIGNAL(processedSize(KJob *, qulonglong)), this, SLOT(slotProcessedSize(KJob *, qulonglong)));
+    connect(job, &KIO::FileCopyJob::result, this, &Synchronizer::slotTaskFinished);
+    return job;
 }
 
 void Synchronizer::executeTask(SynchronizerFileItem *task)
@@ -1144,24 +1309,24 @@ void Synchronizer::executeTask(SynchronizerFileItem *task)
     QUrl leftURL = Synchronizer::fsUrl(leftBaseDir + leftDirName + task->leftName());
     QUrl rightURL = Synchronizer::fsUrl(rightBaseDir + rightDirName + task->rightName());
 
+    const int side = largeCopySide(task);
+    if (side >= 0)
+        largeCopies[side]++;
+
     switch (task->task()) {
     case TT_COPY_TO_LEFT:
         if (task->isDir()) {
             KIO::SimpleJob *job = KIO::mkdir(leftURL);
             connect(job, &KIO::MkdirJob::result, this, &Synchronizer::slotTaskFinished);
             jobMap[job] = task;
-            disableNewTasks = true;
+            creatingDirs.insert(task);
         } else {
             QUrl destURL(leftURL);
             if (!task->destination().isNull())
                 destURL = Synchronizer::fsUrl(task->destination());
 
             if (task->rightLink().isNull()) {
-                KIO::FileCopyJob *job =
-                    KIO::file_copy(rightURL, destURL, -1, ((overWrite || task->overWrite()) ? KIO::Overwrite : KIO::DefaultFlags) | KIO::HideProgressInfo);
-                connect(job, SIGNAL(processedSize(KJob *, qulonglong)), this, SLOT(slotProcessedSize(KJob *, qulonglong)));
-                connect(job, &KIO::FileCopyJob::result, this, &Synchronizer::slotTaskFinished);
-                jobMap[job] = task;
+                jobMap[copyFile(rightURL, destURL, overWrite || task->overWrite())] = task;
             } else {
                 KIO::SimpleJob *job =
                     KIO::symlink(task->rightLink(), destURL, ((overWrite || task->overWrite()) ? KIO::Overwrite : KIO::DefaultFlags) | KIO::HideProgressInfo);
@@ -1175,18 +1340,14 @@ void Synchronizer::executeTask(SynchronizerFileItem *task)
             KIO::SimpleJob *job = KIO::mkdir(rightURL);
             connect(job, &KIO::SimpleJob::result, this, &Synchronizer::slotTaskFinished);
             jobMap[job] = task;
-            disableNewTasks = true;
+            creatingDirs.insert(task);
         } else {
             QUrl destURL(rightURL);
             if (!task->destination().isNull())
                 destURL = Synchronizer::fsUrl(task->destination());
 
             if (task->leftLink().isNull()) {
-                KIO::FileCopyJob *job =
-                    KIO::file_copy(leftURL, destURL, -1, ((overWrite || task->overWrite()) ? KIO::Overwrite : KIO::DefaultFlags) | KIO::HideProgressInfo);
-                connect(job, SIGNAL(processedSize(KJob *, qulonglong)), this, SLOT(slotProcessedSize(KJob *, qulonglong)));
-                connect(job, &KIO::FileCopyJob::result, this, &Synchronizer::slotTaskFinished);
-                jobMap[job] = task;
+                jobMap[copyFile(leftURL, destURL, overWrite || task->overWrite())] = task;
             } else {
                 KIO::SimpleJob *job =
                     KIO::symlink(task->leftLink(), destURL, ((overWrite || task->overWrite()) ? KIO::Overwrite : KIO::DefaultFlags) | KIO::HideProgressInfo);
@@ -1219,8 +1380,12 @@ void Synchronizer::slotTaskFinished(KJob *job)
         receivedMap.remove(job);
     }
 
-    if (disableNewTasks && item == lastTask)
-        disableNewTasks = false; // the blocker task finished
+    // the content of a created folder can be copied now, even if creating it failed: the
+    // errors are reported for each file then
+    creatingDirs.remove(item);
+    const int side = largeCopySide(item);
+    if (side >= 0)
+        largeCopies[side]--;
 
     QString leftDirName = item->leftDirectory().isEmpty() ? "" : item->leftDirectory() + '/';
     QString rightDirName = item->rightDirectory().isEmpty() ? "" : item->rightDirectory() + '/';
@@ -9,9 +9,11 @@
 #define SYNCHRONIZER_H
 
 // QtCore
+#include <QElapsedTimer>
 #include <QList>
 #include <QMap>
 #include <QObject>
+#include <QSet>
 // QtGui
 #include <QColor>
 // QtWidgets
@@ -23,6 +25,7 @@
 #include "synchronizertask.h"
 
 class KrQuery;
+class SynchronizerSnapshot;
 class FileItem;
 
 class Synchronizer : public QObject
@@ -30,7 +33,7 @@ class Synchronizer : public QObject
     Q_OBJECT
 
 private:
-    int displayUpdateCount; // the display is refreshed after every x-th change
+    QElapsedTimer displayUpdateTimer; // the display is refreshed periodically while comparing
 
 public:
     Synchronizer();
@@ -49,7 +52,9 @@ public:
                 int equThres,
                 int timeOffs,
                 int parThreads,
-                bool hiddenFiles);
+                bool hiddenFiles,
+                bool cacheHashes,
+                bool useSnapshot);
     void stop()
     {
         stopped = true;
@@ -57,7 +62,7 @@ public:
     void setMarkFlags(bool left, bool equal, bool differs, bool right, bool dup, bool sing, bool del);
     int refresh(bool nostatus = false);
     bool totalSizes(int *, KIO::filesize_t *, int *, KIO::filesize_t *, int *, KIO::filesize_t *);
-    void synchronize(QWidget *, bool leftCopyEnabled, bool rightCopyEnabled, bool deleteEnabled, bool overWrite, int parThreads);
+    void synchronize(QWidget *, bool leftCopyEnabled, bool rightCopyEnabled, bool deleteEnabled, bool overWrite, int parThreads, bool fastCopy = false);
     void synchronizeWithKGet();
     void setScrolling(bool scroll);
     void pause();
@@ -102,7 +107,12 @@ private:
     bool isDir(const FileItem *file);
     QString readLink(const FileItem *file);
 
-    void compareDirectory(SynchronizerFileItem *, SynchronizerDirList *, SynchronizerDirList *, const QString &leftDir, const QString &rightDir);
+    void compareDirectory(SynchronizerFileItem *,
+                          SynchronizerDirList *,
+                          SynchronizerDirList *,
+                          const SynchronizerDirJoin &,
+                          const QString &leftDir,
+                          const QString &rightDir);
     void addSingleDirectory(SynchronizerFileItem *, SynchronizerDirList *, const QString &, bool);
     SynchronizerFileItem *addItem(SynchronizerFileItem *,
                                   const QString &,
@@ -177,7 +187,13 @@ private:
     bool markParentDirectories(SynchronizerFileItem *);
     void synchronizeLoop();
     SynchronizerFileItem *getNextTask();
+    SynchronizerFileItem *takeNextTask(bool smallOnly);
+    bool isSynchronized(SynchronizerFileItem *task);
+    bool canStart(SynchronizerFileItem *task, bool smallOnly);
+    /// Return 0 for a large file copied to the left, 1 to the right, -1 for all other tasks
+    int largeCopySide(SynchronizerFileItem *task);
     void executeTask(SynchronizerFileItem *task);
+    KJob *copyFile(const QUrl &source, const QUrl &destination, bool overwrite);
     void setPermanent(SynchronizerFileItem *);
     void operate(SynchronizerFileItem *item, void (*)(SynchronizerFileItem *));
     void compareLoop();
@@ -202,12 +218,16 @@ protected:
     QString leftBaseDir; // the left-side base directory
     QString rightBaseDir; // the right-side base directory
     QStringList excludedPaths; // list of the excluded paths
+    QStringList caseCollisions; // files ambiguous at case insensitive comparing
     KrQuery *query; // the filter used for the query
     bool stopped; // 'Stop' button was pressed
 
     int equalsThreshold; // threshold to treat files equal
     int timeOffset; // time offset between the left and right sides
     bool ignoreHidden; // ignores the hidden files
+    bool cacheContentHashes; // remember the content hashes of equal local files
+    SynchronizerSnapshot *snapshot; // the folders of the last compare, if they are reused
+    bool verifySnapshot; // test mode: read the folders anyway and log differences to the snapshot
 
     bool markEquals; // show the equal files
     bool markDiffers; // show the different files
@@ -223,7 +243,7 @@ protected:
     bool overWrite; // overwrite or query each modification
     bool autoSkip; // automatic skipping
     bool paused; // pause flag
-    bool disableNewTasks; // at mkdir the further task creation is disabled
+    bool fastLocalCopy; // copy local files with copy offloading or reflinks
 
     int leftCopyNr; // the file number copied to left
     int rightCopyNr; // the file number copied to right
@@ -240,7 +260,10 @@ private:
     QList<SynchronizerTask *> stack; // stack for comparing
     QMap<KJob *, SynchronizerFileItem *> jobMap; // job maps
     QMap<KJob *, KIO::filesize_t> receivedMap; // the received file size
-    SynchronizerFileItem *lastTask; // reference to the last stack
+    QList<SynchronizerFileItem *> waitingTasks; // tasks which can't start yet, in list order
+    QSet<SynchronizerFileItem *> creatingDirs; // the folders being created, their content has to wait
+    int largeCopies[2]; // the running copies of large files, to the left and to the right
+    int waitingLargeCopies[2]; // the copies of large files among the waiting tasks
     int inTaskFinished; // counter of quasy 'threads' in slotTaskFinished
 
     QStringList selectedFiles; // the selected files to compare
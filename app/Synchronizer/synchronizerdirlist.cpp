@@ -16,9 +16,11 @@
 
 #include <qplatformdefs.h>
 // QtCore
+#include <QDebug>
 #include <QDir>
-// QtWidgets
-#include <QApplication>
+#include <QEventLoop>
+#include <QSet>
+#include <QtConcurrent/QtConcurrentRun> // krazy:exclude=includes
 
 #include <KFileItem>
 #include <KIO/JobUiDelegate>
@@ -27,7 +29,9 @@
 
 #include "../FileSystem/filesystem.h"
 #include "../FileSystem/krpermhandler.h"
+#include "../FileSystem/locallister.h"
 #include "../krservices.h"
+#include "synchronizersnapshot.h"
 
 SynchronizerDirList::SynchronizerDirList(QWidget *w, bool hidden)
     : fileIterator(nullptr)
@@ -36,38 +40,77 @@ SynchronizerDirList::SynchronizerDirList(QWidget *w, bool hidden)
     , result(false)
     , ignoreHidden(hidden)
     , currentUrl()
+    , localListWatcher(nullptr)
+    , snapshot(nullptr)
+    , verifySnapshot(false)
+    , foldedIndexValid(false)
 {
 }
 
 SynchronizerDirList::~SynchronizerDirList()
 {
-    if (fileIterator)
-        delete fileIterator;
+    if (localListWatcher && localListWatcher->isRunning()) {
+        canceled.storeRelease(1);
+        localListWatcher->waitForFinished();
+    }
+    clearItems();
+}
 
+void SynchronizerDirList::clearItems()
+{
     QHashIterator<QString, FileItem *> lit(*this);
     while (lit.hasNext())
         delete lit.next().value();
+    clear();
+    if (fileIterator) {
+        delete fileIterator;
+        fileIterator = nullptr;
+    }
+
+    foldedIndex.clear();
+    foldedCollisions.clear();
+    foldedIndexValid = false;
 }
 
 FileItem *SynchronizerDirList::search(const QString &name, bool ignoreCase)
 {
-    if (!ignoreCase) {
-        if (!contains(name))
-            return nullptr;
-        return (*this)[name];
-    }
+    FileItem *item = value(name);
+    if (item || !ignoreCase)
+        return item;
 
-    QHashIterator<QString, FileItem *> iter(*this);
-    iter.toFront();
+    if (!foldedIndexValid)
+        buildFoldedIndex();
+    return foldedIndex.value(name.toCaseFolded());
+}
 
-    QString file = name.toLower();
+const QStringList &SynchronizerDirList::caseCollisions()
+{
+    if (!foldedIndexValid)
+        buildFoldedIndex();
+    return foldedCollisions;
+}
 
-    while (iter.hasNext()) {
-        FileItem *item = iter.next().value();
-        if (file == item->getName().toLower())
-            return item;
+void SynchronizerDirList::buildFoldedIndex()
+{
+    foldedIndex.clear();
+    foldedIndex.reserve(count());
+    foldedCollisions.clear();
+    QSet<FileItem *> reported; // the indexed items already listed as collisions
+
+    for (auto it = constBegin(); it != constEnd(); ++it) {
+        FileItem *&indexed = foldedIndex[it.key().toCaseFolded()];
+        if (!indexed) {
+            indexed = it.value();
+            continue;
+        }
+        // the first item stays in the index, all ambiguous names are reported
+        if (!reported.contains(indexed)) {
+            reported.insert(indexed);
+            foldedCollisions << indexed->getName();
+        }
+        foldedCollisions << it.key();
     }
-    return nullptr;
+    foldedIndexValid = true;
 }
 
 FileItem *SynchronizerDirList::first()
@@ -99,42 +142,24 @@ bool SynchronizerDirList::load(const QString &urlIn, bool wait)
     currentUrl = urlIn;
     const QUrl url = QUrl::fromUserInput(urlIn, QString(), QUrl::AssumeLocalFile);
 
-    QHashIterator<QString, FileItem *> lit(*this);
-    while (lit.hasNext())
-        delete lit.next().value();
-    clear();
-    if (fileIterator) {
-        delete fileIterator;
-        fileIterator = nullptr;
-    }
+    clearItems();
 
     if (url.isLocalFile()) {
-        const QString dir = FileSystem::ensureTrailingSlash(url).path();
-
-        QT_DIR *qdir = QT_OPENDIR(dir.toLocal8Bit());
-        if (!qdir) {
-            KMessageBox::error(parentWidget, i18n("Cannot open the folder %1.", dir), i18n("Error"));
-            emit finished(result = false);
-            return false;
-        }
-
-        QT_DIRENT *dirEnt;
-
-        while ((dirEnt = QT_READDIR(qdir)) != nullptr) {
-            const QString name = QString::fromLocal8Bit(dirEnt->d_name);
-
-            if (name == "." || name == "..")
-                continue;
-            if (ignoreHidden && name.startsWith('.'))
-                continue;
-
-            FileItem *item = FileSystem::createLocalFileItem(name, dir);
-
-            insert(name, item);
+        localPath = FileSystem::ensureTrailingSlash(url).path();
+        if (wait)
+            return localListFinished(listLocalFolder());
+
+        // the items are only inserted by the worker thread until it's finished
+        if (!localListWatcher) {
+            localListWatcher = new QFutureWatcher<bool>(this);
+            connect(localListWatcher, &QFutureWatcher<bool>::finished, this, [this]() {
+                localListFinished(localListWatcher->result());
+            });
         }
-
-        QT_CLOSEDIR(qdir);
-        emit finished(result = true);
+        busy = true;
+        localListWatcher->setFuture(QtConcurrent::run([this]() {
+            return listLocalFolder();
+        }));
         return true;
     } else {
         KIO::ListJob *job = KIO::listDir(KrServices::escapeFileUrl(url), KIO::HideProgressInfo, true);
@@ -145,12 +170,95 @@ bool SynchronizerDirList::load(const QString &urlIn, bool wait)
         if (!wait)
             return true;
 
-        while (busy)
-            qApp->processEvents();
+        QEventLoop loop;
+        connect(this, &SynchronizerDirList::finished, &loop, &QEventLoop::quit);
+        if (busy)
+            loop.exec();
         return result;
     }
 }
 
+void SynchronizerDirList::setSnapshot(SynchronizerSnapshot *snapshotIn, bool verify)
+{
+    snapshot = snapshotIn;
+    verifySnapshot = verify;
+}
+
+bool SynchronizerDirList::listLocalFolder()
+{
+    LocalLister lister(localPath);
+    if (!lister.open())
+        return false;
+
+    struct stat directoryStat;
+    const bool useSnapshot = snapshot && lister.directoryStatus(directoryStat);
+
+    QVector<SynchronizerSnapshot::Entry> entries;
+    const bool cached = useSnapshot && snapshot->find(localPath, directoryStat, entries);
+
+    if (!cached || verifySnapshot) {
+        QVector<SynchronizerSnapshot::Entry> listed;
+        QByteArray encodedName;
+        unsigned char type;
+        while (lister.next(encodedName, type) && !canceled.loadAcquire()) {
+            if (ignoreHidden && encodedName.startsWith('.'))
+                continue;
+            listed.append(SynchronizerSnapshot::Entry{encodedName, type});
+        }
+        // a truncated listing would make the missing files look deleted
+        if (lister.error())
+            return false;
+
+        if (cached && !canceled.loadAcquire() && !SynchronizerSnapshot::sameNames(entries, listed))
+            qWarning() << "Synchronizer snapshot of" << localPath << "is out of date";
+        entries = listed;
+    }
+
+    // the status of the files is always read, they may change without changing the folder
+    for (const SynchronizerSnapshot::Entry &entry : qAsConst(entries)) {
+        if (canceled.loadAcquire())
+            return true;
+
+        FileItem *item = lister.createFileItem(entry.name, entry.type);
+
+        insert(item->getName(), item);
+    }
+
+    if (useSnapshot && !canceled.loadAcquire())
+        snapshot->insert(localPath, directoryStat, entries);
+    return true;
+}
+
+bool SynchronizerDirList::localListFinished(bool ok)
+{
+    busy = false;
+    if (!ok)
+        KMessageBox::error(parentWidget, i18n("Cannot open the folder %1.", localPath), i18n("Error"));
+
+    emit finished(result = ok);
+    return ok;
+}
+
+SynchronizerDirJoin SynchronizerDirList::join(SynchronizerDirList *left, SynchronizerDirList *right, bool ignoreCase)
+{
+    SynchronizerDirJoin join;
+    join.matches.reserve(left->count());
+    for (auto it = left->constBegin(); it != left->constEnd(); ++it)
+        join.matches.append(qMakePair(it.value(), right->search(it.key(), ignoreCase)));
+
+    for (auto it = right->constBegin(); it != right->constEnd(); ++it) {
+        if (!left->search(it.key(), ignoreCase))
+            join.rightOnly.append(it.value());
+    }
+
+    if (ignoreCase) {
+        // build both indexes here, not later in the GUI thread
+        left->caseCollisions();
+        right->caseCollisions();
+    }
+    return join;
+}
+
 void SynchronizerDirList::slotEntries(KIO::Job *job, const KIO::UDSEntryList &entries)
 {
     auto *listJob = dynamic_cast<KIO::ListJob *>(job);
@@ -9,13 +9,26 @@
 #define SYNCHRONIZERDIRLIST_H
 
 // QtCore
+#include <QAtomicInt>
+#include <QFutureWatcher>
 #include <QHash>
 #include <QObject>
+#include <QPair>
+#include <QStringList>
+#include <QVector>
 
 #include <KIO/Job>
 
 #include "../FileSystem/fileitem.h"
 
+class SynchronizerSnapshot;
+
+/// The items of two folders matched by name, see SynchronizerDirList::join()
+struct SynchronizerDirJoin {
+    QVector<QPair<FileItem *, FileItem *>> matches; //< every left item with its right counterpart or nullptr
+    QVector<FileItem *> rightOnly; //< the right items without left counterpart
+};
+
 class SynchronizerDirList : public QObject, public QHash<QString, FileItem *>
 {
     Q_OBJECT
@@ -25,6 +38,8 @@ public:
     ~SynchronizerDirList() override;
 
     FileItem *search(const QString &name, bool ignoreCase = false);
+    /// Names in this folder which differ only in case, they are ambiguous when ignoring the case
+    const QStringList &caseCollisions();
     FileItem *first();
     FileItem *next();
 
@@ -33,6 +48,15 @@ public:
         return currentUrl;
     }
     bool load(const QString &urlIn, bool wait = false);
+    /// Reuse the names of unchanged local folders from @p snapshot. If @p verify is set, the
+    /// folders are read anyway and differences are logged.
+    void setSnapshot(SynchronizerSnapshot *snapshot, bool verify);
+
+    /**
+     * Match the items of two loaded folders by name. Does not touch the GUI, so it may run in a
+     * worker thread as long as the folders are not used by others meanwhile.
+     */
+    static SynchronizerDirJoin join(SynchronizerDirList *left, SynchronizerDirList *right, bool ignoreCase);
 
 public slots:
 
@@ -43,12 +67,25 @@ signals:
     void finished(bool err);
 
 private:
+    void clearItems();
+    void buildFoldedIndex();
+    bool listLocalFolder();
+    bool localListFinished(bool ok);
+
     QHashIterator<QString, FileItem *> *fileIterator; //< Point to a dictionary of file items
     QWidget *parentWidget;
     bool busy;
     bool result;
     bool ignoreHidden;
     QString currentUrl;
+    QString localPath;
+    QFutureWatcher<bool> *localListWatcher; //< lists local folders in a worker thread
+    QAtomicInt canceled;
+    SynchronizerSnapshot *snapshot;
+    bool verifySnapshot;
+    QHash<QString, FileItem *> foldedIndex; //< case folded name -> item, built on the first case insensitive search
+    bool foldedIndexValid;
+    QStringList foldedCollisions;
 };
 
 #endif /* __SYNCHRONIZER_DIR_LIST_H__ */
@@ -443,6 +443,16 @@ void SynchronizerGUI::initGUI(const QString &profileName, QUrl leftURL, QUrl rig
     ignoreHiddenFilesCB = new QCheckBox(i18n("Ignore hidden files"), optionsGroup);
     optionsLayout->addWidget(ignoreHiddenFilesCB, 4, 0, 1, 3);
 
+    cacheContentHashesCB = new QCheckBox(i18n("Remember checksums of equal files"), optionsGroup);
+    cacheContentHashesCB->setToolTip(i18n("When comparing by content, unchanged local files which were equal before are not read again."));
+    cacheContentHashesCB->setChecked(group.readEntry("Cache Content Hashes", false));
+    optionsLayout->addWidget(cacheContentHashesCB, 5, 0, 1, 3);
+
+    useSnapshotCB = new QCheckBox(i18n("Remember folder contents"), optionsGroup);
+    useSnapshotCB->setToolTip(i18n("Local folders which did not change since the last compare of the same folders are not read again."));
+    useSnapshotCB->setChecked(group.readEntry("Use Snapshot", false));
+    optionsLayout->addWidget(useSnapshotCB, 6, 0, 1, 3);
+
     generalFilter->middleLayout->addWidget(optionsGroup);
 
     /* ================================== Buttons =================================== */
@@ -934,6 +944,8 @@ void SynchronizerGUI::closeDialog()
     group.writeEntry("Scroll Results", btnScrollResults->isChecked());
 
     group.writeEntry("Parallel Threads", parallelThreadsSpinBox->value());
+    group.writeEntry("Cache Content Hashes", cacheContentHashesCB->isChecked());
+    group.writeEntry("Use Snapshot", useSnapshotCB->isChecked());
 
     group.writeEntry("Window Width", size().width());
     group.writeEntry("Window Height", size().height());
@@ -1017,7 +1029,9 @@ void SynchronizerGUI::compare()
                                          convertToSeconds(equalitySpinBox->value(), equalityUnitCombo->currentIndex()),
                                          convertToSeconds(timeShiftSpinBox->value(), timeShiftUnitCombo->currentIndex()),
                                          parallelThreadsSpinBox->value(),
-                                         ignoreHiddenFilesCB->isChecked());
+                                         ignoreHiddenFilesCB->isChecked(),
+                                         cacheContentHashesCB->isChecked(),
+                                         useSnapshotCB->isChecked());
     enableMarkButtons();
     btnStopComparing->setEnabled(isComparing = false);
     btnStopComparing->hide();
@@ -1462,6 +1476,9 @@ void SynchronizerGUI::loadFromProfile(const QString &profile)
     bool ignoreHidden = pg.readEntry("Ignore Hidden Files", false);
     ignoreHiddenFilesCB->setChecked(ignoreHidden);
 
+    cacheContentHashesCB->setChecked(pg.readEntry("Cache Content Hashes", false));
+    useSnapshotCB->setChecked(pg.readEntry("Use Snapshot", false));
+
     refresh();
     btnCompareDirs->setFocus();
 }
@@ -1496,6 +1513,8 @@ void SynchronizerGUI::saveToProfile(const QString &profile)
     group.writeEntry("Parallel Threads", parallelThreadsSpinBox->value());
 
     group.writeEntry("Ignore Hidden Files", ignoreHiddenFilesCB->isChecked());
+    group.writeEntry("Cache Content Hashes", cacheContentHashesCB->isChecked());
+    group.writeEntry("Use Snapshot", useSnapshotCB->isChecked());
 }
 
 void SynchronizerGUI::connectFilters(const QString &newString)
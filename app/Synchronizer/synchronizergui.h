@@ -252,6 +252,8 @@ protected:
     QSpinBox *timeShiftSpinBox;
     QComboBox *timeShiftUnitCombo;
     QCheckBox *ignoreHiddenFilesCB;
+    QCheckBox *cacheContentHashesCB;
+    QCheckBox *useSnapshotCB;
 
 private:
     static QString dirLabel(); // returns translated '<DIR>'
@@ -0,0 +1,167 @@
+/*
+    SPDX-FileCopyrightText: 2026 Krusader Krew <https://krusader.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "synchronizersnapshot.h"
+
+// QtCore
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#include <algorithm>
+
+static const quint32 SNAPSHOT_VERSION = 1;
+// folders changed less than this time (ns) before listing are not remembered, see the class comment
+static const qint64 RACY_INTERVAL = Q_INT64_C(2000000000);
+// the smallest size of a folder record (path, device, inode, times, entry count) and of an entry
+static const qint64 MIN_DIRECTORY_SIZE = 4 + 4 * 8 + 4;
+static const qint64 MIN_ENTRY_SIZE = 4 + 1;
+
+static qint64 modificationTime(const struct stat &fileStat)
+{
+#ifdef Q_OS_LINUX
+    return static_cast<qint64>(fileStat.st_mtim.tv_sec) * 1000000000 + fileStat.st_mtim.tv_nsec;
+#else
+    return static_cast<qint64>(fileStat.st_mtime) * 1000000000;
+#endif
+}
+
+static qint64 changeTime(const struct stat &fileStat)
+{
+#ifdef Q_OS_LINUX
+    return static_cast<qint64>(fileStat.st_ctim.tv_sec) * 1000000000 + fileStat.st_ctim.tv_nsec;
+#else
+    return static_cast<qint64>(fileStat.st_ctime) * 1000000000;
+#endif
+}
+
+static QString snapshotFileName(const QString &leftUrl, const QString &rightUrl, bool ignoreHidden)
+{
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    hash.addData(leftUrl.toUtf8());
+    hash.addData("\n", 1);
+    hash.addData(rightUrl.toUtf8());
+    hash.addData(ignoreHidden ? "\n1" : "\n0", 2);
+    return QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation) + QStringLiteral("/krusader/synchronizer-snapshots/")
+        + QString::fromLatin1(hash.result().toHex());
+}
+
+SynchronizerSnapshot::SynchronizerSnapshot(const QString &leftUrl, const QString &rightUrl, bool ignoreHidden)
+    : m_fileName(snapshotFileName(leftUrl, rightUrl, ignoreHidden))
+    , m_loaded(false)
+{
+}
+
+bool SynchronizerSnapshot::find(const QString &directory, const struct stat &directoryStat, QVector<Entry> &entries)
+{
+    QMutexLocker locker(&m_mutex);
+    load();
+
+    const auto it = m_previous.constFind(directory);
+    if (it == m_previous.constEnd() || it->device != static_cast<quint64>(directoryStat.st_dev) || it->inode != static_cast<quint64>(directoryStat.st_ino)
+        || it->mtime != modificationTime(directoryStat) || it->ctime != changeTime(directoryStat))
+        return false;
+    entries = it->entries;
+    return true;
+}
+
+void SynchronizerSnapshot::insert(const QString &directory, const struct stat &directoryStat, const QVector<Entry> &entries)
+{
+    const qint64 changed = qMax(modificationTime(directoryStat), changeTime(directoryStat));
+    if (QDateTime::currentMSecsSinceEpoch() * 1000000 - changed < RACY_INTERVAL)
+        return;
+
+    QMutexLocker locker(&m_mutex);
+    m_current.insert(directory,
+                     Directory{static_cast<quint64>(directoryStat.st_dev),
+                               static_cast<quint64>(directoryStat.st_ino),
+                               modificationTime(directoryStat),
+                               changeTime(directoryStat),
+                               entries});
+}
+
+void SynchronizerSnapshot::load()
+{
+    if (m_loaded)
+        return;
+    m_loaded = true;
+
+    QFile file(m_fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return;
+
+    QDataStream stream(&file);
+    quint32 version;
+    qint32 count;
+    stream >> version >> count;
+    if (version != SNAPSHOT_VERSION || count < 0)
+        return;
+
+    // the counts of a broken file must not allocate more than the file can hold
+    m_previous.reserve(static_cast<int>(qMin<qint64>(count, file.bytesAvailable() / MIN_DIRECTORY_SIZE)));
+    for (qint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+        QString path;
+        Directory directory;
+        qint32 entryCount;
+        stream >> path >> directory.device >> directory.inode >> directory.mtime >> directory.ctime >> entryCount;
+        if (entryCount < 0) {
+            stream.setStatus(QDataStream::ReadCorruptData);
+            break;
+        }
+        directory.entries.reserve(static_cast<int>(qMin<qint64>(entryCount, file.bytesAvailable() / MIN_ENTRY_SIZE)));
+        for (qint32 j = 0; j < entryCount && stream.status() == QDataStream::Ok; ++j) {
+            Entry entry;
+            quint8 type;
+            stream >> entry.name >> type;
+            entry.type = type;
+            directory.entries.append(entry);
+        }
+        m_previous.insert(path, directory);
+    }
+    if (stream.status() != QDataStream::Ok)
+        m_previous.clear(); // broken file
+}
+
+void SynchronizerSnapshot::save()
+{
+    QMutexLocker locker(&m_mutex);
+
+    QDir().mkpath(m_fileName.left(m_fileName.lastIndexOf('/')));
+    QSaveFile file(m_fileName);
+    if (!file.open(QIODevice::WriteOnly))
+        return;
+
+    QDataStream stream(&file);
+    stream << SNAPSHOT_VERSION << static_cast<qint32>(m_current.count());
+    for (auto it = m_current.constBegin(); it != m_current.constEnd(); ++it) {
+        stream << it.key() << it->device << it->inode << it->mtime << it->ctime << static_cast<qint32>(it->entries.count());
+        for (const Entry &entry : it->entries)
+            stream << entry.name << static_cast<quint8>(entry.type);
+    }
+    file.commit();
+}
+
+bool SynchronizerSnapshot::sameNames(const QVector<Entry> &entries, const QVector<Entry> &otherEntries)
+{
+    if (entries.count() != otherEntries.count())
+        return false;
+
+    QVector<QByteArray> names, otherNames;
+    names.reserve(entries.count());
+    otherNames.reserve(otherEntries.count());
+    for (const Entry &entry : entries)
+        names << entry.name;
+    for (const Entry &entry : otherEntries)
+        otherNames << entry.name;
+    std::sort(names.begin(), names.end());
+    std::sort(otherNames.begin(), otherNames.end());
+    return names == otherNames;
+}
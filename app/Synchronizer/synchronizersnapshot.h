@@ -0,0 +1,70 @@
+/*
+    SPDX-FileCopyrightText: 2026 Krusader Krew <https://krusader.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef SYNCHRONIZERSNAPSHOT_H
+#define SYNCHRONIZERSNAPSHOT_H
+
+// QtCore
+#include <QByteArray>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QVector>
+
+#include <sys/stat.h>
+
+/**
+ * The names in the local folders of the last compare of two folder trees, saved in the user's
+ * cache folder.
+ *
+ * Adding, removing or renaming a file changes the modification time of its folder, so the names
+ * of a folder with the same modification and status change time are still valid and the folder
+ * doesn't have to be read again. The files themselves can change without touching the folder,
+ * their status is always read again. Folders which changed just before they were listed are not
+ * remembered, as the time stamp resolution of the filesystem may hide a following change.
+ *
+ * Thread-safe.
+ */
+class SynchronizerSnapshot
+{
+public:
+    struct Entry {
+        QByteArray name; //< encoded file name
+        unsigned char type; //< dirent type hint
+    };
+
+    /// One snapshot is kept for each pair of base folders
+    SynchronizerSnapshot(const QString &leftUrl, const QString &rightUrl, bool ignoreHidden);
+
+    /// Look up the entries of a local folder. Returns false if the folder is unknown or changed.
+    bool find(const QString &directory, const struct stat &directoryStat, QVector<Entry> &entries);
+    /// Remember the entries of a local folder as listed now
+    void insert(const QString &directory, const struct stat &directoryStat, const QVector<Entry> &entries);
+    /// Replace the snapshot file by the folders found in this compare
+    void save();
+
+    /// Return true if both lists have the same names, in any order
+    static bool sameNames(const QVector<Entry> &entries, const QVector<Entry> &otherEntries);
+
+private:
+    struct Directory {
+        quint64 device;
+        quint64 inode;
+        qint64 mtime; //< nanoseconds since the epoch
+        qint64 ctime; //< nanoseconds since the epoch
+        QVector<Entry> entries;
+    };
+
+    void load();
+
+    const QString m_fileName;
+    QMutex m_mutex; //< protects all following members
+    QHash<QString, Directory> m_previous; //< the folders of the last compare
+    QHash<QString, Directory> m_current; //< the folders of this compare
+    bool m_loaded;
+};
+
+#endif // SYNCHRONIZERSNAPSHOT_H
@@ -8,9 +8,10 @@
 #include "synchronizertask.h"
 
 // QtCore
-#include <QElapsedTimer>
-#include <QFile>
+#include <QThread>
+#include <QThreadPool>
 #include <QTimer>
+#include <QtConcurrent/QtConcurrentRun> // krazy:exclude=includes
 
 #include <KLocalizedString>
 #include <KMessageBox>
@@ -20,12 +21,37 @@
 #include "synchronizerdirlist.h"
 #include "synchronizerfileitem.h"
 
+namespace
+{
+/// Content comparisons run in their own pool, they are I/O bound and should not block other jobs
+class ContentCompareThreadPool : public QThreadPool
+{
+public:
+    ContentCompareThreadPool()
+    {
+        setMaxThreadCount(qMax(QThread::idealThreadCount(), 2));
+    }
+};
+}
+
+static QThreadPool *contentCompareThreadPool()
+{
+    static ContentCompareThreadPool pool;
+    return &pool;
+}
+
+static bool isLocalUrl(const QString &url)
+{
+    return QUrl::fromUserInput(url, QString(), QUrl::AssumeLocalFile).isLocalFile();
+}
+
 CompareTask::CompareTask(SynchronizerFileItem *parentIn,
                          const QString &leftURL,
                          const QString &rightURL,
                          const QString &leftDir,
                          const QString &rightDir,
-                         bool hidden)
+                         bool hidden,
+                         bool ignoreCase)
     : m_parent(parentIn)
     , m_url(leftURL)
     , m_dir(leftDir)
@@ -34,6 +60,11 @@ CompareTask::CompareTask(SynchronizerFileItem *parentIn,
     , m_duplicate(true)
     , m_dirList(nullptr)
     , m_otherDirList(nullptr)
+    , m_ignoreCase(ignoreCase)
+    , m_local(isLocalUrl(leftURL) && isLocalUrl(rightURL))
+    , m_joinWatcher(nullptr)
+    , m_snapshot(nullptr)
+    , m_verifySnapshot(false)
 {
     ignoreHidden = hidden;
 }
@@ -46,12 +77,19 @@ CompareTask::CompareTask(SynchronizerFileItem *parentIn, const QString &urlIn, c
     , m_duplicate(false)
     , m_dirList(nullptr)
     , m_otherDirList(nullptr)
+    , m_ignoreCase(false)
+    , m_local(isLocalUrl(urlIn))
+    , m_joinWatcher(nullptr)
+    , m_snapshot(nullptr)
+    , m_verifySnapshot(false)
 {
     ignoreHidden = hidden;
 }
 
 CompareTask::~CompareTask()
 {
+    if (m_joinWatcher)
+        m_joinWatcher->waitForFinished();
     if (m_dirList) {
         delete m_dirList;
         m_dirList = nullptr;
@@ -69,11 +107,13 @@ void CompareTask::start()
         m_loadFinished = m_otherLoadFinished = false;
 
         m_dirList = new SynchronizerDirList(parentWidget, ignoreHidden);
+        m_dirList->setSnapshot(m_snapshot, m_verifySnapshot);
         connect(m_dirList, &SynchronizerDirList::finished, this, &CompareTask::slotFinished);
         m_dirList->load(m_url, false);
 
         if (m_duplicate) {
             m_otherDirList = new SynchronizerDirList(parentWidget, ignoreHidden);
+            m_otherDirList->setSnapshot(m_snapshot, m_verifySnapshot);
             connect(m_otherDirList, &SynchronizerDirList::finished, this, &CompareTask::slotOtherFinished);
             m_otherDirList->load(m_otherUrl, false);
         }
@@ -88,8 +128,10 @@ void CompareTask::slotFinished(bool result)
     }
     m_loadFinished = true;
 
-    if (m_otherLoadFinished || !m_duplicate)
+    if (!m_duplicate)
         m_state = ST_STATE_READY;
+    else if (m_otherLoadFinished)
+        startJoin();
 }
 
 void CompareTask::slotOtherFinished(bool result)
@@ -101,7 +143,23 @@ void CompareTask::slotOtherFinished(bool result)
     m_otherLoadFinished = true;
 
     if (m_loadFinished)
+        startJoin();
+}
+
+void CompareTask::startJoin()
+{
+    m_joinWatcher = new QFutureWatcher<SynchronizerDirJoin>(this);
+    connect(m_joinWatcher, &QFutureWatcher<SynchronizerDirJoin>::finished, this, [this]() {
+        m_join = m_joinWatcher->result();
         m_state = ST_STATE_READY;
+    });
+
+    SynchronizerDirList *left = m_dirList;
+    SynchronizerDirList *right = m_otherDirList;
+    const bool ignoreCase = m_ignoreCase;
+    m_joinWatcher->setFuture(QtConcurrent::run([left, right, ignoreCase]() {
+        return SynchronizerDirList::join(left, right, ignoreCase);
+    }));
 }
 
 CompareContentTask::CompareContentTask(Synchronizer *syn, SynchronizerFileItem *itemIn, const QUrl &leftURLIn, const QUrl &rightURLIn, KIO::filesize_t sizeIn)
@@ -115,8 +173,8 @@ CompareContentTask::CompareContentTask(Synchronizer *syn, SynchronizerFileItem *
     , owner(-1)
     , item(itemIn)
     , timer(nullptr)
-    , leftFile(nullptr)
-    , rightFile(nullptr)
+    , localComparer(nullptr)
+    , localCompareWatcher(nullptr)
     , received(0)
     , sync(syn)
 {
@@ -124,41 +182,37 @@ CompareContentTask::CompareContentTask(Synchronizer *syn, SynchronizerFileItem *
 
 CompareContentTask::~CompareContentTask()
 {
+    if (localCompareWatcher && localCompareWatcher->isRunning()) {
+        localComparer->cancel();
+        localCompareWatcher->waitForFinished();
+    }
+
     abortContentComparing();
 
     if (timer)
         delete timer;
-    if (leftFile)
-        delete leftFile;
-    if (rightFile)
-        delete rightFile;
+    delete localComparer;
 }
 
 void CompareContentTask::start()
 {
     m_state = ST_STATE_PENDING;
+    compareTimer.start();
 
-    if (leftURL.isLocalFile() && rightURL.isLocalFile()) {
-        leftFile = new QFile(leftURL.path());
-        if (!leftFile->open(QIODevice::ReadOnly)) {
-            KMessageBox::error(parentWidget, i18n("Error at opening %1.", leftURL.path()));
-            m_state = ST_STATE_ERROR;
-            return;
-        }
-
-        rightFile = new QFile(rightURL.path());
-        if (!rightFile->open(QIODevice::ReadOnly)) {
-            KMessageBox::error(parentWidget, i18n("Error at opening %1.", rightURL.path()));
-            m_state = ST_STATE_ERROR;
-            return;
-        }
-
-        timer = new QTimer(this);
-        connect(timer, &QTimer::timeout, this, &CompareContentTask::sendStatusMessage);
-        timer->setSingleShot(true);
-        timer->start(1000);
+    timer = new QTimer(this);
+    connect(timer, &QTimer::timeout, this, &CompareContentTask::sendStatusMessage);
+    timer->setSingleShot(true);
+    timer->start(1000);
 
-        localFileCompareCycle();
+    if (leftURL.isLocalFile() && rightURL.isLocalFile()) {
+        localComparer = new LocalFileComparer(leftURL.path(), rightURL.path(), sync->cacheContentHashes);
+        localCompareWatcher = new QFutureWatcher<LocalFileComparer::Result>(this);
+        connect(localCompareWatcher, &QFutureWatcher<LocalFileComparer::Result>::finished, this, &CompareContentTask::slotLocalCompareFinished);
+
+        LocalFileComparer *comparer = localComparer;
+        localCompareWatcher->setFuture(QtConcurrent::run(contentCompareThreadPool(), [comparer]() {
+            return comparer->compare();
+        }));
     } else {
         leftReadJob = KIO::get(leftURL, KIO::NoReload, KIO::HideProgressInfo);
         rightReadJob = KIO::get(rightURL, KIO::NoReload, KIO::HideProgressInfo);
@@ -169,62 +223,37 @@ void CompareContentTask::start()
         connect(rightReadJob, &KIO::TransferJob::result, this, &CompareContentTask::slotFinished);
 
         rightReadJob->suspend();
-
-        timer = new QTimer(this);
-        connect(timer, &QTimer::timeout, this, &CompareContentTask::sendStatusMessage);
-        timer->setSingleShot(true);
-        timer->start(1000);
     }
 }
 
-void CompareContentTask::localFileCompareCycle()
+void CompareContentTask::slotLocalCompareFinished()
 {
-    bool different = false;
-
-    char leftBuffer[1440];
-    char rightBuffer[1440];
+    timer->stop();
+    received = static_cast<KIO::filesize_t>(localComparer->compared());
 
-    QElapsedTimer timer;
-    timer.start();
-
-    int cnt = 0;
-
-    while (!leftFile->atEnd() && !rightFile->atEnd()) {
-        int leftBytes = static_cast<int>(leftFile->read(leftBuffer, sizeof(leftBuffer)));
-        int rightBytes = static_cast<int>(rightFile->read(rightBuffer, sizeof(rightBuffer)));
-
-        if (leftBytes != rightBytes) {
-            different = true;
-            break;
-        }
-
-        if (leftBytes <= 0)
-            break;
-
-        received += leftBytes;
-
-        if (memcmp(leftBuffer, rightBuffer, leftBytes)) {
-            different = true;
-            break;
-        }
-
-        if ((++cnt % 16) == 0 && timer.elapsed() >= 250)
-            break;
-    }
-
-    if (different) {
-        sync->compareContentResult(item, false);
-        m_state = ST_STATE_READY;
-        return;
-    }
-
-    if (leftFile->atEnd() && rightFile->atEnd()) {
+    switch (localCompareWatcher->result()) {
+    case LocalFileComparer::Equal:
         sync->compareContentResult(item, true);
         m_state = ST_STATE_READY;
-        return;
+        break;
+    case LocalFileComparer::Different:
+        sync->compareContentResult(item, false);
+        m_state = ST_STATE_READY;
+        break;
+    case LocalFileComparer::LeftError:
+    case LocalFileComparer::RightError:
+        if (!errorPrinted) {
+            errorPrinted = true;
+            KMessageBox::error(parentWidget,
+                               i18n("I/O error while comparing file %1 with %2.",
+                                    leftURL.toDisplayString(QUrl::PreferLocalFile),
+                                    rightURL.toDisplayString(QUrl::PreferLocalFile)));
+        }
+        m_state = ST_STATE_ERROR;
+        break;
+    case LocalFileComparer::Canceled:
+        break;
     }
-
-    QTimer::singleShot(0, this, &CompareContentTask::localFileCompareCycle);
 }
 
 void CompareContentTask::slotDataReceived(KIO::Job *job, const QByteArray &data)
@@ -337,10 +366,15 @@ void CompareContentTask::abortContentComparing()
 
 void CompareContentTask::sendStatusMessage()
 {
+    if (localComparer)
+        received = static_cast<KIO::filesize_t>(localComparer->compared());
+
     double perc = (size == 0) ? 1. : (double)received / (double)size;
     auto percent = (int)(perc * 10000. + 0.5);
     QString statstr = QString("%1.%2%3").arg(percent / 100).arg((percent / 10) % 10).arg(percent % 10) + '%';
-    setStatusMessage(i18n("Comparing file %1 (%2)...", leftURL.fileName(), statstr));
+    const qint64 elapsed = compareTimer.elapsed();
+    const KIO::filesize_t speed = elapsed > 0 ? received * 1000 / static_cast<KIO::filesize_t>(elapsed) : 0;
+    setStatusMessage(i18nc("%2=percentage, %3=throughput", "Comparing file %1 (%2, %3/s)...", leftURL.fileName(), statstr, KIO::convertSize(speed)));
     timer->setSingleShot(true);
     timer->start(500);
 }
@@ -9,15 +9,19 @@
 #define SYNCHRONIZERTASK_H
 
 // QtCore
+#include <QElapsedTimer>
+#include <QFutureWatcher>
 #include <QObject>
 
 #include <KIO/Job>
 
+#include "localfilecomparer.h"
+#include "synchronizerdirlist.h"
+
 class Synchronizer;
-class SynchronizerDirList;
 class SynchronizerFileItem;
+class SynchronizerSnapshot;
 class QTimer;
-class QFile;
 
 #define ST_STATE_NEW 0
 #define ST_STATE_PENDING 1
@@ -65,6 +69,12 @@ public:
         return QString();
     }
 
+    /// True if the task works in a worker thread and hardly loads the GUI thread
+    virtual bool isBackgroundTask()
+    {
+        return false;
+    }
+
 protected:
     virtual void start()
     {
@@ -84,7 +94,8 @@ public:
                 const QString &rightURL,
                 const QString &leftDir,
                 const QString &rightDir,
-                bool ignoreHidden);
+                bool ignoreHidden,
+                bool ignoreCase);
     CompareTask(SynchronizerFileItem *parentIn, const QString &urlIn, const QString &dirIn, bool isLeftIn, bool ignoreHidden);
     ~CompareTask() override;
 
@@ -136,12 +147,33 @@ public:
     {
         return m_dirList;
     }
+    /// The files of both folders matched by name, valid for duplicates when the task is ready
+    inline const SynchronizerDirJoin &join()
+    {
+        return m_join;
+    }
+
+    /// Reuse the unchanged local folders of a previous compare, see SynchronizerDirList::setSnapshot()
+    inline void setSnapshot(SynchronizerSnapshot *snapshot, bool verify)
+    {
+        m_snapshot = snapshot;
+        m_verifySnapshot = verify;
+    }
+
+    /// Local folders are listed and matched in worker threads
+    bool isBackgroundTask() override
+    {
+        return m_local;
+    }
 
 protected slots:
     void start() override;
     void slotFinished(bool result);
     void slotOtherFinished(bool result);
 
+private:
+    void startJoin();
+
 private:
     SynchronizerFileItem *m_parent;
     QString m_url;
@@ -154,6 +186,12 @@ private:
     SynchronizerDirList *m_otherDirList;
     bool m_loadFinished;
     bool m_otherLoadFinished;
+    bool m_ignoreCase;
+    bool m_local;
+    SynchronizerDirJoin m_join;
+    QFutureWatcher<SynchronizerDirJoin> *m_joinWatcher;
+    SynchronizerSnapshot *m_snapshot;
+    bool m_verifySnapshot;
     bool ignoreHidden;
 };
 
@@ -165,6 +203,12 @@ public:
     CompareContentTask(Synchronizer *, SynchronizerFileItem *, const QUrl &, const QUrl &, KIO::filesize_t);
     ~CompareContentTask() override;
 
+    /// Local files are compared in the thread pool for content comparisons
+    bool isBackgroundTask() override
+    {
+        return leftURL.isLocalFile() && rightURL.isLocalFile();
+    }
+
 public slots:
     void slotDataReceived(KIO::Job *job, const QByteArray &data);
     void slotFinished(KJob *job);
@@ -174,7 +218,7 @@ protected:
     void start() override;
 
 protected slots:
-    void localFileCompareCycle();
+    void slotLocalCompareFinished();
 
 private:
     void abortContentComparing();
@@ -190,9 +234,10 @@ private:
     int owner; // the owner of the compare array
     SynchronizerFileItem *item; // the item for content compare
     QTimer *timer; // timer to show the process dialog at compare by content
+    QElapsedTimer compareTimer; // time since the comparison started, for the throughput
 
-    QFile *leftFile; // the left side local file
-    QFile *rightFile; // the right side local file
+    LocalFileComparer *localComparer; // compares local files in a worker thread
+    QFutureWatcher<LocalFileComparer::Result> *localCompareWatcher;
 
     KIO::filesize_t received; // the received size
     Synchronizer *sync;
@@ -153,6 +153,8 @@
 #define _ConfirmMove true
 // Icon Cache Size ////
 #define _IconCacheSize 2048
+// Watcher Update Delay (ms) //
+#define _WatcherUpdateDelay 250
 
 /////////////////////// [Archives]
 // Do Tar /////////////
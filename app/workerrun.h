@@ -0,0 +1,130 @@
+/*
+    SPDX-FileCopyrightText: 2026 Krusader Krew <https://krusader.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef WORKERRUN_H
+#define WORKERRUN_H
+
+// QtCore
+#include <QAtomicInt>
+#include <QMetaObject>
+#include <QObject>
+
+#include <functional>
+
+/**
+ * The state of a run of tasks in a thread pool, owned by an object living in the GUI thread.
+ *
+ * Every start() begins a new generation of tasks. The notifications a task posts to the GUI
+ * thread are dropped if the run was canceled or restarted before they arrive.
+ *
+ * There are two ways to end a run early. cancel() abandons it: the tasks stop and the end of the
+ * run is never reported. stop() is for an error or a failure in a task: the tasks stop taking new
+ * work, but the end of the run is still reported once the last task is done, so the owner can
+ * show what went wrong.
+ */
+class WorkerRun
+{
+public:
+    /// @p finished, if given, is called in the thread of @p receiver when a run ends without being canceled
+    explicit WorkerRun(QObject *receiver, const std::function<void()> &finished = std::function<void()>())
+        : m_receiver(receiver)
+        , m_finished(finished)
+        , m_running(false)
+    {
+    }
+
+    /// Begin a new run of @p tasks tasks, more can be added with addTask(). Returns its generation.
+    int start(int tasks = 0)
+    {
+        m_canceled.storeRelease(0);
+        m_stopped.storeRelease(0);
+        m_pending.storeRelease(tasks);
+        m_running = true;
+        return m_generation.fetchAndAddOrdered(1) + 1;
+    }
+    /// Abandon the run. Returns false if there was none, else the owner waits for its tasks.
+    bool cancel()
+    {
+        if (!m_running)
+            return false;
+
+        m_running = false;
+        m_generation.ref();
+        m_canceled.storeRelease(1);
+        return true;
+    }
+    bool isRunning() const
+    {
+        return m_running;
+    }
+
+    /// Let the tasks stop taking new work after an error. Thread-safe.
+    void stop()
+    {
+        m_stopped.storeRelease(1);
+    }
+    /// Return true if the run was stopped after an error. Thread-safe.
+    bool isStopped() const
+    {
+        return m_stopped.loadAcquire();
+    }
+    /// Return true if the tasks should not start new work, after cancel() or stop(). Thread-safe.
+    bool isInterrupted() const
+    {
+        return m_canceled.loadAcquire() || m_stopped.loadAcquire();
+    }
+    /// Return true if @p generation is still the current run. Thread-safe.
+    bool isCurrent(int generation) const
+    {
+        return generation == m_generation.loadAcquire();
+    }
+
+    /// Count one more task of the run. Thread-safe.
+    void addTask()
+    {
+        m_pending.ref();
+    }
+    /// Count a task of the run @p generation as done, the end of the run is reported after the last one. Thread-safe.
+    void taskDone(int generation)
+    {
+        if (!m_pending.deref() && !m_canceled.loadAcquire())
+            finish(generation);
+    }
+    /// Report the end of the run @p generation, for a run without tasks. Thread-safe.
+    void finish(int generation)
+    {
+        post(generation, [this]() {
+            if (m_running) {
+                m_running = false;
+                if (m_finished)
+                    m_finished();
+            }
+        });
+    }
+    /// Call @p function in the thread of the receiver, unless the run @p generation is over by then. Thread-safe.
+    void post(int generation, const std::function<void()> &function)
+    {
+        QMetaObject::invokeMethod(
+            m_receiver,
+            [this, generation, function]() {
+                // a notification of a canceled run may arrive after the next one started
+                if (isCurrent(generation))
+                    function();
+            },
+            Qt::QueuedConnection);
+    }
+
+private:
+    QObject *const m_receiver;
+    const std::function<void()> m_finished;
+    bool m_running; //< used in the thread of the receiver only
+    QAtomicInt m_generation; //< increased on every start() and cancel(), to drop stale notifications
+    QAtomicInt m_canceled;
+    QAtomicInt m_stopped;
+    QAtomicInt m_pending; //< the number of tasks not done yet
+};
+
+#endif // WORKERRUN_H
@@ -7,6 +7,7 @@
 */
 
 #include "krarc.h"
+#include "krarcindex.h"
 #include "../../app/defaults.h"
 
 // QtCore
@@ -1323,6 +1324,7 @@ bool kio_krarcProtocol::setArcFile(const QUrl &url)
 
         // new archive file means new dirDict, too
         dirDict.clear();
+        dirNames.clear();
 
         if (arcFile) {
             delete arcFile;
@@ -1427,7 +1429,17 @@ bool kio_krarcProtocol::initDirDict(const QUrl &url, bool forced)
         return false;
     }
 
-    if (arcType != "bzip2" && arcType != "lzma" && arcType != "xz") {
+    // the listing of an unchanged archive is taken from the index, also if another worker made it.
+    // The names in encrypted archives are not written to the disk.
+    const bool listed = arcType != "bzip2" && arcType != "lzma" && arcType != "xz";
+    KrArcIndex index(arcPath, arcType, currentCharset);
+    if (listed && !forced && !encrypted && index.load(dirDict)) {
+        dirNames.clear();
+        archiveChanged = false;
+        return true;
+    }
+
+    if (listed) {
         if (arcType == "rpm") {
             proc << listCmd << arcPath;
             proc.setStandardOutputFile(temp.fileName());
@@ -1450,6 +1462,7 @@ bool kio_krarcProtocol::initDirDict(const QUrl &url, bool forced)
     while (lit.hasNext())
         delete lit.next().value();
     dirDict.clear();
+    dirNames.clear();
 
     // add the "/" directory
     auto *root = new UDSEntryList();
@@ -1526,6 +1539,9 @@ bool kio_krarcProtocol::initDirDict(const QUrl &url, bool forced)
     // close and delete our file
     temp.close();
 
+    if (!encrypted)
+        index.save(dirDict);
+
     archiveChanged = false;
     // KRDEBUG("done.");
     return true;
@@ -1572,13 +1588,30 @@ UDSEntry *kio_krarcProtocol::findFileEntry(const QUrl &url)
         name = name.mid(name.lastIndexOf(DIR_SEPARATOR) + 1);
     }
 
-    UDSEntryList::iterator entry;
+    const int position = findEntry(arcDir, dirList, name);
+    return position < 0 ? nullptr : &(*dirList)[position];
+}
 
-    for (entry = dirList->begin(); entry != dirList->end(); ++entry) {
-        if ((entry->contains(KIO::UDSEntry::UDS_NAME)) && (entry->stringValue(KIO::UDSEntry::UDS_NAME) == name))
-            return &(*entry);
+int kio_krarcProtocol::findEntry(const QString &path, const KIO::UDSEntryList *dir, const QString &name)
+{
+    DirNames &names = dirNames[path];
+    if (names.list != dir || names.indexed > dir->count()) {
+        names.list = dir;
+        names.indexed = 0;
+        names.positions.clear();
+    }
+
+    // index the entries appended since the last lookup
+    for (; names.indexed < dir->count(); ++names.indexed) {
+        const UDSEntry &entry = dir->at(names.indexed);
+        if (entry.contains(KIO::UDSEntry::UDS_NAME)) {
+            const QString entryName = entry.stringValue(KIO::UDSEntry::UDS_NAME);
+            if (!names.positions.contains(entryName)) // the first one is found, like in the list
+                names.positions.insert(entryName, names.indexed);
+        }
     }
-    return nullptr;
+
+    return names.positions.value(name, -1);
 }
 
 QString kio_krarcProtocol::nextWord(QString &s, char d)
@@ -1640,12 +1673,12 @@ UDSEntryList *kio_krarcProtocol::addNewDir(const QString &path)
     if (itef != dirDict.end())
         return itef.value();
 
-    // set dir to the parent dir
-    dir = addNewDir(path.left(path.lastIndexOf(DIR_SEPARATOR, -2) + 1));
+    // set dir to the parent dir, the recursion stops at the first one already known
+    const int nameStart = path.lastIndexOf(DIR_SEPARATOR, -2) + 1;
+    dir = addNewDir(path.left(nameStart));
 
     // add a new entry in the parent dir
-    QString name = path.mid(path.lastIndexOf(DIR_SEPARATOR, -2) + 1);
-    name = name.left(name.length() - 1);
+    QString name = path.mid(nameStart, path.length() - nameStart - 1);
 
     if (name == "." || name == "..") { // entries with these names wouldn't be displayed
         // don't translate since this is an internal error
@@ -1946,11 +1979,7 @@ void kio_krarcProtocol::parseLine(int lineNo, QString line)
         fullName = DIR_SEPARATOR + fullName;
     QString path = fullName.left(fullName.lastIndexOf(DIR_SEPARATOR) + 1);
     // set/create the directory UDSEntryList
-    QHash<QString, KIO::UDSEntryList *>::iterator itef = dirDict.find(path);
-    if (itef == dirDict.end())
-        dir = addNewDir(path);
-    else
-        dir = itef.value();
+    dir = addNewDir(path);
 
     QString name = fullName.mid(fullName.lastIndexOf(DIR_SEPARATOR) + 1);
     // file name
@@ -1973,25 +2002,19 @@ void kio_krarcProtocol::parseLine(int lineNo, QString line)
             dirDict.insert(fullName, new UDSEntryList());
         else {
             // try to overwrite an existing entry
-            UDSEntryList::iterator entryIt;
-
-            for (entryIt = dir->begin(); entryIt != dir->end(); ++entryIt) {
-                if (entryIt->contains(KIO::UDSEntry::UDS_NAME) && entryIt->stringValue(KIO::UDSEntry::UDS_NAME) == name) {
-                    entryIt->fastInsert(KIO::UDSEntry::UDS_MODIFICATION_TIME, time);
-                    entryIt->fastInsert(KIO::UDSEntry::UDS_ACCESS, mode);
-                    return;
-                }
+            const int position = findEntry(path, dir, name);
+            if (position >= 0) {
+                UDSEntry &existing = (*dir)[position];
+                existing.fastInsert(KIO::UDSEntry::UDS_MODIFICATION_TIME, time);
+                existing.fastInsert(KIO::UDSEntry::UDS_ACCESS, mode);
             }
             return; // there is already an entry for this directory
         }
     }
 
     // multi volume archives can add a file twice, use only one
-    UDSEntryList::iterator dirEntryIt;
-
-    for (dirEntryIt = dir->begin(); dirEntryIt != dir->end(); ++dirEntryIt)
-        if (dirEntryIt->contains(KIO::UDSEntry::UDS_NAME) && dirEntryIt->stringValue(KIO::UDSEntry::UDS_NAME) == name)
-            return;
+    if (findEntry(path, dir, name) >= 0)
+        return;
 
     dir->append(entry);
 }
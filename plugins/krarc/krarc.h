@@ -118,13 +118,23 @@ private:
     KIO::UDSEntry *findFileEntry(const QUrl &url);
     /** add a new directory (file list container). */
     KIO::UDSEntryList *addNewDir(const QString &path);
+    /** return the position of the entry named @p name in the list @p dir of the directory @p path, or -1. */
+    int findEntry(const QString &path, const KIO::UDSEntryList *dir, const QString &name);
 #if KSERVICE_VERSION >= QT_VERSION_CHECK(5, 96, 0)
     Q_REQUIRED_RESULT KIO::WorkerResult checkWriteSupport();
 #else
     bool checkWriteSupport();
 #endif
 
+    /** the positions of the entries in a directory list, by name. */
+    struct DirNames {
+        const KIO::UDSEntryList *list = nullptr; //< the indexed list, a replaced one is indexed again
+        int indexed = 0; //< the number of list entries indexed, the lists only grow
+        QHash<QString, int> positions;
+    };
+
     QHash<QString, KIO::UDSEntryList *> dirDict; //< the directories data structure.
+    QHash<QString, DirNames> dirNames; //< the name index of the lists in dirDict, built when needed.
     bool encrypted; //< tells whether the archive is encrypted
     bool archiveChanged; //< true if the archive was changed.
     bool archiveChanging; //< true if the archive is currently changing.
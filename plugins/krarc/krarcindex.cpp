@@ -0,0 +1,181 @@
+/*
+    SPDX-FileCopyrightText: 2026 Krusader Krew <https://krusader.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "krarcindex.h"
+
+// QtCore
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#include <sys/stat.h>
+
+static const quint32 INDEX_VERSION = 2;
+// the serialization of the entries is pinned, a newer Qt must not change the format silently
+static const qint32 STREAM_VERSION = QDataStream::Qt_5_12;
+// the index files of the archives listed longest ago are removed beyond this total size
+static const qint64 MAX_INDEX_FOLDER_SIZE = Q_INT64_C(256) * 1024 * 1024;
+// the smallest size of a folder record (path and entry count) and of an entry (field count)
+static const qint64 MIN_DIR_SIZE = 8;
+static const qint64 MIN_ENTRY_SIZE = 4;
+// archives changed less than this time (ns) before listing are not indexed, see the class comment
+static const qint64 RACY_INTERVAL = Q_INT64_C(2000000000);
+
+static QString indexFolder()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation) + QStringLiteral("/krusader/krarc-index");
+}
+
+static QString indexFileName(const QString &arcPath)
+{
+    const QByteArray hash = QCryptographicHash::hash(arcPath.toUtf8(), QCryptographicHash::Md5);
+    return indexFolder() + '/' + QString::fromLatin1(hash.toHex());
+}
+
+/// Return the archive path of an index file, empty if the file is broken or of another version
+static QString indexedArchive(const QString &fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return QString();
+
+    QDataStream stream(&file);
+    stream.setVersion(STREAM_VERSION);
+    quint32 version;
+    qint32 streamVersion;
+    QString arcPath;
+    stream >> version >> streamVersion >> arcPath;
+    if (stream.status() != QDataStream::Ok || version != INDEX_VERSION || streamVersion != STREAM_VERSION)
+        return QString();
+    return arcPath;
+}
+
+/// Remove the index files of deleted archives, and the ones used longest ago beyond the size limit
+static void pruneIndexFolder(const QString &keptFileName)
+{
+    qint64 totalSize = 0;
+    const QFileInfoList files = QDir(indexFolder()).entryInfoList(QDir::Files, QDir::Time); // the newest first
+    for (const QFileInfo &info : files) {
+        if (info.absoluteFilePath() != keptFileName) {
+            const QString arcPath = indexedArchive(info.absoluteFilePath());
+            if (arcPath.isEmpty() || !QFileInfo::exists(arcPath) || totalSize + info.size() > MAX_INDEX_FOLDER_SIZE) {
+                QFile::remove(info.absoluteFilePath());
+                continue;
+            }
+        }
+        totalSize += info.size();
+    }
+}
+
+KrArcIndex::KrArcIndex(const QString &arcPath, const QString &arcType, const QString &charset)
+    : m_fileName(indexFileName(arcPath))
+    , m_arcPath(arcPath)
+    , m_arcType(arcType)
+    , m_charset(charset)
+    , m_valid(false)
+    , m_device(0)
+    , m_inode(0)
+    , m_size(0)
+    , m_mtime(0)
+{
+    struct stat arcStat;
+    if (stat(QFile::encodeName(arcPath).constData(), &arcStat) != 0)
+        return;
+
+    m_device = static_cast<quint64>(arcStat.st_dev);
+    m_inode = static_cast<quint64>(arcStat.st_ino);
+    m_size = static_cast<qint64>(arcStat.st_size);
+#ifdef Q_OS_LINUX
+    m_mtime = static_cast<qint64>(arcStat.st_mtim.tv_sec) * 1000000000 + arcStat.st_mtim.tv_nsec;
+#else
+    m_mtime = static_cast<qint64>(arcStat.st_mtime) * 1000000000;
+#endif
+    m_valid = QDateTime::currentMSecsSinceEpoch() * 1000000 - m_mtime >= RACY_INTERVAL;
+}
+
+bool KrArcIndex::load(DirDict &dirDict) const
+{
+    if (!m_valid)
+        return false;
+
+    QFile file(m_fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream stream(&file);
+    stream.setVersion(STREAM_VERSION);
+    quint32 version;
+    qint32 streamVersion;
+    QString arcPath, arcType, charset;
+    quint64 device, inode;
+    qint64 size, mtime;
+    qint32 count;
+    stream >> version >> streamVersion;
+    if (version != INDEX_VERSION || streamVersion != STREAM_VERSION)
+        return false;
+    stream >> arcPath >> arcType >> charset >> device >> inode >> size >> mtime >> count;
+    if (stream.status() != QDataStream::Ok || arcPath != m_arcPath || arcType != m_arcType || charset != m_charset || device != m_device
+        || inode != m_inode || size != m_size || mtime != m_mtime || count < 0)
+        return false;
+
+    // the counts of a broken file must not allocate more than the file can hold
+    DirDict loaded;
+    loaded.reserve(static_cast<int>(qMin<qint64>(count, file.bytesAvailable() / MIN_DIR_SIZE)));
+    for (qint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+        QString path;
+        qint32 entryCount;
+        stream >> path >> entryCount;
+        if (entryCount < 0)
+            break;
+
+        auto *dir = new KIO::UDSEntryList();
+        dir->reserve(static_cast<int>(qMin<qint64>(entryCount, file.bytesAvailable() / MIN_ENTRY_SIZE)));
+        for (qint32 j = 0; j < entryCount && stream.status() == QDataStream::Ok; ++j) {
+            KIO::UDSEntry entry;
+            stream >> entry;
+            dir->append(entry);
+        }
+        loaded.insert(path, dir);
+    }
+
+    if (stream.status() != QDataStream::Ok || loaded.count() != count) { // broken file
+        qDeleteAll(loaded);
+        return false;
+    }
+
+    qDeleteAll(dirDict);
+    dirDict.swap(loaded);
+    // the modification time orders the index files by their last use for pruneIndexFolder()
+    file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+    return true;
+}
+
+void KrArcIndex::save(const DirDict &dirDict) const
+{
+    if (!m_valid)
+        return;
+
+    QDir().mkpath(indexFolder());
+    QSaveFile file(m_fileName);
+    if (!file.open(QIODevice::WriteOnly))
+        return;
+
+    QDataStream stream(&file);
+    stream.setVersion(STREAM_VERSION);
+    stream << INDEX_VERSION << STREAM_VERSION << m_arcPath << m_arcType << m_charset << m_device << m_inode << m_size << m_mtime << static_cast<qint32>(dirDict.count());
+    for (auto it = dirDict.constBegin(); it != dirDict.constEnd(); ++it) {
+        stream << it.key() << static_cast<qint32>(it.value()->count());
+        for (const KIO::UDSEntry &entry : *it.value())
+            stream << entry;
+    }
+    if (file.commit())
+        pruneIndexFolder(m_fileName);
+}
@@ -0,0 +1,53 @@
+/*
+    SPDX-FileCopyrightText: 2026 Krusader Krew <https://krusader.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef KRARCINDEX_H
+#define KRARCINDEX_H
+
+// QtCore
+#include <QHash>
+#include <QString>
+
+#include <KIO/UDSEntry>
+
+/**
+ * The parsed listing of an archive, saved in the user's cache folder.
+ *
+ * Listing a large archive with the external archiver and parsing its output takes long, and it
+ * was repeated every time a new worker process opened the archive. The index is keyed by the
+ * archive path and remembers the device, inode, size and modification time of the archive file,
+ * so it is used only while the archive is unchanged. It is shared by all worker processes.
+ *
+ * Archives changed just before they were listed are not indexed, as the time stamp resolution of
+ * the filesystem may hide a following change. Whenever an index is saved, the index files of
+ * deleted archives are removed, and the ones used longest ago if the folder grows too big.
+ */
+class KrArcIndex
+{
+public:
+    typedef QHash<QString, KIO::UDSEntryList *> DirDict;
+
+    /// The index of the archive at @p arcPath, listed as @p arcType with the @p charset encoding
+    KrArcIndex(const QString &arcPath, const QString &arcType, const QString &charset);
+
+    /// Replace the lists of @p dirDict by the ones of the index. Returns false if there is no valid index.
+    bool load(DirDict &dirDict) const;
+    /// Replace the index by @p dirDict
+    void save(const DirDict &dirDict) const;
+
+private:
+    const QString m_fileName;
+    const QString m_arcPath;
+    const QString m_arcType;
+    const QString m_charset;
+    bool m_valid; //< the archive could be examined and didn't change just now
+    quint64 m_device;
+    quint64 m_inode;
+    qint64 m_size;
+    qint64 m_mtime; //< nanoseconds since the epoch
+};
+
+#endif // KRARCINDEX_H